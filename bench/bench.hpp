@@ -0,0 +1,59 @@
+#pragma once
+
+// Minimalistic benchmark harness: no dependencies except the standard library.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+
+namespace bench {
+
+    // Prevents the compiler from optimizing away the computation that produced `value`
+    template<class T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // Runs `fn(iterations)` and prints the time spent per iteration
+    template<class Fn>
+    inline void run(const char* name, std::uint64_t iterations, Fn&& fn)
+    {
+        fn(iterations / 10);  // Warm up
+
+        const auto start = std::chrono::steady_clock::now();
+        fn(iterations);
+        const auto stop = std::chrono::steady_clock::now();
+
+        const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        std::printf("%-48s %10.3f ns/iter\n", name, ns / static_cast<double>(iterations));
+    }
+}
+
+// Benchmark suites, one per library header
+void bench_bitmask();
+void bench_simd();
+void bench_bitmask_vector();
+void bench_algorithm();
+void bench_sliced_index();
+void bench_posting_index();
+void bench_atomic();
+void bench_event_group();
+void bench_mailbox();
+void bench_counters();
+void bench_replicated();
+void bench_seqlock();
+void bench_slot_allocator();
+void bench_hierarchical();
+void bench_scheduler();
+void bench_names();
+void bench_format();
+void bench_serialize();
+void bench_schema();
+void bench_coroutine();  // Built as a separate C++20 executable
@@ -0,0 +1,115 @@
+#include "bench.hpp"
+
+#include <bitmask/algorithm.hpp>
+
+#include <array>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class segment_32: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFF
+    };
+
+    BITMASK_DEFINE(segment_32)
+
+    const std::size_t data_size = 1 << 22;
+    const std::uint64_t iterations = 1 << 5;
+
+    void bench_reduce()
+    {
+        using bm = bitmask::bitmask<segment_32>;
+
+        // Bits are sparse: XOR has to scan everything while AND gets to zero in the first chunk
+        std::mt19937_64 gen{42};
+        std::vector<bm> masks;
+        masks.reserve(data_size);
+        for (std::size_t i = 0; i != data_size; ++i)
+            masks.push_back(bitmask::bitmask_detail::to_enum<segment_32>(static_cast<std::uint32_t>(gen() & gen() & gen())));
+        masks.back() = bm{};
+
+        const auto first = masks.data();
+        const auto last = masks.data() + masks.size();
+
+        bench::run("algorithm/u32/reduce_xor/naive (x4M)", iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+            {
+                bm result;
+                for (auto p = first; p != last; ++p)
+                    result ^= *p;
+                bench::do_not_optimize(result);
+            }
+        });
+
+        bench::run("algorithm/u32/reduce_xor (x4M)", iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(bitmask::reduce_xor(first, last));
+        });
+
+        bench::run("algorithm/u32/reduce_and (x4M)", iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(bitmask::reduce_and(first, last - 1));
+        });
+
+        bench::run("algorithm/u32/parallel_reduce_xor (x4M)", iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(bitmask::parallel_reduce_xor(first, last));
+        });
+    }
+
+    void bench_flag_histogram()
+    {
+        using bm = bitmask::bitmask<segment_32>;
+
+        std::mt19937_64 gen{42};
+        std::vector<bm> masks;
+        masks.reserve(data_size);
+        for (std::size_t i = 0; i != data_size; ++i)
+            masks.push_back(bitmask::bitmask_detail::to_enum<segment_32>(static_cast<std::uint32_t>(gen())));
+
+        const auto first = masks.data();
+        const auto last = masks.data() + masks.size();
+
+        bench::run("algorithm/u32/flag_histogram/per_flag (x4M)", iterations / 4, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+            {
+                std::array<std::uint64_t, 32> counts{};
+                for (std::size_t j = 0; j != counts.size(); ++j)
+                {
+                    const bm flag = bitmask::bitmask_detail::to_enum<segment_32>(std::uint32_t{1} << j);
+                    for (auto p = first; p != last; ++p)
+                        counts[j] += p->contains_all(flag);
+                }
+                bench::do_not_optimize(counts);
+            }
+        });
+
+        bench::run("algorithm/u32/flag_histogram/per_bit (x4M)", iterations / 4, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+            {
+                std::array<std::uint64_t, 32> counts{};
+                for (auto p = first; p != last; ++p)
+                {
+                    for (auto flag : *p)
+                        ++counts[bitmask::flag_index(flag)];
+                }
+                bench::do_not_optimize(counts);
+            }
+        });
+
+        bench::run("algorithm/u32/flag_histogram (x4M)", iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(bitmask::flag_histogram(first, last));
+        });
+    }
+}
+
+
+void bench_algorithm()
+{
+    bench_reduce();
+    bench_flag_histogram();
+}
@@ -0,0 +1,45 @@
+#include "bench.hpp"
+
+#include <bitmask/atomic.hpp>
+
+
+namespace
+{
+    enum class connection_state: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFF
+    };
+
+    BITMASK_DEFINE(connection_state)
+
+    const std::uint64_t iterations = 1 << 24;
+}
+
+
+void bench_atomic()
+{
+    using bm = bitmask::bitmask<connection_state>;
+
+    bitmask::atomic_bitmask<connection_state> state;
+
+    // Hand written CAS loop is what using `std::atomic<underlying_type>` with casts tends to end up with
+    bench::run("atomic/test_and_set/cas_loop", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            const bm flag = bitmask::bitmask_detail::to_enum<connection_state>(std::uint32_t{1} << (i % 32));
+            bm expected = state.load(std::memory_order_relaxed);
+            while (!state.compare_exchange_weak(expected, expected | flag)) {}
+            bench::do_not_optimize(expected.contains_all(flag));
+        }
+    });
+
+    bench::run("atomic/test_and_set/lock_bts", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(state.test_and_set(static_cast<connection_state>(std::uint32_t{1} << (i % 32))));
+    });
+
+    bench::run("atomic/set/lock_or", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            state.set(bitmask::bitmask_detail::to_enum<connection_state>(std::uint32_t{1} << (i % 32)));
+    });
+}
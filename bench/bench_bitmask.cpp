@@ -0,0 +1,102 @@
+#include "bench.hpp"
+
+#include <bitmask/bitmask.hpp>
+
+#include <vector>
+#include <random>
+#include <limits>
+
+
+namespace
+{
+    enum class syntax_option_type
+    {
+        ECMAScript = 0,
+        icase      = 1 << 0,
+        nosubs     = 1 << 1,
+        optimize   = 1 << 2,
+        collate    = 1 << 3,
+        basic      = 1 << 4,
+        awk        = 1 << 5,
+
+        _bitmask_max_element = awk
+    };
+
+    BITMASK_DEFINE(syntax_option_type)
+
+    enum class open_mode
+    {
+        app     = 0x01,
+        binary  = 0x02,
+        ate     = 0x40,
+
+        _bitmask_value_mask = 0x43
+    };
+
+    BITMASK_DEFINE(open_mode)
+
+    const std::size_t data_size = 4096;
+    const std::uint64_t iterations = 1 << 14;
+
+    template<class T>
+    std::vector<bitmask::bitmask<T>> random_masks(std::size_t n)
+    {
+        std::mt19937 gen{42};
+        std::vector<bitmask::bitmask<T>> result;
+        result.reserve(n);
+        while (result.size() < n)
+        {
+            const auto bits = static_cast<typename bitmask::bitmask<T>::underlying_type>(gen());
+            result.push_back(bitmask::bitmask_detail::to_enum<T>(bits & bitmask::bitmask<T>::mask_value));
+        }
+        return result;
+    }
+
+    template<class T>
+    void bench_iteration(const char* naive_name, const char* iter_name)
+    {
+        using underlying_type = typename bitmask::bitmask<T>::underlying_type;
+
+        const auto data = random_masks<T>(data_size);
+
+        bench::run(naive_name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+            {
+                unsigned sum = 0;
+                for (const auto& m : data)
+                {
+                    for (unsigned b = 0; b != std::numeric_limits<underlying_type>::digits; ++b)
+                    {
+                        const auto bit = static_cast<underlying_type>(underlying_type{1} << b);
+                        if (m.bits() & bit)
+                            sum += static_cast<unsigned>(bitmask::bitmask_detail::to_enum<T>(bit));
+                    }
+                }
+                bench::do_not_optimize(sum);
+            }
+        });
+
+        bench::run(iter_name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+            {
+                unsigned sum = 0;
+                for (const auto& m : data)
+                {
+                    for (auto f : m)
+                        sum += static_cast<unsigned>(f);
+                }
+                bench::do_not_optimize(sum);
+            }
+        });
+    }
+}
+
+
+
+void bench_bitmask()
+{
+    bench_iteration<syntax_option_type>("iteration/syntax_option_type/naive (x4096)",
+                                        "iteration/syntax_option_type/iterator (x4096)");
+    bench_iteration<open_mode>("iteration/open_mode/naive (x4096)",
+                               "iteration/open_mode/iterator (x4096)");
+}
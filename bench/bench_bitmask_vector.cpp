@@ -0,0 +1,81 @@
+#include "bench.hpp"
+
+#include <bitmask/bitmask_vector.hpp>
+
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class segment_8: std::uint8_t
+    {
+        _bitmask_value_mask = 0xFF
+    };
+
+    BITMASK_DEFINE(segment_8)
+
+    enum class segment_32: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFF
+    };
+
+    BITMASK_DEFINE(segment_32)
+
+    const std::size_t data_size = 1 << 20;
+    const std::uint64_t iterations = 1 << 6;
+
+    template<class T>
+    void bench_filter(const char* scalar_name, const char* bitmap_name, const char* indices_name)
+    {
+        using bm = bitmask::bitmask<T>;
+
+        std::mt19937_64 gen{42};
+        std::vector<bm> masks;
+        bitmask::bitmask_vector<T> packed;
+        masks.reserve(data_size);
+        packed.reserve(data_size);
+        for (std::size_t i = 0; i != data_size; ++i)
+        {
+            const bm m = bitmask::bitmask_detail::to_enum<T>(static_cast<typename bm::underlying_type>(gen()));
+            masks.push_back(m);
+            packed.push_back(m);
+        }
+
+        const bm required = bitmask::bitmask_detail::to_enum<T>(0x11);
+
+        bench::run(scalar_name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+            {
+                std::vector<std::size_t> result;
+                for (std::size_t i = 0; i != masks.size(); ++i)
+                {
+                    if (masks[i].contains_all(required))
+                        result.push_back(i);
+                }
+                bench::do_not_optimize(result);
+            }
+        });
+
+        bench::run(bitmap_name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(packed.filter_all(required));
+        });
+
+        bench::run(indices_name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(packed.filter_all_indices(required));
+        });
+    }
+}
+
+
+void bench_bitmask_vector()
+{
+    bench_filter<segment_8>("bitmask_vector/u8/filter_all/scalar (x1M)",
+                            "bitmask_vector/u8/filter_all/bitmap (x1M)",
+                            "bitmask_vector/u8/filter_all/indices (x1M)");
+    bench_filter<segment_32>("bitmask_vector/u32/filter_all/scalar (x1M)",
+                             "bitmask_vector/u32/filter_all/bitmap (x1M)",
+                             "bitmask_vector/u32/filter_all/indices (x1M)");
+}
@@ -0,0 +1,119 @@
+#include "bench.hpp"
+
+#include <bitmask/coroutine.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class phase: std::uint32_t
+    {
+        even = 0x01,
+        odd = 0x02,
+        stop = 0x04,
+
+        _bitmask_max_element = stop
+    };
+
+    BITMASK_DEFINE(phase)
+
+    using bm = bitmask::bitmask<phase>;
+
+    const unsigned coroutine_waiters = 10000;
+    const unsigned thread_waiters = 1000;  // Parking 10k OS threads is exactly what coroutines are meant to avoid
+    const std::uint64_t wake_ups = 1 << 21;
+
+    struct task
+    {
+        struct promise_type
+        {
+            task get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    bm round_flag(std::uint64_t r) { return r & 1 ? phase::odd : phase::even; }
+
+    task await_rounds(bitmask::awaitable_bitmask<phase>& flags, std::uint64_t& woken)
+    {
+        for (std::uint64_t r = 0;; ++r)
+        {
+            if (co_await flags.any(round_flag(r) | phase::stop) & phase::stop)
+                co_return;
+            ++woken;
+        }
+    }
+}
+
+
+void bench_coroutine()
+{
+    // Every round sets the flag all the waiters wait for and waits until all of them have run.
+    // Time is per waiter wake up.
+    bench::run("coroutine/wake_10k/awaitable_bitmask", wake_ups, [&](std::uint64_t n) {
+        bitmask::awaitable_bitmask<phase> flags;
+        std::uint64_t woken = 0;
+        for (unsigned i = 0; i != coroutine_waiters; ++i)
+            await_rounds(flags, woken);
+
+        for (std::uint64_t r = 0; r != n / coroutine_waiters; ++r)
+        {
+            flags.clear(round_flag(r + 1));
+            flags.set(round_flag(r));  // Resumes the waiters inline
+        }
+        flags.set(phase::stop);
+        bench::do_not_optimize(woken);
+    });
+
+    bench::run("coroutine/wake_1k/condvar_threads", wake_ups / 8, [&](std::uint64_t n) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bm flags;
+        std::atomic<std::uint64_t> woken{0};
+
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i != thread_waiters; ++i)
+        {
+            pool.emplace_back([&] {
+                for (std::uint64_t r = 0;; ++r)
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    const bm m = round_flag(r) | phase::stop;
+                    cv.wait(lock, [&] { return static_cast<bool>(flags & m); });
+                    if (flags & phase::stop)
+                        return;
+                    lock.unlock();
+                    ++woken;
+                }
+            });
+        }
+
+        const std::uint64_t rounds = n / thread_waiters;
+        for (std::uint64_t r = 0; r != rounds; ++r)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                flags = (flags & ~round_flag(r + 1)) | round_flag(r);
+            }
+            cv.notify_all();
+            while (woken != (r + 1) * thread_waiters)
+                std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flags |= phase::stop;
+        }
+        cv.notify_all();
+        for (auto& t: pool)
+            t.join();
+    });
+}
@@ -0,0 +1,79 @@
+#include "bench.hpp"
+
+#include <bitmask/counters.hpp>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class request_flag: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFF
+    };
+
+    BITMASK_DEFINE(request_flag)
+
+    using bm = bitmask::bitmask<request_flag>;
+
+    const std::uint64_t iterations = 1 << 22;
+
+    // Typical requests have a few flags set
+    bm nth_mask(std::uint64_t i)
+    {
+        return bitmask::bitmask_detail::to_enum<request_flag>(
+            static_cast<std::uint32_t>((0x0111u << (i % 5)) & 0xFFFF));
+    }
+
+    // Shared counters every thread bumps
+    struct atomic_counters
+    {
+        std::array<std::atomic<std::uint64_t>, bitmask::flag_count<request_flag>::value> counts{};
+
+        void add(bm m)
+        {
+            for (auto bits = m.bits(); bits; bits &= bits - 1u)
+                counts[static_cast<std::size_t>(bitmask::bitmask_detail::lowest_bit_index(bits))].fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    // `threads` threads share `n` adds
+    template<class Counters>
+    void run_threads(Counters& counters, unsigned threads, std::uint64_t n)
+    {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t != threads; ++t)
+        {
+            pool.emplace_back([&counters, threads, n, t] {
+                for (std::uint64_t i = t; i < n; i += threads)
+                    counters.add(nth_mask(i));
+            });
+        }
+        for (auto& t: pool)
+            t.join();
+    }
+}
+
+
+void bench_counters()
+{
+    const unsigned hw = std::thread::hardware_concurrency();
+    const unsigned max_threads = hw > 4 ? hw : 4;
+    std::printf("counters: %u hardware threads\n", hw);
+
+    char name[64];
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        atomic_counters shared;
+        std::snprintf(name, sizeof(name), "counters/add/atomic_array/%u_threads", threads);
+        bench::run(name, iterations, [&](std::uint64_t n) { run_threads(shared, threads, n); });
+
+        bitmask::flag_counters<request_flag> sharded(max_threads);
+        std::snprintf(name, sizeof(name), "counters/add/flag_counters/%u_threads", threads);
+        bench::run(name, iterations, [&](std::uint64_t n) { run_threads(sharded, threads, n); });
+        bench::do_not_optimize(sharded.counts());
+    }
+}
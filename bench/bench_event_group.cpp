@@ -0,0 +1,101 @@
+#include "bench.hpp"
+
+#include <bitmask/event_group.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class signal: std::uint32_t
+    {
+        ping = 0x01,
+        pong = 0x02,
+        shutdown = 0x04,
+
+        _bitmask_max_element = shutdown
+    };
+
+    BITMASK_DEFINE(signal)
+
+    using bm = bitmask::bitmask<signal>;
+
+    const std::uint64_t iterations = 1 << 15;
+
+    // The usual replacement: a flag word under a mutex with a single condition variable that wakes everybody
+    class condvar_group
+    {
+    public:
+        void set(bm m)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_bits |= m;
+            }
+            m_cv.notify_all();
+        }
+
+        bm wait_any(bm m, bool clear_on_wake = false)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return static_cast<bool>(m_bits & m); });
+            const bm v = m_bits;
+            if (clear_on_wake)
+                m_bits &= ~m;
+            return v;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bm m_bits;
+    };
+
+    // Ping-pong between two threads while `bystanders` more threads wait for a flag that never comes until shutdown
+    template<class Group>
+    void ping_pong(const char* name, unsigned bystanders)
+    {
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            Group g;
+            std::vector<std::thread> idle;
+            for (unsigned i = 0; i != bystanders; ++i)
+                idle.emplace_back([&] { g.wait_any(signal::shutdown); });
+
+            std::thread echo([&] {
+                for (std::uint64_t i = 0; i != n; ++i)
+                {
+                    g.wait_any(signal::ping, true);
+                    g.set(signal::pong);
+                }
+            });
+            for (std::uint64_t i = 0; i != n; ++i)
+            {
+                g.set(signal::ping);
+                g.wait_any(signal::pong, true);
+            }
+            echo.join();
+
+            g.set(signal::shutdown);
+            for (auto& t: idle)
+                t.join();
+        });
+    }
+}
+
+
+void bench_event_group()
+{
+    ping_pong<condvar_group>("event_group/ping_pong/condvar", 0);
+    ping_pong<bitmask::event_group<signal>>("event_group/ping_pong/event_group", 0);
+    ping_pong<condvar_group>("event_group/ping_pong_4_idle/condvar", 4);
+    ping_pong<bitmask::event_group<signal>>("event_group/ping_pong_4_idle/event_group", 4);
+
+    bitmask::event_group<signal> g;
+    bench::run("event_group/set/no_waiters", iterations * 256, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(g.set(i & 1 ? signal::ping : signal::pong));
+    });
+}
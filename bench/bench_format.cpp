@@ -0,0 +1,119 @@
+#include "bench.hpp"
+
+#include <bitmask/format.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+    enum class header_flag: std::uint32_t
+    {
+        gzip = 1 << 0,
+        deflate = 1 << 1,
+        brotli = 1 << 2,
+        chunked = 1 << 3,
+        keep_alive = 1 << 4,
+        no_cache = 1 << 5,
+        no_store = 1 << 6,
+        must_revalidate = 1 << 7,
+
+        _bitmask_max_element = must_revalidate
+    };
+
+    BITMASK_DEFINE(header_flag)
+    BITMASK_DEFINE_NAMES(header_flag, gzip, deflate, brotli, chunked, keep_alive, no_cache, no_store, must_revalidate)
+
+    using bm = bitmask::bitmask<header_flag>;
+
+    const std::uint64_t iterations = 1 << 22;
+
+    enum level { debug, info, warning };
+
+    // A logger that checks the level at run time and copies the enabled messages to a line buffer
+    class logger
+    {
+    public:
+        template<class Arg>
+        void log(level l, const Arg& arg)
+        {
+            if (l < m_level.load(std::memory_order_relaxed))
+                return;
+            m_size = write(arg);
+            bench::do_not_optimize(m_line);
+        }
+
+        void set_level(level l) { m_level.store(l, std::memory_order_relaxed); }
+
+    private:
+        std::size_t write(const std::string& s)
+        {
+            std::memcpy(m_line, s.data(), s.size());
+            return s.size();
+        }
+
+        template<class T>
+        std::size_t write(const bitmask::bitmask_formatter<T>& f)
+        {
+            return static_cast<std::size_t>(f.write(m_line) - m_line);
+        }
+
+        std::atomic<int> m_level{warning};
+        char m_line[256];
+        std::size_t m_size = 0;
+    };
+
+    // What the services log today: the text built before the level is checked
+    std::string to_string(const bm& m)
+    {
+        std::ostringstream os;
+        os << std::hex << "0x" << m.bits();
+        return os.str();
+    }
+
+    const bm masks[] = {
+        header_flag::gzip | header_flag::chunked | header_flag::keep_alive,
+        header_flag::no_cache | header_flag::no_store | header_flag::must_revalidate,
+        header_flag::brotli,
+        header_flag::deflate,
+    };
+}
+
+
+void bench_format()
+{
+    logger log;
+    log.set_level(warning);
+    for (const level l: {debug, warning})
+    {
+        const bool enabled = l == warning;
+        bench::run(enabled ? "format/log_enabled/eager_string" : "format/log_disabled/eager_string", iterations,
+                   [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+                log.log(l, to_string(masks[i % 4]));
+        });
+        bench::run(enabled ? "format/log_enabled/bitmask_formatter" : "format/log_disabled/bitmask_formatter",
+                   iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+                log.log(l, bitmask::as_names(masks[i % 4]));
+        });
+    }
+
+    char buffer[bitmask::bitmask_formatter<header_flag>::max_size];
+    bench::run("format/write/names", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(bitmask::as_names(masks[i % 4]).write(buffer));
+    });
+    bench::run("format/write/hex", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(bitmask::as_hex(masks[i % 4]).write(buffer));
+    });
+    bench::run("format/write/binary", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(bitmask::as_binary(masks[i % 4]).write(buffer));
+    });
+}
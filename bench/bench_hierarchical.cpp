@@ -0,0 +1,99 @@
+#include "bench.hpp"
+
+#include <bitmask/hierarchical.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+    const std::size_t size = std::size_t{1} << 24;
+    const std::size_t set_bits = 64;
+    const std::uint64_t iterations = 1 << 12;
+
+    // What the flat bitmaps do: scan the words one by one
+    class flat_bitmap
+    {
+    public:
+        flat_bitmap(): m_words(size / 64) {}
+
+        void set(std::size_t i) { m_words[i / 64] |= std::uint64_t{1} << (i % 64); }
+
+        std::size_t find_next(std::size_t pos) const
+        {
+            std::size_t w = pos / 64;
+            if (w >= m_words.size())
+                return npos;
+            std::uint64_t bits = m_words[w] & (~std::uint64_t{0} << (pos % 64));
+            while (!bits)
+            {
+                if (++w == m_words.size())
+                    return npos;
+                bits = m_words[w];
+            }
+            return w * 64 + static_cast<std::size_t>(bitmask::bitmask_detail::lowest_bit_index(bits));
+        }
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    private:
+        std::vector<std::uint64_t> m_words;
+    };
+
+    constexpr std::size_t flat_bitmap::npos;
+
+    // Visits all the bits of a bitmap with a few bits spread at random over the domain
+    template<class Bitmap>
+    void iterate_sparse(const char* name, Bitmap& b)
+    {
+        std::uint64_t random = 1;
+        for (std::size_t i = 0; i != set_bits; ++i)
+        {
+            random = random * 6364136223846793005u + 1442695040888963407u;
+            b.set(static_cast<std::size_t>(random >> 40));
+        }
+
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+            {
+                std::size_t sum = 0;
+                for (std::size_t pos = b.find_next(0); pos != Bitmap::npos; pos = b.find_next(pos + 1))
+                    sum += pos;
+                bench::do_not_optimize(sum);
+            }
+        });
+    }
+}
+
+
+void bench_hierarchical()
+{
+    std::printf("hierarchical: %zu bits, %zu of them set, ns per full iteration\n", size, set_bits);
+
+    flat_bitmap flat;
+    iterate_sparse("hierarchical/iterate_sparse/flat_scan", flat);
+
+    bitmask::hierarchical_bitmap hierarchical(size);
+    iterate_sparse("hierarchical/iterate_sparse/hierarchical", hierarchical);
+
+    bitmask::concurrent_hierarchical_bitmap concurrent(size);
+    iterate_sparse("hierarchical/iterate_sparse/concurrent", concurrent);
+
+    bench::run("hierarchical/set_clear/hierarchical", iterations * 256, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            const std::size_t pos = static_cast<std::size_t>(i * 40503) % size;
+            hierarchical.set(pos);
+            hierarchical.clear(pos);
+        }
+    });
+    bench::run("hierarchical/set_clear/concurrent", iterations * 256, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            const std::size_t pos = static_cast<std::size_t>(i * 40503) % size;
+            concurrent.set(pos);
+            concurrent.clear(pos);
+        }
+    });
+}
@@ -0,0 +1,103 @@
+#include "bench.hpp"
+
+#include <bitmask/mailbox.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class loop_signal: std::uint32_t
+    {
+        reload_config = 0x01,
+        timer = 0x02,
+        new_work = 0x04,
+        stop = 0x08,
+
+        _bitmask_max_element = stop
+    };
+
+    BITMASK_DEFINE(loop_signal)
+
+    using bm = bitmask::bitmask<loop_signal>;
+
+    const unsigned producers = 2;
+    const std::uint64_t iterations = 1 << 20;
+
+    loop_signal nth_signal(std::uint64_t i) { return static_cast<loop_signal>(1u << (i % 3)); }
+
+    // The usual event loop inbox: a queue node per event and a notify per post
+    class event_queue
+    {
+    public:
+        void post(loop_signal s)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_events.push_back(s);
+            }
+            m_cv.notify_one();
+        }
+
+        bm drain()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return !m_events.empty(); });
+            bm result;
+            for (const auto s: m_events)
+                result |= s;
+            m_events.clear();
+            return result;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<loop_signal> m_events;
+    };
+
+    // `producers` threads post `n` signals in total, then the consumer gets `stop`
+    template<class Inbox>
+    void producers_consumer(const char* name)
+    {
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            Inbox inbox;
+            std::atomic<unsigned> running{producers};
+            std::vector<std::thread> pool;
+            for (unsigned p = 0; p != producers; ++p)
+            {
+                pool.emplace_back([&] {
+                    for (std::uint64_t i = 0; i != n / producers; ++i)
+                        inbox.post(nth_signal(i));
+                    if (--running == 0)
+                        inbox.post(loop_signal::stop);
+                });
+            }
+
+            std::uint64_t drains = 0;
+            while (!(inbox.drain() & loop_signal::stop))
+                ++drains;
+            bench::do_not_optimize(drains);
+            for (auto& t: pool)
+                t.join();
+        });
+    }
+}
+
+
+void bench_mailbox()
+{
+    producers_consumer<event_queue>("mailbox/post/mutex_queue");
+    producers_consumer<bitmask::flag_mailbox<loop_signal>>("mailbox/post/flag_mailbox");
+
+    bitmask::flag_mailbox<loop_signal> mb;
+    bench::run("mailbox/post/pending", iterations * 16, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(mb.post(nth_signal(i)));
+    });
+}
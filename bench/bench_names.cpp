@@ -0,0 +1,152 @@
+#include "bench.hpp"
+
+#include <bitmask/names.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
+
+namespace
+{
+    enum class header_flag: std::uint32_t
+    {
+        gzip = 1 << 0,
+        deflate = 1 << 1,
+        brotli = 1 << 2,
+        chunked = 1 << 3,
+        keep_alive = 1 << 4,
+        no_cache = 1 << 5,
+        no_store = 1 << 6,
+        must_revalidate = 1 << 7,
+        proxy_revalidate = 1 << 8,
+        immutable = 1 << 9,
+        private_ = 1 << 10,
+        public_ = 1 << 11,
+
+        _bitmask_max_element = public_
+    };
+
+    BITMASK_DEFINE(header_flag)
+    BITMASK_DEFINE_NAMES(header_flag, gzip, deflate, brotli, chunked, keep_alive, no_cache, no_store, must_revalidate,
+                         proxy_revalidate, immutable, private_, public_)
+
+    using bm = bitmask::bitmask<header_flag>;
+
+    const std::uint64_t iterations = 1 << 20;
+
+    const char* const inputs[] = {
+        "gzip|chunked|keep_alive",
+        "no_cache|no_store|must_revalidate",
+        "brotli",
+        "private_|immutable|proxy_revalidate|deflate",
+    };
+
+    // What the services do today: a map from the name to the flag
+    class map_names
+    {
+    public:
+        map_names()
+        {
+            const auto& names = bitmask::bitmask_detail::name_table<header_flag>::names;
+            for (const auto& e: names.entries)
+            {
+                m_by_name[e.name] = e.value;
+                m_by_flag[e.value] = e.name;
+            }
+        }
+
+        bool parse(const char* s, bm& result) const
+        {
+            result = bm();
+            for (;;)
+            {
+                const char* end = std::strchr(s, '|');
+                const auto i = m_by_name.find(end ? std::string(s, end) : std::string(s));
+                if (i == m_by_name.end())
+                    return false;
+                result |= i->second;
+                if (!end)
+                    return true;
+                s = end + 1;
+            }
+        }
+
+        std::string format(const bm& m) const
+        {
+            std::string result;
+            for (const auto& e: m_by_flag)
+            {
+                if (m & e.first)
+                {
+                    if (!result.empty())
+                        result += '|';
+                    result += e.second;
+                }
+            }
+            return result;
+        }
+
+    private:
+        std::map<std::string, header_flag> m_by_name;
+        std::map<header_flag, std::string> m_by_flag;
+    };
+}
+
+
+void bench_names()
+{
+    map_names map;
+
+    // Timing a parser that stops at the first unknown name measures nothing
+    for (const char* input: inputs)
+    {
+        bm m;
+        const auto r = bitmask::parse<header_flag>(input);
+        if (!map.parse(input, m) || !r || r.value != m)
+        {
+            std::printf("names: \"%s\" does not parse\n", input);
+            return;
+        }
+    }
+
+    bench::run("names/parse/map", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            bm m;
+            map.parse(inputs[i % 4], m);
+            bench::do_not_optimize(m);
+        }
+    });
+    bench::run("names/parse/perfect_hash", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            auto r = bitmask::parse<header_flag>(inputs[i % 4]);
+            bench::do_not_optimize(r);
+        }
+    });
+
+    const bm masks[] = {
+        header_flag::gzip | header_flag::chunked | header_flag::keep_alive,
+        header_flag::no_cache | header_flag::no_store | header_flag::must_revalidate,
+        header_flag::brotli,
+        header_flag::private_ | header_flag::immutable | header_flag::proxy_revalidate | header_flag::deflate,
+    };
+    bench::run("names/format/map_to_string", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            auto s = map.format(masks[i % 4]);
+            bench::do_not_optimize(s);
+        }
+    });
+    bench::run("names/format/format_to", iterations, [&](std::uint64_t n) {
+        char buffer[bitmask::max_formatted_size<header_flag>::value];
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            char* end = bitmask::format_to(buffer, masks[i % 4]);
+            bench::do_not_optimize(end);
+        }
+    });
+}
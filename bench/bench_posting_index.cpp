@@ -0,0 +1,67 @@
+#include "bench.hpp"
+
+#include <bitmask/posting_index.hpp>
+#include <bitmask/sliced_index.hpp>
+
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class attribute: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFF
+    };
+
+    BITMASK_DEFINE(attribute)
+
+    const std::size_t data_size = 1 << 24;
+    const std::uint64_t iterations = 1 << 4;
+}
+
+
+void bench_posting_index()
+{
+    using bm = bitmask::bitmask<attribute>;
+
+    // Every flag is set on about 0.1% of the rows
+    std::mt19937_64 gen{42};
+    std::vector<bm> rows(data_size);
+    for (std::size_t i = 0; i != data_size * 32 / 1000; ++i)
+        rows[gen() % data_size] |= bitmask::bitmask_detail::to_enum<attribute>(std::uint32_t{1} << (gen() % 32));
+
+    const bitmask::bitmask_posting_index<attribute> postings(rows.data(), rows.data() + rows.size());
+    const bitmask::bitmask_sliced_index<attribute> slices(rows.data(), rows.data() + rows.size());
+
+    std::printf("%-48s %10.3f MiB\n", "posting_index/u32/postings_size (x16M)", static_cast<double>(postings.size_in_bytes()) / (1 << 20));
+    std::printf("%-48s %10.3f MiB\n", "posting_index/u32/slices_size (x16M)", static_cast<double>(bitmask::bitmask_sliced_index<attribute>::slice_count * slices.slice_words() * 8) / (1 << 20));
+
+    const bm a = bitmask::bitmask_detail::to_enum<attribute>(0x1);
+    const bm b = bitmask::bitmask_detail::to_enum<attribute>(0x100);
+    const bm c = bitmask::bitmask_detail::to_enum<attribute>(0x10000);
+
+    bench::run("posting_index/u32/a_or_b_not_c/slices (x16M)", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it != n; ++it)
+        {
+            auto bitmap = slices.filter_any(a | b);
+            bitmask::simd::not_words(bitmap.data(), slices.slice(attribute(0x10000)), bitmap.data(), bitmap.size());
+            bench::do_not_optimize(bitmap);
+        }
+    });
+
+    bench::run("posting_index/u32/a_or_b_not_c/postings (x16M)", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it != n; ++it)
+            bench::do_not_optimize(postings.select_any(a | b) - postings.postings(attribute(0x10000)));
+    });
+
+    bench::run("posting_index/u32/a_and_b_not_c/slices (x16M)", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it != n; ++it)
+            bench::do_not_optimize(slices.filter(a | b, c));
+    });
+
+    bench::run("posting_index/u32/a_and_b_not_c/postings (x16M)", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it != n; ++it)
+            bench::do_not_optimize(postings.select(a | b, c));
+    });
+}
@@ -0,0 +1,67 @@
+#include "bench.hpp"
+
+#include <bitmask/replicated.hpp>
+
+#include <atomic>
+#include <mutex>
+
+
+namespace
+{
+    enum class feature: std::uint64_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF
+    };
+
+    BITMASK_DEFINE(feature)
+
+    enum class shard
+    {
+        first = 0,
+        last = 511
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(shard, last)
+
+    const std::uint64_t iterations = 1 << 24;
+}
+
+
+void bench_replicated()
+{
+    // Single reader, so this is the cost of a read itself. The point of the replicas is that it stays so with
+    // many cores reading while a writer dirties the shared value.
+    bitmask::atomic_bitmask<feature> shared;
+    shared.set(static_cast<feature>(0x11));
+    bench::run("replicated/load/atomic_bitmask", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(shared.load(std::memory_order_acquire).contains_any(static_cast<feature>(1)));
+    });
+
+    bitmask::replicated_bitmask<feature> replicated(static_cast<feature>(0x11));
+    bench::run("replicated/load/replicated_bitmask", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(replicated.load().contains_any(static_cast<feature>(1)));
+    });
+
+    std::mutex mutex;
+    bitmask::bitmask<shard> guarded(shard::last);
+    bench::run("replicated/load_512_bits/mutex", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bench::do_not_optimize(guarded.contains_any(shard::last));
+        }
+    });
+
+    bitmask::replicated_bitmask<shard> wide(shard::last);
+    bench::run("replicated/load_512_bits/replicated_bitmask", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(wide.load().contains_any(shard::last));
+    });
+
+    bench::run("replicated/set/replicated_bitmask", iterations / 16, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            replicated.set(bitmask::bitmask_detail::to_enum<feature>(std::uint64_t{1} << (i % 64)));
+    });
+}
@@ -0,0 +1,104 @@
+#include "bench.hpp"
+
+#include <bitmask/scheduler.hpp>
+
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+    enum class priority: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFF
+    };
+
+    BITMASK_DEFINE(priority)
+
+    struct task: bitmask::run_queue_hook {};
+
+    const std::uint64_t iterations = 1 << 22;
+
+    priority nth_level(std::uint64_t i)
+    {
+        return static_cast<priority>(1u << ((i * 7) % 16));
+    }
+
+    // What the schedulers keep the tasks in otherwise: a binary heap ordered by level and then by pushing order
+    class heap_run_queue
+    {
+    public:
+        void push(priority level, task& t)
+        {
+            m_heap.push(entry{static_cast<std::uint32_t>(level), m_seq--, &t});
+        }
+
+        task* pop_highest()
+        {
+            task* t = m_heap.top().t;
+            m_heap.pop();
+            return t;
+        }
+
+    private:
+        struct entry
+        {
+            std::uint32_t level;
+            std::uint64_t seq;
+            task* t;
+
+            bool operator < (const entry& r) const { return level != r.level ? level < r.level : seq < r.seq; }
+        };
+
+        std::priority_queue<entry> m_heap;
+        std::uint64_t m_seq = ~std::uint64_t{0};
+    };
+
+    // Keeps `depth` tasks queued, takes the next one and queues it again like a scheduler switching tasks
+    template<class Queue>
+    void switch_tasks(const char* name, std::size_t depth)
+    {
+        Queue q;
+        std::vector<task> tasks(depth);
+        for (std::size_t i = 0; i != depth; ++i)
+            q.push(nth_level(i), tasks[i]);
+
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+            {
+                task* t = q.pop_highest();
+                bench::do_not_optimize(t);
+                q.push(nth_level(i), *t);
+            }
+        });
+    }
+}
+
+
+void bench_scheduler()
+{
+    switch_tasks<heap_run_queue>("scheduler/switch/64_tasks/heap", 64);
+    switch_tasks<bitmask::priority_run_queue<priority, task>>("scheduler/switch/64_tasks/priority_run_queue", 64);
+    switch_tasks<heap_run_queue>("scheduler/switch/64k_tasks/heap", 1 << 16);
+    switch_tasks<bitmask::priority_run_queue<priority, task>>("scheduler/switch/64k_tasks/priority_run_queue", 1 << 16);
+
+    // Uncontended round trip through the worker's own queue and through stealing from another worker
+    bitmask::work_stealing_scheduler<priority, task> s(4);
+    task t;
+    bench::run("scheduler/work_stealing/own_queue", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            s.push(0, nth_level(i), t);
+            bench::do_not_optimize(s.pop(0));
+        }
+    });
+    bench::run("scheduler/work_stealing/steal", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            s.push(2, nth_level(i), t);
+            bench::do_not_optimize(s.pop(0));
+        }
+    });
+}
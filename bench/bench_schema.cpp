@@ -0,0 +1,124 @@
+#include "bench.hpp"
+
+#include <bitmask/schema.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+    namespace v1
+    {
+        enum class flag: std::uint32_t
+        {
+            gzip = 1 << 0, deflate = 1 << 1, brotli = 1 << 2, chunked = 1 << 3, keep_alive = 1 << 4,
+            no_cache = 1 << 5, no_store = 1 << 6, must_revalidate = 1 << 7, immutable = 1 << 8,
+
+            _bitmask_max_element = immutable
+        };
+
+        BITMASK_DEFINE(flag)
+        BITMASK_DEFINE_NAMES(flag, gzip, deflate, brotli, chunked, keep_alive, no_cache, no_store, must_revalidate,
+                             immutable)
+    }
+
+    // `brotli` is dropped, the rest keep their order
+    namespace v2_dropped
+    {
+        enum class flag: std::uint32_t
+        {
+            gzip = 1 << 0, deflate = 1 << 1, chunked = 1 << 2, keep_alive = 1 << 3,
+            no_cache = 1 << 4, no_store = 1 << 5, must_revalidate = 1 << 6, immutable = 1 << 7,
+
+            _bitmask_max_element = immutable
+        };
+
+        BITMASK_DEFINE(flag)
+        BITMASK_DEFINE_NAMES(flag, gzip, deflate, chunked, keep_alive, no_cache, no_store, must_revalidate, immutable)
+    }
+
+    // Renumbered
+    namespace v2_renumbered
+    {
+        enum class flag: std::uint32_t
+        {
+            immutable = 1 << 0, must_revalidate = 1 << 1, no_store = 1 << 2, no_cache = 1 << 3, keep_alive = 1 << 4,
+            chunked = 1 << 5, brotli = 1 << 6, deflate = 1 << 7, gzip = 1 << 8,
+
+            _bitmask_max_element = gzip
+        };
+
+        BITMASK_DEFINE(flag)
+        BITMASK_DEFINE_NAMES(flag, immutable, must_revalidate, no_store, no_cache, keep_alive, chunked, brotli,
+                             deflate, gzip)
+    }
+
+    const std::size_t count = 1 << 16;
+    const std::uint64_t iterations = 1 << 26;
+
+    // The schema and `count` records
+    std::vector<unsigned char> v1_file()
+    {
+        std::vector<unsigned char> file(bitmask::schema_size<v1::flag>::value + count * 4);
+        unsigned char* out = bitmask::write_schema<v1::flag>(file.data());
+        std::uint32_t x = 12345;
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            x = x * 1664525u + 1013904223u;
+            out = bitmask::encode_fixed(out, bitmask::bitmask<v1::flag>(static_cast<v1::flag>((x >> 8) & 0x1FFu)));
+        }
+        return file;
+    }
+
+    template<class T>
+    void load(const char* name, const std::vector<unsigned char>& file)
+    {
+        bitmask::schema_remap<T> remap;
+        const unsigned char* const end = file.data() + file.size();
+        const unsigned char* const records = remap.read_schema(file.data(), end).next;
+        std::vector<bitmask::bitmask<T>> out(count);
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i += count)
+                bench::do_not_optimize(remap.decode(records, end, out.data(), out.data() + count));
+        });
+    }
+
+    // What the name-keyed records would cost without the remap: the names of every record parsed on load
+    void load_by_names(const std::vector<unsigned char>& file)
+    {
+        std::vector<std::vector<char>> texts;
+        const unsigned char* in = file.data() + bitmask::schema_size<v1::flag>::value;
+        for (std::size_t i = 0; i != count; ++i, in += 4)
+        {
+            std::vector<char> text(bitmask::max_formatted_size<v1::flag>::value);
+            text.resize(static_cast<std::size_t>(
+                bitmask::format_to(text.data(), bitmask::decode_fixed<v1::flag>(in, in + 4).value) - text.data()));
+            texts.push_back(text);
+        }
+
+        std::vector<bitmask::bitmask<v2_renumbered::flag>> out(count);
+        bench::run("schema/load/names_per_record", iterations / 16, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i += count)
+                for (std::size_t j = 0; j != count; ++j)
+                    out[j] = bitmask::parse<v2_renumbered::flag>(texts[j].data(), texts[j].size()).value;
+            bench::do_not_optimize(out);
+        });
+    }
+}
+
+
+void bench_schema()
+{
+    const std::vector<unsigned char> file = v1_file();
+    load<v1::flag>("schema/load/same_schema", file);
+    load<v2_dropped::flag>("schema/load/dropped_flag", file);
+    load<v2_renumbered::flag>("schema/load/renumbered", file);
+    load_by_names(file);
+
+    bitmask::schema_remap<v2_renumbered::flag> remap;
+    bench::run("schema/read_schema", 1 << 20, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(remap.read_schema(file.data(), file.data() + file.size()));
+    });
+}
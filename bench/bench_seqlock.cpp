@@ -0,0 +1,73 @@
+#include "bench.hpp"
+
+#include <bitmask/seqlock.hpp>
+
+#include <mutex>
+#include <vector>
+
+
+namespace
+{
+    enum class dirty_shard
+    {
+        first = 0,
+        last = 511
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(dirty_shard, last)
+
+    using bm = bitmask::bitmask<dirty_shard>;
+
+    const std::uint64_t iterations = 1 << 24;
+
+    dirty_shard nth_shard(std::uint64_t i) { return static_cast<dirty_shard>(i % 512); }
+
+    // Building a 512 bit mask out of an index costs more than the operations themselves
+    std::vector<bm> single_flag_masks()
+    {
+        std::vector<bm> masks;
+        for (std::uint64_t i = 0; i != 512; ++i)
+            masks.push_back(nth_shard(i));
+        return masks;
+    }
+}
+
+
+void bench_seqlock()
+{
+    const std::vector<bm> masks = single_flag_masks();
+
+    std::mutex mutex;
+    bm guarded;
+    bench::run("seqlock/load/mutex", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bench::do_not_optimize(guarded.contains_any(dirty_shard::last));
+        }
+    });
+
+    bitmask::seqlock_bitmask<dirty_shard> s;
+    bench::run("seqlock/load/seqlock_bitmask", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(s.load().contains_any(dirty_shard::last));
+    });
+
+    bench::run("seqlock/test/seqlock_bitmask", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(s.test(nth_shard(i)));
+    });
+
+    bench::run("seqlock/fetch_or/mutex", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            guarded |= masks[i % 512];
+        }
+    });
+
+    bench::run("seqlock/fetch_or/seqlock_bitmask", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i != n; ++i)
+            bench::do_not_optimize(s.fetch_or(masks[i % 512]));
+    });
+}
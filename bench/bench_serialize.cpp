@@ -0,0 +1,102 @@
+#include "bench.hpp"
+
+#include <bitmask/serialize.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+    // 9 flags spread over 32 bits
+    enum class sparse: std::uint32_t
+    {
+        _bitmask_value_mask = 0xC0103087u
+    };
+
+    BITMASK_DEFINE(sparse)
+
+    using bm = bitmask::bitmask<sparse>;
+
+    const std::size_t count = 1 << 16;
+    const std::uint64_t iterations = 1 << 28;
+
+    std::vector<bm> sample()
+    {
+        std::vector<bm> v;
+        std::uint32_t x = 12345;
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            x = x * 1664525u + 1013904223u;
+            v.push_back(bm(static_cast<sparse>(x & 0xC0103087u)));
+        }
+        return v;
+    }
+
+    // Runs `fn` over the whole sample, the time is reported per value
+    template<class Fn>
+    void run_bulk(const char* name, Fn fn)
+    {
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i += count)
+                fn();
+        });
+    }
+}
+
+
+void bench_serialize()
+{
+    const std::vector<bm> values = sample();
+    std::vector<bm> decoded(count);
+    std::vector<unsigned char> buf(count * bitmask::max_varint_size<sparse>::value);
+    const bm* first = values.data();
+    const bm* last = first + count;
+    bm* out = decoded.data();
+
+    unsigned char* end = bitmask::encode_fixed(buf.data(), first, last);
+    run_bulk("serialize/fixed/encode_one_by_one", [&] {
+        unsigned char* p = buf.data();
+        for (const bm* v = first; v != last; ++v)
+            p = bitmask::encode_fixed(p, *v);
+        bench::do_not_optimize(p);
+    });
+    run_bulk("serialize/fixed/encode_bulk", [&] {
+        bench::do_not_optimize(bitmask::encode_fixed(buf.data(), first, last));
+    });
+    run_bulk("serialize/fixed/decode_one_by_one", [&] {
+        const unsigned char* p = buf.data();
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            const auto r = bitmask::decode_fixed<sparse>(p, end);
+            out[i] = r.value;
+            p = r.next;
+        }
+        bench::do_not_optimize(out);
+    });
+    run_bulk("serialize/fixed/decode_bulk", [&] {
+        bench::do_not_optimize(bitmask::decode_fixed(buf.data(), end, out, out + count));
+    });
+
+    end = bitmask::encode_varint(buf.data(), first, last);
+    run_bulk("serialize/varint/encode_bulk", [&] {
+        bench::do_not_optimize(bitmask::encode_varint(buf.data(), first, last));
+    });
+    run_bulk("serialize/varint/decode_bulk", [&] {
+        bench::do_not_optimize(bitmask::decode_varint(buf.data(), end, out, out + count));
+    });
+
+    end = bitmask::encode_dense(buf.data(), first, last);
+    run_bulk("serialize/dense/encode_bulk/runs", [&] {
+        bench::do_not_optimize(bitmask::bitmask_detail::encode_dense_runs(buf.data(), first, last));
+    });
+    run_bulk("serialize/dense/encode_bulk", [&] {
+        bench::do_not_optimize(bitmask::encode_dense(buf.data(), first, last));
+    });
+    run_bulk("serialize/dense/decode_bulk/runs", [&] {
+        bench::do_not_optimize(bitmask::bitmask_detail::decode_dense_runs(buf.data(), out, count));
+    });
+    run_bulk("serialize/dense/decode_bulk", [&] {
+        bench::do_not_optimize(bitmask::decode_dense(buf.data(), end, out, out + count));
+    });
+}
@@ -0,0 +1,128 @@
+#include "bench.hpp"
+
+#include <bitmask/simd.hpp>
+
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class rules_128 { last = 127 };
+    enum class rules_256 { last = 255 };
+    enum class rules_512 { last = 511 };
+    enum class rules_1024 { last = 1023 };
+
+    BITMASK_DEFINE_BIT_INDEX(rules_128, last)
+    BITMASK_DEFINE_BIT_INDEX(rules_256, last)
+    BITMASK_DEFINE_BIT_INDEX(rules_512, last)
+    BITMASK_DEFINE_BIT_INDEX(rules_1024, last)
+
+    const std::size_t data_size = 1024;
+    const std::uint64_t iterations = 1 << 12;
+
+    template<class T>
+    std::vector<bitmask::bitmask<T>> random_masks(std::size_t n)
+    {
+        std::mt19937_64 gen{42};
+        std::vector<bitmask::bitmask<T>> result(n);
+        for (auto& m : result)
+        {
+            for (std::size_t i = 0; i != bitmask::bitmask<T>::word_count; ++i)
+                m.data()[i] = gen();
+        }
+        return result;
+    }
+
+    // Runs `op(a[i], b[i])` over the arrays of bitmasks and accumulates the result
+    template<class T, class Op>
+    void run(const char* name, const std::vector<bitmask::bitmask<T>>& a, const std::vector<bitmask::bitmask<T>>& b, Op op)
+    {
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+            {
+                for (std::size_t i = 0; i != a.size(); ++i)
+                {
+                    auto r = op(a[i], b[i]);
+                    bench::do_not_optimize(r);
+                }
+            }
+        });
+    }
+
+    template<class T>
+    void bench_domain(const char* domain)
+    {
+        using bm = bitmask::bitmask<T>;
+
+        const auto a = random_masks<T>(data_size);
+        const auto b = random_masks<T>(data_size);
+
+        const auto name = [&](const char* op, const char* impl) {
+            static char buf[128];
+            std::snprintf(buf, sizeof(buf), "simd/%s/%s/%s (x1024)", domain, op, impl);
+            return buf;
+        };
+
+        run(name("and", "scalar"), a, b, [](const bm& l, const bm& r) { return l & r; });
+        run(name("and", "kernel"), a, b, [](const bm& l, const bm& r) {
+            bm result;
+            bitmask::simd::and_words(result.data(), l.data(), r.data(), bm::word_count);
+            return result;
+        });
+        run(name("equal", "scalar"), a, b, [](const bm& l, const bm& r) { return l == r; });
+        run(name("equal", "kernel"), a, b, [](const bm& l, const bm& r) { return bitmask::simd::equal_words(l.data(), r.data(), bm::word_count); });
+        run(name("equal", "simd"), a, b, [](const bm& l, const bm& r) { return bitmask::simd::equal(l, r); });
+        run(name("contains_all", "scalar"), a, b, [](const bm& l, const bm& r) { return l.contains_all(r); });
+        run(name("contains_all", "simd"), a, b, [](const bm& l, const bm& r) { return bitmask::simd::contains_all(l, r); });
+        run(name("count", "scalar"), a, b, [](const bm& l, const bm&) { return l.count(); });
+        run(name("count", "simd"), a, b, [](const bm& l, const bm&) { return bitmask::simd::count(l); });
+    }
+
+    void bench_words()
+    {
+        const std::size_t n = 1 << 16;
+
+        std::mt19937_64 gen{42};
+        std::vector<std::uint64_t> a(n), b(n), dst(n);
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            a[i] = gen();
+            b[i] = gen();
+        }
+
+        bench::run("simd/words/and/scalar (x65536)", 1 << 10, [&](std::uint64_t iterations) {
+            for (std::uint64_t it = 0; it != iterations; ++it)
+            {
+                bitmask::simd::simd_detail::scalar::transform<bitmask::simd::simd_detail::op_and>(dst.data(), a.data(), b.data(), n);
+                bench::do_not_optimize(dst);
+            }
+        });
+        bench::run("simd/words/and/simd (x65536)", 1 << 10, [&](std::uint64_t iterations) {
+            for (std::uint64_t it = 0; it != iterations; ++it)
+            {
+                bitmask::simd::and_words(dst.data(), a.data(), b.data(), n);
+                bench::do_not_optimize(dst);
+            }
+        });
+        bench::run("simd/words/popcount/scalar (x65536)", 1 << 10, [&](std::uint64_t iterations) {
+            for (std::uint64_t it = 0; it != iterations; ++it)
+                bench::do_not_optimize(bitmask::simd::simd_detail::scalar::popcount(a.data(), n));
+        });
+        bench::run("simd/words/popcount/simd (x65536)", 1 << 10, [&](std::uint64_t iterations) {
+            for (std::uint64_t it = 0; it != iterations; ++it)
+                bench::do_not_optimize(bitmask::simd::popcount_words(a.data(), n));
+        });
+    }
+}
+
+
+void bench_simd()
+{
+    bench_words();
+
+    bench_domain<rules_128>("128");
+    bench_domain<rules_256>("256");
+    bench_domain<rules_512>("512");
+    bench_domain<rules_1024>("1024");
+}
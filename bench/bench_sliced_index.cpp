@@ -0,0 +1,70 @@
+#include "bench.hpp"
+
+#include <bitmask/sliced_index.hpp>
+
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class attribute: std::uint32_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFF
+    };
+
+    BITMASK_DEFINE(attribute)
+
+    const std::size_t data_size = 1 << 24;
+    const std::uint64_t iterations = 1 << 4;
+
+    template<class Fn>
+    void bench_query(const char* name, Fn&& query)
+    {
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t it = 0; it != n; ++it)
+                bench::do_not_optimize(query());
+        });
+    }
+}
+
+
+void bench_sliced_index()
+{
+    using bm = bitmask::bitmask<attribute>;
+
+    std::mt19937_64 gen{42};
+    bitmask::bitmask_vector<attribute> rows;
+    rows.reserve(data_size);
+    for (std::size_t i = 0; i != data_size; ++i)
+        rows.push_back(bitmask::bitmask_detail::to_enum<attribute>(static_cast<std::uint32_t>(gen())));
+
+    bench::run("sliced_index/u32/build (x16M)", iterations / 4, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it != n; ++it)
+            bench::do_not_optimize(bitmask::bitmask_sliced_index<attribute>(rows));
+    });
+
+    const bitmask::bitmask_sliced_index<attribute> index(rows);
+
+    // "Rows with A and B but not C"
+    const bm a = bitmask::bitmask_detail::to_enum<attribute>(0x1);
+    const bm b = bitmask::bitmask_detail::to_enum<attribute>(0x100);
+    const bm c = bitmask::bitmask_detail::to_enum<attribute>(0x10000);
+
+    bench_query("sliced_index/u32/a_and_b_not_c/rows (x16M)", [&] {
+        std::vector<std::uint64_t> bitmap(bitmask::simd::bitmap_words(rows.size()));
+        bitmask::simd::match(rows.data(), rows.size(), (a | b | c).bits(), (a | b).bits(), false, bitmap.data());
+        return bitmap;
+    });
+
+    bench_query("sliced_index/u32/a_and_b_not_c/slices (x16M)", [&] {
+        return index.filter(a | b, c);
+    });
+
+    const auto selected = index.filter(a | b, c);
+
+    bench::run("sliced_index/u32/materialize_1/8 (x16M)", iterations, [&](std::uint64_t n) {
+        for (std::uint64_t it = 0; it != n; ++it)
+            bench::do_not_optimize(index.materialize(selected));
+    });
+}
@@ -0,0 +1,109 @@
+#include "bench.hpp"
+
+#include <bitmask/slot_allocator.hpp>
+
+#include <atomic>
+#include <vector>
+
+
+namespace
+{
+    const std::size_t capacity = 1 << 20;
+    const std::uint64_t iterations = 1 << 16;
+
+    // What the hand written allocators do: scan the words from the beginning, claim with a CAS
+    class linear_allocator
+    {
+    public:
+        linear_allocator(): m_words(capacity / 64) {}
+
+        std::size_t acquire()
+        {
+            for (std::size_t w = 0; w != m_words.size(); ++w)
+            {
+                std::uint64_t bits = m_words[w].load(std::memory_order_relaxed);
+                while (bits != ~std::uint64_t{0})
+                {
+                    const std::uint64_t bit = ~bits & (bits + 1);
+                    if (m_words[w].compare_exchange_weak(bits, bits | bit, std::memory_order_acquire))
+                        return w * 64 + static_cast<std::size_t>(bitmask::bitmask_detail::lowest_bit_index(bit));
+                }
+            }
+            return static_cast<std::size_t>(-1);
+        }
+
+        void fill()
+        {
+            for (auto& w: m_words)
+                w.store(~std::uint64_t{0}, std::memory_order_relaxed);
+        }
+
+        void release(std::size_t slot)
+        {
+            m_words[slot / 64].fetch_and(~(std::uint64_t{1} << (slot % 64)), std::memory_order_release);
+        }
+
+    private:
+        std::vector<std::atomic<std::uint64_t>> m_words;
+    };
+
+    void fill(linear_allocator& a)
+    {
+        a.fill();
+    }
+
+    void fill(bitmask::slot_allocator& a)
+    {
+        std::vector<std::size_t> slots(capacity);
+        a.acquire_n(capacity, slots.data());
+    }
+
+    // The allocator is full except for one slot at a random place that the search has to find
+    template<class Allocator>
+    void find_single_free_slot(const char* name, Allocator& a)
+    {
+        fill(a);
+        std::uint64_t random = 1;
+        bench::run(name, iterations, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i != n; ++i)
+            {
+                random = random * 6364136223846793005u + 1442695040888963407u;
+                a.release(static_cast<std::size_t>(random >> 44));
+                bench::do_not_optimize(a.acquire());
+            }
+        });
+    }
+}
+
+
+void bench_slot_allocator()
+{
+    std::printf("slot_allocator: %zu slots\n", capacity);
+
+    linear_allocator linear;
+    find_single_free_slot("slot_allocator/find_free/linear_scan", linear);
+
+    bitmask::slot_allocator no_summary(capacity, false);
+    find_single_free_slot("slot_allocator/find_free/no_summary", no_summary);
+
+    bitmask::slot_allocator summary(capacity);
+    find_single_free_slot("slot_allocator/find_free/summary", summary);
+
+    bitmask::slot_allocator batch(capacity);
+    std::vector<std::size_t> slots(16);
+    bench::run("slot_allocator/acquire_16/acquire", iterations * 16, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; i += 16)
+        {
+            for (std::size_t k = 0; k != 16; ++k)
+                slots[k] = batch.acquire();
+            batch.release_n(slots.data(), 16);
+        }
+    });
+    bench::run("slot_allocator/acquire_16/acquire_n", iterations * 16, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; i += 16)
+        {
+            batch.acquire_n(16, slots.data());
+            batch.release_n(slots.data(), 16);
+        }
+    });
+}
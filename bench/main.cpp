@@ -0,0 +1,25 @@
+#include "bench.hpp"
+
+
+int main()
+{
+    bench_bitmask();
+    bench_simd();
+    bench_bitmask_vector();
+    bench_algorithm();
+    bench_sliced_index();
+    bench_posting_index();
+    bench_atomic();
+    bench_event_group();
+    bench_mailbox();
+    bench_counters();
+    bench_replicated();
+    bench_seqlock();
+    bench_slot_allocator();
+    bench_hierarchical();
+    bench_scheduler();
+    bench_names();
+    bench_format();
+    bench_serialize();
+    bench_schema();
+}
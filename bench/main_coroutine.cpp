@@ -0,0 +1,7 @@
+#include "bench.hpp"
+
+
+int main()
+{
+    bench_coroutine();
+}
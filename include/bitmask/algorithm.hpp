@@ -0,0 +1,257 @@
+#pragma once
+
+/*
+    Bitmask algorithms
+    ==================
+
+    Bulk algorithms over contiguous ranges of `bitmask<T>`.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace bitmask {
+
+    // Controls the parallel versions of the algorithms
+    struct parallel_options
+    {
+        // Ranges of fewer elements are processed in the calling thread only
+        std::size_t min_size = std::size_t{1} << 20;
+
+        // Maximum number of threads including the calling one. Zero means `std::thread::hardware_concurrency()`.
+        unsigned max_threads = 0;
+    };
+
+    namespace bitmask_detail {
+        // Array of `bitmask<T>` viewed as the array of its bits
+        template<class T>
+        inline const underlying_type_t<T>* raw_bits(const bitmask<T>* p) noexcept
+        {
+            static_assert(sizeof(bitmask<T>) == sizeof(underlying_type_t<T>) && std::is_standard_layout<bitmask<T>>::value,
+                          "bitmask<T> is not layout compatible with its underlying type");
+            return reinterpret_cast<const underlying_type_t<T>*>(p);
+        }
+
+        // Reductions. `stop` is the absorbing value (if any): once the result is equal to it no element can change it.
+
+        struct reduction_or
+        {
+            using op = simd::simd_detail::op_or;
+            static constexpr bool can_stop = true;
+            template<class T> static bitmask<T> init() noexcept { return {}; }
+            template<class T> static bitmask<T> stop() noexcept { return ~bitmask<T>{}; }
+            template<class T> static void apply(bitmask<T>& acc, const bitmask<T>& v) noexcept { acc |= v; }
+        };
+
+        struct reduction_and
+        {
+            using op = simd::simd_detail::op_and;
+            static constexpr bool can_stop = true;
+            template<class T> static bitmask<T> init() noexcept { return ~bitmask<T>{}; }
+            template<class T> static bitmask<T> stop() noexcept { return {}; }
+            template<class T> static void apply(bitmask<T>& acc, const bitmask<T>& v) noexcept { acc &= v; }
+        };
+
+        struct reduction_xor
+        {
+            using op = simd::simd_detail::op_xor;
+            static constexpr bool can_stop = false;
+            template<class T> static bitmask<T> init() noexcept { return {}; }
+            template<class T> static bitmask<T> stop() noexcept { return {}; }
+            template<class T> static void apply(bitmask<T>& acc, const bitmask<T>& v) noexcept { acc ^= v; }
+        };
+
+        // Regular bitmasks are reduced with the SIMD kernels
+        template<class Reduction, class T>
+        inline bitmask<T> reduce(const bitmask<T>* first, const bitmask<T>* last, std::false_type) noexcept
+        {
+            return to_enum<T>(simd::simd_detail::reduce<typename Reduction::op>(
+                raw_bits(first), static_cast<std::size_t>(last - first),
+                Reduction::template init<T>().bits(), Reduction::template stop<T>().bits(), Reduction::can_stop));
+        }
+
+        // Bit index bitmasks are reduced with their own operators that the compiler vectorizes
+        template<class Reduction, class T>
+        inline bitmask<T> reduce(const bitmask<T>* first, const bitmask<T>* last, std::true_type) noexcept
+        {
+            const std::size_t chunk = 64;
+            const bitmask<T> stop = Reduction::template stop<T>();
+
+            bitmask<T> acc = Reduction::template init<T>();
+            while (first != last)
+            {
+                const bitmask<T>* end = last - first > static_cast<std::ptrdiff_t>(chunk) ? first + chunk : last;
+                for (; first != end; ++first)
+                    Reduction::apply(acc, *first);
+                if (Reduction::can_stop && acc == stop)
+                    break;
+            }
+            return acc;
+        }
+
+        template<class Reduction, class T>
+        inline bitmask<T> reduce(const bitmask<T>* first, const bitmask<T>* last) noexcept
+        {
+            return reduce<Reduction>(first, last, is_bit_index_enum<T>{});
+        }
+
+        // Splits the range between threads. Each thread reduces its part in blocks and checks between the blocks
+        // if any thread has already got the absorbing value.
+        template<class Reduction, class T>
+        inline bitmask<T> parallel_reduce(const bitmask<T>* first, const bitmask<T>* last, const parallel_options& options)
+        {
+            const std::size_t n = static_cast<std::size_t>(last - first);
+
+            unsigned threads = options.max_threads ? options.max_threads : std::thread::hardware_concurrency();
+            if (n < options.min_size || threads < 2)
+                return reduce<Reduction>(first, last);
+
+            const std::size_t block = std::size_t{1} << 16;
+            const std::size_t per_thread = (n + threads - 1) / threads;
+            const bitmask<T> stop = Reduction::template stop<T>();
+
+            std::atomic<bool> stopped{false};
+            std::vector<bitmask<T>> partial(threads, Reduction::template init<T>());
+
+            const auto worker = [&](unsigned k) {
+                const bitmask<T>* p = first + (std::min)(n, per_thread * k);
+                const bitmask<T>* end = first + (std::min)(n, per_thread * (k + 1));
+                while (p != end && !stopped.load(std::memory_order_relaxed))
+                {
+                    const bitmask<T>* block_end = static_cast<std::size_t>(end - p) > block ? p + block : end;
+                    Reduction::apply(partial[k], reduce<Reduction>(p, block_end));
+                    p = block_end;
+                    if (Reduction::can_stop && partial[k] == stop)
+                        stopped.store(true, std::memory_order_relaxed);
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+            for (unsigned k = 1; k != threads; ++k)
+                pool.emplace_back(worker, k);
+            worker(0);
+            for (auto& t : pool)
+                t.join();
+
+            bitmask<T> result = Reduction::template init<T>();
+            for (const auto& p : partial)
+                Reduction::apply(result, p);
+            return result;
+        }
+    }
+
+    // Union of all the bitmasks of the range. Stops as soon as all the bits of the domain are set.
+    template<class T>
+    inline bitmask<T> reduce_or(const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        return bitmask_detail::reduce<bitmask_detail::reduction_or>(first, last);
+    }
+
+    // Intersection of all the bitmasks of the range (all the bits of the domain for an empty range).
+    // Stops as soon as no bit is set.
+    template<class T>
+    inline bitmask<T> reduce_and(const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        return bitmask_detail::reduce<bitmask_detail::reduction_and>(first, last);
+    }
+
+    // Symmetric difference of all the bitmasks of the range
+    template<class T>
+    inline bitmask<T> reduce_xor(const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        return bitmask_detail::reduce<bitmask_detail::reduction_xor>(first, last);
+    }
+
+    // Versions of the reductions that split the range between threads if it's at least `options.min_size` long
+
+    template<class T>
+    inline bitmask<T> parallel_reduce_or(const bitmask<T>* first, const bitmask<T>* last,
+                                         const parallel_options& options = parallel_options{})
+    {
+        return bitmask_detail::parallel_reduce<bitmask_detail::reduction_or>(first, last, options);
+    }
+
+    template<class T>
+    inline bitmask<T> parallel_reduce_and(const bitmask<T>* first, const bitmask<T>* last,
+                                          const parallel_options& options = parallel_options{})
+    {
+        return bitmask_detail::parallel_reduce<bitmask_detail::reduction_and>(first, last, options);
+    }
+
+    template<class T>
+    inline bitmask<T> parallel_reduce_xor(const bitmask<T>* first, const bitmask<T>* last,
+                                          const parallel_options& options = parallel_options{})
+    {
+        return bitmask_detail::parallel_reduce<bitmask_detail::reduction_xor>(first, last, options);
+    }
+
+    namespace bitmask_detail {
+        template<class T, bool = is_bit_index_enum<T>::value>
+        struct flag_count_of
+            : std::integral_constant<std::size_t, static_cast<std::size_t>(popcount(bitmask<T>::mask_value))> {};
+
+        // Every index up to the maximum one is a flag
+        template<class T>
+        struct flag_count_of<T, true> : std::integral_constant<std::size_t, bitmask<T>::max_index + 1> {};
+    }
+
+    // Number of the flags (single bit values) in the domain of `bitmask<T>`
+    template<class T>
+    struct flag_count : bitmask_detail::flag_count_of<T> {};
+
+    // Position of `flag` among the flags of its domain ordered by bit. Gaps in the domain are skipped.
+    template<class T>
+    inline constexpr std::size_t flag_index(T flag) noexcept
+    {
+        using underlying_type = typename bitmask<T>::underlying_type;
+        return static_cast<std::size_t>(bitmask_detail::popcount(static_cast<underlying_type>(
+            bitmask<T>::mask_value & (static_cast<underlying_type>(flag) - 1u))));
+    }
+
+    namespace bitmask_detail {
+        template<class T>
+        inline void flag_histogram(const bitmask<T>* first, const bitmask<T>* last, std::uint64_t* result, std::false_type) noexcept
+        {
+            using underlying_type = typename bitmask<T>::underlying_type;
+
+            std::uint64_t bit_counts[std::numeric_limits<underlying_type>::digits] = {};
+            simd::positional_popcount(raw_bits(first), static_cast<std::size_t>(last - first), bit_counts);
+
+            std::size_t i = 0;
+            for (underlying_type m = bitmask<T>::mask_value; m; m = static_cast<underlying_type>(m & (m - 1u)))
+                result[i++] = bit_counts[lowest_bit_index(m)];
+        }
+
+        // Only called after the `static_assert` of `flag_histogram()` has failed, so that it is the only error
+        template<class T>
+        inline void flag_histogram(const bitmask<T>*, const bitmask<T>*, std::uint64_t*, std::true_type) noexcept {}
+    }
+
+    // Number of the bitmasks of the range that have each flag set, indexed by `flag_index()`.
+    // All the counts are computed in a single pass with the positional popcount kernels.
+    template<class T>
+    inline std::array<std::uint64_t, flag_count<T>::value> flag_histogram(const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+        std::array<std::uint64_t, flag_count<T>::value> result;
+        bitmask_detail::flag_histogram(first, last, result.data(), bitmask_detail::is_bit_index_enum<T>{});
+        return result;
+    }
+}
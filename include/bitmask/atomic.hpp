@@ -0,0 +1,204 @@
+#pragma once
+
+/*
+    Atomic bitmask
+    ==============
+
+    `atomic_bitmask<T>` is a lock-free flag word shared between threads that is read and modified as `bitmask<T>`.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+
+namespace bitmask {
+
+    namespace bitmask_detail {
+        // Spin-wait hint for the CPU
+        inline void cpu_relax() noexcept
+        {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_ia32_pause();
+#endif
+        }
+
+        // Small number that tells the threads apart, assigned in the order of the first use.
+        // The thread local is constant initialized (zero means not assigned yet), so it's accessed without
+        // a guard check.
+        inline std::size_t thread_ordinal() noexcept
+        {
+            static std::atomic<std::size_t> next{0};
+            static thread_local std::size_t ordinal = 0;
+            if (!ordinal)
+                ordinal = next.fetch_add(1, std::memory_order_relaxed) + 1;
+            return ordinal - 1;
+        }
+    }
+
+    // All the operations take `bitmask<T>` operands and thus keep the value inside the `mask_value` domain.
+    // On x86 the modifications that discard the previous value compile to `lock or/and/xor`, and `test_and_set()`
+    // / `test_and_clear()` compile to `lock bts/btr`. The `fetch_*` ones that return the previous value need a CAS
+    // loop there since the instruction set has no such instructions.
+    template<class T>
+    class atomic_bitmask
+    {
+    public:
+        using value_type = bitmask<T>;
+        using underlying_type = typename bitmask<T>::underlying_type;
+
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+        atomic_bitmask() noexcept = default;
+
+        constexpr atomic_bitmask(const value_type& v) noexcept: m_bits{v.bits()} {}
+
+        atomic_bitmask(const atomic_bitmask&) = delete;
+        atomic_bitmask& operator = (const atomic_bitmask&) = delete;
+
+        bool is_lock_free() const noexcept { return m_bits.is_lock_free(); }
+
+        value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+        {
+            return bitmask_detail::to_enum<T>(m_bits.load(order));
+        }
+
+        void store(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            m_bits.store(v.bits(), order);
+        }
+
+        value_type exchange(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return bitmask_detail::to_enum<T>(m_bits.exchange(v.bits(), order));
+        }
+
+        bool compare_exchange_weak(value_type& expected, const value_type& desired,
+                                   std::memory_order success, std::memory_order failure) noexcept
+        {
+            underlying_type bits = expected.bits();
+            const bool result = m_bits.compare_exchange_weak(bits, desired.bits(), success, failure);
+            expected = bitmask_detail::to_enum<T>(bits);
+            return result;
+        }
+
+        bool compare_exchange_weak(value_type& expected, const value_type& desired,
+                                   std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return compare_exchange_weak(expected, desired, order, failure_order(order));
+        }
+
+        bool compare_exchange_strong(value_type& expected, const value_type& desired,
+                                     std::memory_order success, std::memory_order failure) noexcept
+        {
+            underlying_type bits = expected.bits();
+            const bool result = m_bits.compare_exchange_strong(bits, desired.bits(), success, failure);
+            expected = bitmask_detail::to_enum<T>(bits);
+            return result;
+        }
+
+        bool compare_exchange_strong(value_type& expected, const value_type& desired,
+                                     std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return compare_exchange_strong(expected, desired, order, failure_order(order));
+        }
+
+        // Sets the bits of `v` and returns the previous value
+        value_type fetch_or(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return bitmask_detail::to_enum<T>(m_bits.fetch_or(v.bits(), order));
+        }
+
+        // Clears the bits missing in `v` and returns the previous value
+        value_type fetch_and(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return bitmask_detail::to_enum<T>(m_bits.fetch_and(v.bits(), order));
+        }
+
+        // Flips the bits of `v` and returns the previous value
+        value_type fetch_xor(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return bitmask_detail::to_enum<T>(m_bits.fetch_xor(v.bits(), order));
+        }
+
+        // Sets the bits of `v`
+        void set(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            m_bits.fetch_or(v.bits(), order);
+        }
+
+        // Clears the bits of `v`
+        void clear(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            m_bits.fetch_and(static_cast<underlying_type>(~v.bits()), order);
+        }
+
+        // Flips the bits of `v`
+        void flip(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            m_bits.fetch_xor(v.bits(), order);
+        }
+
+        bool test(T flag, std::memory_order order = std::memory_order_seq_cst) const noexcept
+        {
+            return (m_bits.load(order) & bit(flag)) != 0;
+        }
+
+        // Sets `flag` and returns its previous state
+        bool test_and_set(T flag, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            const underlying_type b = bit(flag);
+            return (m_bits.fetch_or(b, order) & b) != 0;
+        }
+
+        // Clears `flag` and returns its previous state
+        bool test_and_clear(T flag, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            const underlying_type b = bit(flag);
+            return (m_bits.fetch_and(static_cast<underlying_type>(~b), order) & b) != 0;
+        }
+
+        operator value_type() const noexcept { return load(); }
+
+        atomic_bitmask& operator = (const value_type& v) noexcept
+        {
+            store(v);
+            return *this;
+        }
+
+        // Compound assignments return the new value like the ones of `std::atomic`
+        value_type operator |= (const value_type& v) noexcept { return fetch_or(v) | v; }
+        value_type operator &= (const value_type& v) noexcept { return fetch_and(v) & v; }
+        value_type operator ^= (const value_type& v) noexcept { return fetch_xor(v) ^ v; }
+
+        // Underlying atomic word, for example to wait on it
+        std::atomic<underlying_type>& word() noexcept { return m_bits; }
+        const std::atomic<underlying_type>& word() const noexcept { return m_bits; }
+
+    private:
+        // A single flag of the domain. It's rebuilt as `1 << index` since that's the form compilers turn into
+        // `lock bts/btr` when the flag is not a constant.
+        static underlying_type bit(T flag) noexcept
+        {
+            const auto b = static_cast<underlying_type>(flag);
+            assert(b != 0 && (b & (b - 1u)) == 0 && (b & value_type::mask_value) == b);
+            return static_cast<underlying_type>(underlying_type{1} << bitmask_detail::lowest_bit_index(b));
+        }
+
+        static constexpr std::memory_order failure_order(std::memory_order order) noexcept
+        {
+            return order == std::memory_order_acq_rel ? std::memory_order_acquire
+                 : order == std::memory_order_release ? std::memory_order_relaxed
+                 : order;
+        }
+
+        std::atomic<underlying_type> m_bits{0};
+    };
+}
@@ -7,7 +7,7 @@
     A generic implementation of the BitmaskType C++ concept
     http://en.cppreference.com/w/cpp/concept/BitmaskType
 
-    Version: 1.1.2
+    Version: 1.2
 
     Latest version and documentation:
         https://github.com/oliora/bitmask
@@ -19,6 +19,34 @@
 
     Changes history
     ---------------
+    v1.2:
+        - Add iteration over the set values of `bitmask<T>`
+        - Add `count()`, `lowest()`, `highest()`, `pop_lowest()`, `has_single_bit()` and `is_full()`
+        - Add `contains_all()`, `contains_any()`, `contains_none()` and `is_subset_of()`
+        - Add bit index bitmasks (`BITMASK_DEFINE_BIT_INDEX`) that are not limited by the width of the underlying type
+        - Breaking: `bitmask` has a second, defaulted template parameter, so `template<class T> class bitmask;` no longer
+          forward declares it
+        - Add `simd.hpp` with vectorized kernels over arrays of words selected at run time
+        - Add `bitmask_vector.hpp` with a packed container of bitmasks and vectorized filtering
+        - Add `algorithm.hpp` with OR/AND/XOR reductions over ranges of bitmasks
+        - Add `flag_histogram()` that counts every flag over a range of bitmasks in a single pass
+        - Add `sliced_index.hpp` with a bit-sliced (one bitmap per flag) index of bitmasks
+        - Add `posting_index.hpp` with compressed per flag row sets for sparse flags
+        - Add `atomic.hpp` with `atomic_bitmask<T>`
+        - Add `event_group.hpp` with `event_group<T>`
+        - Add `coroutine.hpp` with `awaitable_bitmask<T>` (C++20)
+        - Add `mailbox.hpp` with `flag_mailbox<T>`
+        - Add `counters.hpp` with `flag_counters<T>`
+        - Add `replicated.hpp` with `replicated_bitmask<T>`
+        - Add `seqlock.hpp` with `seqlock_bitmask<T>`
+        - Add `slot_allocator.hpp` with lock-free `slot_allocator`
+        - Add `hierarchical.hpp` with `hierarchical_bitmap` and `concurrent_hierarchical_bitmap`
+        - Add `scheduler.hpp` with `priority_run_queue<T, Task>` and `work_stealing_scheduler<T, Task>`
+        - Add `names.hpp` with `BITMASK_DEFINE_NAMES`, `parse()` and `format_to()`
+        - Add `BITMASK_LITERAL` and `parse_literal()` that parse flag names at compile time
+        - Add `format.hpp` with lazy `bitmask_formatter<T>` for `operator<<`, `std::format` and {fmt}
+        - Add `serialize.hpp` with fixed width, varint and dense binary encodings of single bitmasks and ranges
+        - Add `schema.hpp` with name-keyed dictionaries and `schema_remap<T>` that reads the records of older enums
     v1.1.2:
         - Fix: Can not define bitmask for a class local enum (https://github.com/oliora/bitmask/issues/3)
     v1.1.1:
@@ -35,6 +63,10 @@
 #include <type_traits>
 #include <functional>  // for std::hash
 #include <limits>  // for std::numeric_limits
+#include <iterator>  // for std::forward_iterator_tag
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <cassert>
 
 
@@ -111,13 +143,164 @@ namespace bitmask {
             : std::integral_constant<underlying_type_t<T>, static_cast<underlying_type_t<T>>(T::_bitmask_value_mask)> {};
 
         template<class T>
-        inline constexpr underlying_type_t<T> disable_unused_function_warnings() noexcept
+        inline constexpr int disable_unused_function_warnings() noexcept
         {
-            return (static_cast<T>(0) & static_cast<T>(0)).bits()
-                & (static_cast<T>(0) | static_cast<T>(0)).bits()
-                & (static_cast<T>(0) ^ static_cast<T>(0)).bits()
-                & (~static_cast<T>(0)).bits()
-                & bits(static_cast<T>(0));
+            return (void)(static_cast<T>(0) & static_cast<T>(0)),
+                (void)(static_cast<T>(0) | static_cast<T>(0)),
+                (void)(static_cast<T>(0) ^ static_cast<T>(0)),
+                (void)(~static_cast<T>(0)),
+                (void)bits(static_cast<T>(0)),
+                0;
+        }
+
+        // std::index_sequence is introduced in C++14 so let's have our own
+        template<std::size_t... I>
+        struct index_sequence {};
+
+        template<std::size_t N, std::size_t... I>
+        struct make_index_sequence_impl : make_index_sequence_impl<N - 1, N - 1, I...> {};
+
+        template<std::size_t... I>
+        struct make_index_sequence_impl<0, I...> { using type = index_sequence<I...>; };
+
+        template<std::size_t N>
+        using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+        // Folds used to process all the words of a bit index bitmask in a single expression the compiler can
+        // unroll and vectorize.
+        inline constexpr std::uint64_t or_all() noexcept { return 0; }
+
+        template<class... Ws>
+        inline constexpr std::uint64_t or_all(std::uint64_t w, Ws... ws) noexcept { return w | or_all(ws...); }
+
+        inline constexpr std::size_t sum_all() noexcept { return 0; }
+
+        template<class... Ns>
+        inline constexpr std::size_t sum_all(std::size_t n, Ns... ns) noexcept { return n + sum_all(ns...); }
+
+        // Bits of the word `i` of a bit index bitmask that are in the domain i.e. have index `<= max_index`
+        inline constexpr std::uint64_t word_mask(std::size_t max_index, std::size_t i) noexcept
+        {
+            return i < max_index / 64 ? ~std::uint64_t{0}
+                : i > max_index / 64 ? 0
+                : max_index % 64 == 63 ? ~std::uint64_t{0}
+                : (std::uint64_t{1} << (max_index % 64 + 1)) - 1;
+        }
+
+        template<std::size_t MaxIndex, std::size_t... I>
+        inline constexpr std::array<std::uint64_t, sizeof...(I)> words_mask(index_sequence<I...>) noexcept
+        {
+            return std::array<std::uint64_t, sizeof...(I)>{{word_mask(MaxIndex, I)...}};
+        }
+
+        template<class U>
+        inline std::size_t hash_bits(const U& bits) noexcept
+        {
+            return std::hash<U>{}(bits);
+        }
+
+        template<std::size_t N>
+        inline std::size_t hash_bits(const std::array<std::uint64_t, N>& words) noexcept
+        {
+            std::size_t seed = 0;
+            for (auto w: words)
+                seed ^= std::hash<std::uint64_t>{}(w) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+
+        // Bit manipulation primitives.
+        // GCC and Clang builtins are constexpr and compile to POPCNT/TZCNT/LZCNT when the target has them.
+        // Other compilers use the portable constexpr fallbacks.
+
+        template<class U>
+        using builtin_uint_t = typename std::conditional<sizeof(U) <= sizeof(unsigned), unsigned,
+            typename std::conditional<sizeof(U) <= sizeof(unsigned long), unsigned long, unsigned long long>::type>::type;
+
+        inline constexpr std::uint64_t popcount_fallback_bytes(std::uint64_t x) noexcept
+        {
+            return (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        }
+
+        inline constexpr std::uint64_t popcount_fallback_nibbles(std::uint64_t x) noexcept
+        {
+            return (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        }
+
+        inline constexpr int popcount_fallback(std::uint64_t x) noexcept
+        {
+            return static_cast<int>((popcount_fallback_bytes(popcount_fallback_nibbles(
+                x - ((x >> 1) & 0x5555555555555555ull))) * 0x0101010101010101ull) >> 56);
+        }
+
+        // Sets all the bits below the highest set bit
+        inline constexpr std::uint64_t smear_right_fallback(std::uint64_t x, int shift = 1) noexcept
+        {
+            return shift == 64 ? x : smear_right_fallback(x | (x >> shift), shift * 2);
+        }
+
+        inline constexpr int lowest_bit_index_fallback(std::uint64_t x) noexcept
+        {
+            return popcount_fallback((x & (0 - x)) - 1);
+        }
+
+        inline constexpr int highest_bit_index_fallback(std::uint64_t x) noexcept
+        {
+            return popcount_fallback(smear_right_fallback(x)) - 1;
+        }
+
+#if defined(__GNUC__) || defined(__clang__)
+        inline constexpr int popcount_builtin(unsigned x) noexcept { return __builtin_popcount(x); }
+        inline constexpr int popcount_builtin(unsigned long x) noexcept { return __builtin_popcountl(x); }
+        inline constexpr int popcount_builtin(unsigned long long x) noexcept { return __builtin_popcountll(x); }
+
+        inline constexpr int countr_zero_builtin(unsigned x) noexcept { return __builtin_ctz(x); }
+        inline constexpr int countr_zero_builtin(unsigned long x) noexcept { return __builtin_ctzl(x); }
+        inline constexpr int countr_zero_builtin(unsigned long long x) noexcept { return __builtin_ctzll(x); }
+
+        inline constexpr int countl_zero_builtin(unsigned x) noexcept { return __builtin_clz(x); }
+        inline constexpr int countl_zero_builtin(unsigned long x) noexcept { return __builtin_clzl(x); }
+        inline constexpr int countl_zero_builtin(unsigned long long x) noexcept { return __builtin_clzll(x); }
+#endif
+
+        // Number of set bits
+        template<class U>
+        inline constexpr int popcount(U x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return popcount_builtin(static_cast<builtin_uint_t<U>>(x));
+#else
+            return popcount_fallback(static_cast<std::uint64_t>(x));
+#endif
+        }
+
+        // Index of the lowest set bit. `x` must be non-zero.
+        template<class U>
+        inline constexpr int lowest_bit_index(U x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return countr_zero_builtin(static_cast<builtin_uint_t<U>>(x));
+#else
+            return lowest_bit_index_fallback(static_cast<std::uint64_t>(x));
+#endif
+        }
+
+        // Index of the highest set bit. `x` must be non-zero.
+        template<class U>
+        inline constexpr int highest_bit_index(U x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return std::numeric_limits<builtin_uint_t<U>>::digits - 1 - countl_zero_builtin(static_cast<builtin_uint_t<U>>(x));
+#else
+            return highest_bit_index_fallback(static_cast<std::uint64_t>(x));
+#endif
+        }
+
+        // Converts the raw bits to the enum type without relying on the unspecified conversion of
+        // an out of range value to the enum with the signed underlying type.
+        template<class T>
+        inline constexpr T to_enum(underlying_type_t<T> value) noexcept
+        {
+            return static_cast<T>(static_cast<typename std::underlying_type<T>::type>(value));
         }
 
         template<class Assert>
@@ -143,8 +326,30 @@ namespace bitmask {
         return bitmask_detail::enum_mask<T>::value;
     }
 
+    namespace bitmask_detail {
+        // Returned by default `get_enum_max_bit_index` to tell that bitmask is not a bit index one
+        struct no_max_bit_index {};
+    }
 
     template<class T>
+    inline constexpr bitmask_detail::no_max_bit_index get_enum_max_bit_index(const T&) noexcept
+    {
+        return {};
+    }
+
+    namespace bitmask_detail {
+        // Enum values are bit indices rather than bits (see `BITMASK_DEFINE_BIT_INDEX`)
+        template<class T>
+        struct is_bit_index_enum : std::integral_constant<bool,
+            !std::is_same<decltype(get_enum_max_bit_index(std::declval<T>())), no_max_bit_index>::value> {};
+
+        // Underlying type for the comparison with raw bits. Not available for the bit index bitmasks.
+        template<class T>
+        using comparable_bits_t = typename std::enable_if<!is_bit_index_enum<T>::value, underlying_type_t<T>>::type;
+    }
+
+
+    template<class T, class = void>
     class bitmask
     {
     public:
@@ -153,6 +358,52 @@ namespace bitmask {
 
         static constexpr underlying_type mask_value = get_enum_mask(static_cast<value_type>(0));
 
+        // Iterates over the bitmask values (i.e. the distinct bits) set in the bitmask, from the lowest to the highest.
+        // Only the set bits are visited so the gaps of a noncontiguous value mask cost nothing.
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = T;
+
+            constexpr const_iterator() noexcept = default;
+
+            // Lowest set bit i.e. `x & -x`
+            constexpr reference operator * () const noexcept
+            {
+                return bitmask_detail::to_enum<T>(static_cast<underlying_type>(m_bits & (0u - m_bits)));
+            }
+
+            // Clears the lowest set bit i.e. `x & (x - 1)`
+            const_iterator& operator ++ () noexcept
+            {
+                m_bits = static_cast<underlying_type>(m_bits & (m_bits - 1u));
+                return *this;
+            }
+
+            const_iterator operator ++ (int) noexcept
+            {
+                const_iterator tmp{*this};
+                ++*this;
+                return tmp;
+            }
+
+            constexpr bool operator == (const const_iterator& r) const noexcept { return m_bits == r.m_bits; }
+            constexpr bool operator != (const const_iterator& r) const noexcept { return m_bits != r.m_bits; }
+
+        private:
+            friend class bitmask;
+
+            constexpr explicit const_iterator(underlying_type bits) noexcept: m_bits{bits} {}
+
+            underlying_type m_bits = 0;
+        };
+
+        using iterator = const_iterator;
+
         constexpr bitmask() noexcept = default;
         constexpr bitmask(std::nullptr_t) noexcept: m_bits{0} {}
 
@@ -163,6 +414,56 @@ namespace bitmask {
 
         constexpr explicit operator bool() const noexcept { return bits() ? true : false; }
 
+        constexpr const_iterator begin() const noexcept { return const_iterator{m_bits}; }
+        constexpr const_iterator end() const noexcept { return const_iterator{}; }
+
+        // Number of bits set
+        constexpr std::size_t count() const noexcept
+        {
+            return static_cast<std::size_t>(bitmask_detail::popcount(m_bits));
+        }
+
+        // Returns true if the bitmask has exactly one bit set
+        constexpr bool has_single_bit() const noexcept
+        {
+            return m_bits != 0 && (m_bits & (m_bits - 1u)) == 0;
+        }
+
+        // Returns true if all the bits of the domain are set i.e. the bitmask is equal to `mask_value`
+        constexpr bool is_full() const noexcept { return m_bits == mask_value; }
+
+        // Returns the lowest set bit or an empty bitmask if no bit is set
+        constexpr bitmask lowest() const noexcept
+        {
+            return bitmask{std::true_type{}, m_bits & (0u - m_bits)};
+        }
+
+        // Returns the highest set bit or an empty bitmask if no bit is set
+        constexpr bitmask highest() const noexcept
+        {
+            return bitmask{std::true_type{}, m_bits ? underlying_type{1} << bitmask_detail::highest_bit_index(m_bits) : 0};
+        }
+
+        // Returns true if all the bits set in `r` are set in the bitmask
+        constexpr bool contains_all(const bitmask& r) const noexcept { return (m_bits & r.m_bits) == r.m_bits; }
+
+        // Returns true if any of the bits set in `r` is set in the bitmask
+        constexpr bool contains_any(const bitmask& r) const noexcept { return (m_bits & r.m_bits) != 0; }
+
+        // Returns true if none of the bits set in `r` is set in the bitmask
+        constexpr bool contains_none(const bitmask& r) const noexcept { return (m_bits & r.m_bits) == 0; }
+
+        // Returns true if all the bits set in the bitmask are set in `r`
+        constexpr bool is_subset_of(const bitmask& r) const noexcept { return (m_bits & ~r.m_bits) == 0; }
+
+        // Clears the lowest set bit and returns it. Returns an empty bitmask if no bit is set.
+        bitmask pop_lowest() noexcept
+        {
+            const bitmask l = lowest();
+            m_bits = static_cast<underlying_type>(m_bits & (m_bits - 1u));
+            return l;
+        }
+
         constexpr bitmask operator ~ () const noexcept
         {
             return bitmask{std::true_type{}, ~m_bits & mask_value};
@@ -209,6 +510,290 @@ namespace bitmask {
         underlying_type m_bits = 0;
     };
 
+    // Bitmask for the enum which values are bit indices rather than bits (see `BITMASK_DEFINE_BIT_INDEX`).
+    // Bits are stored in an array of 64 bit words so the number of values is not limited by the width of the
+    // enum's underlying type. The operations are expanded over all the words at compile time so
+    // the compiler can unroll and vectorize them.
+    template<class T>
+    class bitmask<T, typename std::enable_if<bitmask_detail::is_bit_index_enum<T>::value>::type>
+    {
+    public:
+        using value_type = T;
+        using word_type = std::uint64_t;
+
+        static constexpr std::size_t max_index = get_enum_max_bit_index(static_cast<value_type>(0));
+        static constexpr std::size_t word_bits = 64;
+        static constexpr std::size_t word_count = max_index / word_bits + 1;
+
+        using underlying_type = std::array<word_type, word_count>;
+
+        static_assert(!bitmask_detail::has_value_mask<T>::value && !bitmask_detail::has_max_element<T>::value,
+                      "Bit index bitmask can't have _bitmask_max_element or _bitmask_value_mask");
+
+        static constexpr underlying_type mask_value =
+            bitmask_detail::words_mask<max_index>(bitmask_detail::make_index_sequence<word_count>{});
+
+        // Iterates over the values set in the bitmask, from the lowest index to the highest.
+        // The iterator refers to the bitmask it's obtained from.
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = T;
+
+            constexpr const_iterator() noexcept = default;
+
+            constexpr reference operator * () const noexcept
+            {
+                return bitmask_detail::to_enum<T>(static_cast<bitmask_detail::underlying_type_t<T>>(
+                    m_word * word_bits + static_cast<std::size_t>(bitmask_detail::lowest_bit_index(m_bits))));
+            }
+
+            const_iterator& operator ++ () noexcept
+            {
+                m_bits &= m_bits - 1;
+                while (!m_bits && ++m_word < word_count)
+                    m_bits = m_words[m_word];
+                return *this;
+            }
+
+            const_iterator operator ++ (int) noexcept
+            {
+                const_iterator tmp{*this};
+                ++*this;
+                return tmp;
+            }
+
+            constexpr bool operator == (const const_iterator& r) const noexcept
+            {
+                return m_word == r.m_word && m_bits == r.m_bits;
+            }
+
+            constexpr bool operator != (const const_iterator& r) const noexcept { return !(*this == r); }
+
+        private:
+            friend class bitmask;
+
+            constexpr const_iterator(const word_type* words, std::size_t word) noexcept
+            : m_words{words}, m_word{word}, m_bits{word < word_count ? words[word] : 0} {}
+
+            const word_type* m_words = nullptr;
+            std::size_t m_word = word_count;
+            word_type m_bits = 0;
+        };
+
+        using iterator = const_iterator;
+
+        constexpr bitmask() noexcept = default;
+        constexpr bitmask(std::nullptr_t) noexcept {}
+
+        constexpr bitmask(value_type value) noexcept
+        : bitmask{checked_index(value), indices{}} {}
+
+        constexpr underlying_type bits() const noexcept { return bits(indices{}); }
+
+        // Word `i` of the bits, `i` must be less than `word_count`
+        constexpr word_type word(std::size_t i) const noexcept { return m_words[i]; }
+
+        // Raw access to the `word_count` words of the bits. The caller is responsible for keeping the bits
+        // that are out of the domain (see `mask_value`) clear.
+        word_type* data() noexcept { return m_words; }
+        const word_type* data() const noexcept { return m_words; }
+
+        constexpr explicit operator bool() const noexcept { return any(indices{}); }
+
+        constexpr const_iterator begin() const noexcept { return const_iterator{m_words, first_word(0)}; }
+        constexpr const_iterator end() const noexcept { return const_iterator{}; }
+
+        constexpr std::size_t count() const noexcept { return count(indices{}); }
+
+        constexpr bool has_single_bit() const noexcept { return count() == 1; }
+
+        constexpr bool is_full() const noexcept { return is_full(indices{}); }
+
+        constexpr bitmask lowest() const noexcept { return lowest_in(first_word(0)); }
+        constexpr bitmask highest() const noexcept { return highest_in(last_word(word_count)); }
+
+        constexpr bool contains_all(const bitmask& r) const noexcept { return contains_all(r, indices{}); }
+        constexpr bool contains_any(const bitmask& r) const noexcept { return contains_any(r, indices{}); }
+        constexpr bool contains_none(const bitmask& r) const noexcept { return !contains_any(r, indices{}); }
+        constexpr bool is_subset_of(const bitmask& r) const noexcept { return r.contains_all(*this, indices{}); }
+
+        bitmask pop_lowest() noexcept
+        {
+            for (std::size_t i = 0; i != word_count; ++i)
+            {
+                if (m_words[i])
+                {
+                    bitmask l;
+                    l.m_words[i] = m_words[i] & (0 - m_words[i]);
+                    m_words[i] &= m_words[i] - 1;
+                    return l;
+                }
+            }
+            return {};
+        }
+
+        constexpr bitmask operator ~ () const noexcept { return complement(indices{}); }
+
+        constexpr bitmask operator & (const bitmask& r) const noexcept { return bit_and(r, indices{}); }
+        constexpr bitmask operator | (const bitmask& r) const noexcept { return bit_or(r, indices{}); }
+        constexpr bitmask operator ^ (const bitmask& r) const noexcept { return bit_xor(r, indices{}); }
+
+        bitmask& operator |= (const bitmask& r) noexcept
+        {
+            for (std::size_t i = 0; i != word_count; ++i)
+                m_words[i] |= r.m_words[i];
+            return *this;
+        }
+
+        bitmask& operator &= (const bitmask& r) noexcept
+        {
+            for (std::size_t i = 0; i != word_count; ++i)
+                m_words[i] &= r.m_words[i];
+            return *this;
+        }
+
+        bitmask& operator ^= (const bitmask& r) noexcept
+        {
+            for (std::size_t i = 0; i != word_count; ++i)
+                m_words[i] ^= r.m_words[i];
+            return *this;
+        }
+
+        // These are preferred over the generic operators that compare the bits with `underlying_type`
+        friend constexpr bool operator == (const bitmask& l, const bitmask& r) noexcept { return l.equal(r, indices{}); }
+        friend constexpr bool operator != (const bitmask& l, const bitmask& r) noexcept { return !l.equal(r, indices{}); }
+        friend constexpr bool operator == (value_type l, const bitmask& r) noexcept { return bitmask{l} == r; }
+        friend constexpr bool operator != (value_type l, const bitmask& r) noexcept { return bitmask{l} != r; }
+        friend constexpr bool operator == (const bitmask& l, value_type r) noexcept { return l == bitmask{r}; }
+        friend constexpr bool operator != (const bitmask& l, value_type r) noexcept { return l != bitmask{r}; }
+
+        friend constexpr bool operator < (const bitmask& l, const bitmask& r) noexcept { return l.less(r, word_count); }
+
+    private:
+        using indices = bitmask_detail::make_index_sequence<word_count>;
+
+        template<class... Ws>
+        constexpr explicit bitmask(std::true_type, Ws... words) noexcept
+        : m_words{static_cast<word_type>(words)...} {}
+
+        template<std::size_t... I>
+        constexpr bitmask(std::size_t index, bitmask_detail::index_sequence<I...>) noexcept
+        : m_words{(I == index / word_bits ? word_type{1} << (index % word_bits) : 0)...} {}
+
+        static constexpr std::size_t checked_index(value_type value) noexcept
+        {
+            return bitmask_constexpr_assert(static_cast<std::size_t>(value) <= max_index), static_cast<std::size_t>(value);
+        }
+
+        // Index of the first non-zero word starting from `i` or `word_count` if there is none
+        constexpr std::size_t first_word(std::size_t i) const noexcept
+        {
+            return i == word_count || m_words[i] ? i : first_word(i + 1);
+        }
+
+        // Index of the last non-zero word before `i` or `word_count` if there is none
+        constexpr std::size_t last_word(std::size_t i) const noexcept
+        {
+            return i == 0 ? word_count : m_words[i - 1] ? i - 1 : last_word(i - 1);
+        }
+
+        constexpr bitmask lowest_in(std::size_t i) const noexcept
+        {
+            return i == word_count ? bitmask{} : single_bit(i, m_words[i] & (0 - m_words[i]), indices{});
+        }
+
+        constexpr bitmask highest_in(std::size_t i) const noexcept
+        {
+            return i == word_count ? bitmask{}
+                : single_bit(i, word_type{1} << bitmask_detail::highest_bit_index(m_words[i]), indices{});
+        }
+
+        template<std::size_t... I>
+        static constexpr bitmask single_bit(std::size_t index, word_type bit, bitmask_detail::index_sequence<I...>) noexcept
+        {
+            return bitmask{std::true_type{}, (I == index ? bit : 0)...};
+        }
+
+        template<std::size_t... I>
+        constexpr underlying_type bits(bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return underlying_type{{m_words[I]...}};
+        }
+
+        template<std::size_t... I>
+        constexpr bool any(bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask_detail::or_all(m_words[I]...) != 0;
+        }
+
+        template<std::size_t... I>
+        constexpr std::size_t count(bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask_detail::sum_all(static_cast<std::size_t>(bitmask_detail::popcount(m_words[I]))...);
+        }
+
+        template<std::size_t... I>
+        constexpr bool is_full(bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask_detail::or_all((m_words[I] ^ bitmask_detail::word_mask(max_index, I))...) == 0;
+        }
+
+        template<std::size_t... I>
+        constexpr bool contains_all(const bitmask& r, bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask_detail::or_all((r.m_words[I] & ~m_words[I])...) == 0;
+        }
+
+        template<std::size_t... I>
+        constexpr bool contains_any(const bitmask& r, bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask_detail::or_all((r.m_words[I] & m_words[I])...) != 0;
+        }
+
+        template<std::size_t... I>
+        constexpr bool equal(const bitmask& r, bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask_detail::or_all((r.m_words[I] ^ m_words[I])...) == 0;
+        }
+
+        // Compares the words from the highest one so the order is the same as of the numbers the bitmasks represent
+        constexpr bool less(const bitmask& r, std::size_t i) const noexcept
+        {
+            return i != 0 && (m_words[i - 1] != r.m_words[i - 1] ? m_words[i - 1] < r.m_words[i - 1] : less(r, i - 1));
+        }
+
+        template<std::size_t... I>
+        constexpr bitmask complement(bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask{std::true_type{}, (~m_words[I] & bitmask_detail::word_mask(max_index, I))...};
+        }
+
+        template<std::size_t... I>
+        constexpr bitmask bit_and(const bitmask& r, bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask{std::true_type{}, (m_words[I] & r.m_words[I])...};
+        }
+
+        template<std::size_t... I>
+        constexpr bitmask bit_or(const bitmask& r, bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask{std::true_type{}, (m_words[I] | r.m_words[I])...};
+        }
+
+        template<std::size_t... I>
+        constexpr bitmask bit_xor(const bitmask& r, bitmask_detail::index_sequence<I...>) const noexcept
+        {
+            return bitmask{std::true_type{}, (m_words[I] ^ r.m_words[I])...};
+        }
+
+        word_type m_words[word_count] = {};
+    };
+
     template<class T>
     inline constexpr bitmask<T>
     operator & (T l, const bitmask<T>& r) noexcept { return r & l; }
@@ -246,19 +831,19 @@ namespace bitmask {
 
     template<class T>
     inline constexpr bool
-    operator != (const bitmask_detail::underlying_type_t<T>& l, const bitmask<T>& r) noexcept { return l != r.bits(); }
+    operator != (const bitmask_detail::comparable_bits_t<T>& l, const bitmask<T>& r) noexcept { return l != r.bits(); }
 
     template<class T>
     inline constexpr bool
-    operator == (const bitmask_detail::underlying_type_t<T>& l, const bitmask<T>& r) noexcept { return ! operator != (l, r); }
+    operator == (const bitmask_detail::comparable_bits_t<T>& l, const bitmask<T>& r) noexcept { return ! operator != (l, r); }
 
     template<class T>
     inline constexpr bool
-    operator != (const bitmask<T>& l, const bitmask_detail::underlying_type_t<T>& r) noexcept { return l.bits() != r; }
+    operator != (const bitmask<T>& l, const bitmask_detail::comparable_bits_t<T>& r) noexcept { return l.bits() != r; }
 
     template<class T>
     inline constexpr bool
-    operator == (const bitmask<T>& l, const bitmask_detail::underlying_type_t<T>& r) noexcept { return ! operator != (l, r); }
+    operator == (const bitmask<T>& l, const bitmask_detail::comparable_bits_t<T>& r) noexcept { return ! operator != (l, r); }
 
     // Allow `bitmask` to be be used as a map key
     template<class T>
@@ -266,14 +851,27 @@ namespace bitmask {
     operator < (const bitmask<T>& l, const bitmask<T>& r) noexcept { return l.bits() < r.bits(); }
 
     template<class T>
-    inline constexpr bitmask_detail::underlying_type_t<T>
+    inline constexpr typename bitmask<T>::underlying_type
     bits(const bitmask<T>& bm) noexcept { return bm.bits(); }
 
 
     // Implementation
 
+    template<class T, class Enable>
+    constexpr typename bitmask<T, Enable>::underlying_type bitmask<T, Enable>::mask_value;
+
+    template<class T>
+    constexpr std::size_t bitmask<T, typename std::enable_if<bitmask_detail::is_bit_index_enum<T>::value>::type>::max_index;
+
+    template<class T>
+    constexpr std::size_t bitmask<T, typename std::enable_if<bitmask_detail::is_bit_index_enum<T>::value>::type>::word_bits;
+
     template<class T>
-    constexpr typename bitmask<T>::underlying_type bitmask<T>::mask_value;
+    constexpr std::size_t bitmask<T, typename std::enable_if<bitmask_detail::is_bit_index_enum<T>::value>::type>::word_count;
+
+    template<class T>
+    constexpr typename bitmask<T, typename std::enable_if<bitmask_detail::is_bit_index_enum<T>::value>::type>::underlying_type
+    bitmask<T, typename std::enable_if<bitmask_detail::is_bit_index_enum<T>::value>::type>::mask_value;
 }
 
 
@@ -284,8 +882,7 @@ namespace std
     {
         constexpr std::size_t operator() (const bitmask::bitmask<T>& op) const noexcept
         {
-            using ut = typename bitmask::bitmask<T>::underlying_type;
-            return std::hash<ut>{}(op.bits());
+            return bitmask::bitmask_detail::hash_bits(op.bits());
         }
     };
 }
@@ -316,6 +913,11 @@ namespace std
         return value_mask;                                                                                       \
     }
 
+#define BITMASK_DETAIL_DEFINE_MAX_BIT_INDEX(value_type, max_index) \
+    inline constexpr std::size_t get_enum_max_bit_index(value_type) noexcept { \
+        return static_cast<std::size_t>(value_type::max_index);              \
+    }
+
 #define BITMASK_DETAIL_DEFINE_MAX_ELEMENT(value_type, max_element) \
     inline constexpr bitmask::bitmask_detail::underlying_type_t<value_type> get_enum_mask(value_type) noexcept { \
         return bitmask::bitmask_detail::mask_from_max_element<value_type, value_type::max_element>::value;       \
@@ -341,3 +943,11 @@ namespace std
 #define BITMASK_DEFINE_MAX_ELEMENT(value_type, max_element) \
     BITMASK_DETAIL_DEFINE_MAX_ELEMENT(value_type, max_element) \
     BITMASK_DETAIL_DEFINE_OPS(value_type)
+
+// Defines missing operations for a bit-mask elements enum 'value_type'
+// which values are bit indices rather than bits. 'max_index' is the element
+// with the maximum bit index. The bitmask is not limited by the width of
+// 'value_type' underlying type.
+#define BITMASK_DEFINE_BIT_INDEX(value_type, max_index) \
+    BITMASK_DETAIL_DEFINE_MAX_BIT_INDEX(value_type, max_index) \
+    BITMASK_DETAIL_DEFINE_OPS(value_type)
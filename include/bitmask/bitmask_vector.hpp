@@ -0,0 +1,149 @@
+#pragma once
+
+/*
+    Bitmask vector
+    ==============
+
+    `bitmask_vector<T>` is a packed container of `bitmask<T>` values with vectorized bulk filtering.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <vector>
+
+
+namespace bitmask {
+
+    namespace bitmask_detail {
+        // Allocates the memory aligned by `Align` bytes
+        template<class U, std::size_t Align>
+        struct aligned_allocator
+        {
+            static_assert(Align >= alignof(void*) && (Align & (Align - 1)) == 0, "Alignment is not a power of two");
+
+            using value_type = U;
+
+            template<class V>
+            struct rebind { using other = aligned_allocator<V, Align>; };
+
+            aligned_allocator() noexcept = default;
+
+            template<class V>
+            aligned_allocator(const aligned_allocator<V, Align>&) noexcept {}
+
+            U* allocate(std::size_t n)
+            {
+                // The pointer returned by `operator new` is stored right before the aligned block
+                void* raw = ::operator new(n * sizeof(U) + Align + sizeof(void*));
+                const auto addr = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + Align - 1) & ~(Align - 1);
+                reinterpret_cast<void**>(addr)[-1] = raw;
+                return reinterpret_cast<U*>(addr);
+            }
+
+            void deallocate(U* p, std::size_t) noexcept
+            {
+                ::operator delete(reinterpret_cast<void**>(p)[-1]);
+            }
+
+            template<class V>
+            bool operator == (const aligned_allocator<V, Align>&) const noexcept { return true; }
+
+            template<class V>
+            bool operator != (const aligned_allocator<V, Align>&) const noexcept { return false; }
+        };
+    }
+
+    // Container of `bitmask<T>` that keeps the bits as a contiguous cache line aligned array of `underlying_type`.
+    // Filter functions scan the whole container with SIMD compare kernels (see `simd::match`) and return either
+    // a selection bitmap (bit `i` of word `i / 64` is set if element `i` matches) or a list of the matching indices.
+    template<class T>
+    class bitmask_vector
+    {
+    public:
+        using value_type = bitmask<T>;
+        using underlying_type = typename bitmask<T>::underlying_type;
+        using size_type = std::size_t;
+
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+        static constexpr std::size_t alignment = 64;
+
+        bitmask_vector() = default;
+
+        explicit bitmask_vector(size_type n): m_bits(n) {}
+
+        bitmask_vector(std::initializer_list<value_type> values)
+        {
+            m_bits.reserve(values.size());
+            for (const auto& v : values)
+                push_back(v);
+        }
+
+        size_type size() const noexcept { return m_bits.size(); }
+        bool empty() const noexcept { return m_bits.empty(); }
+        size_type capacity() const noexcept { return m_bits.capacity(); }
+
+        void reserve(size_type n) { m_bits.reserve(n); }
+        void resize(size_type n) { m_bits.resize(n); }
+        void clear() noexcept { m_bits.clear(); }
+
+        void push_back(const value_type& v) { m_bits.push_back(v.bits()); }
+
+        value_type operator [] (size_type i) const noexcept { return bitmask_detail::to_enum<T>(m_bits[i]); }
+
+        void set(size_type i, const value_type& v) noexcept { m_bits[i] = v.bits(); }
+
+        // Raw access to the bits. The caller is responsible for keeping the bits in the domain (see `mask_value`).
+        underlying_type* data() noexcept { return m_bits.data(); }
+        const underlying_type* data() const noexcept { return m_bits.data(); }
+
+        // Elements that have any of the bits of `m` set
+        std::vector<std::uint64_t> filter_any(const value_type& m) const { return filter(m.bits(), 0, true); }
+
+        // Elements that have all the bits of `m` set
+        std::vector<std::uint64_t> filter_all(const value_type& m) const { return filter(m.bits(), m.bits(), false); }
+
+        // Elements that have none of the bits of `m` set
+        std::vector<std::uint64_t> filter_none(const value_type& m) const { return filter(m.bits(), 0, false); }
+
+        // Elements equal to `m`
+        std::vector<std::uint64_t> filter_equal(const value_type& m) const { return filter(value_type::mask_value, m.bits(), false); }
+
+        std::vector<size_type> filter_any_indices(const value_type& m) const { return indices(filter_any(m)); }
+        std::vector<size_type> filter_all_indices(const value_type& m) const { return indices(filter_all(m)); }
+        std::vector<size_type> filter_none_indices(const value_type& m) const { return indices(filter_none(m)); }
+        std::vector<size_type> filter_equal_indices(const value_type& m) const { return indices(filter_equal(m)); }
+
+    private:
+        // Selects the elements for which `((x & and_mask) == value) != negate`
+        std::vector<std::uint64_t> filter(underlying_type and_mask, underlying_type value, bool negate) const
+        {
+            std::vector<std::uint64_t> bitmap(simd::bitmap_words(size()));
+            simd::match(m_bits.data(), size(), and_mask, value, negate, bitmap.data());
+            return bitmap;
+        }
+
+        static std::vector<size_type> indices(const std::vector<std::uint64_t>& bitmap)
+        {
+            std::vector<size_type> result;
+            result.reserve(simd::popcount_words(bitmap.data(), bitmap.size()));
+            simd::append_bitmap_indices(bitmap.data(), bitmap.size(), result);
+            return result;
+        }
+
+        std::vector<underlying_type, bitmask_detail::aligned_allocator<underlying_type, alignment>> m_bits;
+    };
+
+    template<class T>
+    constexpr std::size_t bitmask_vector<T>::alignment;
+}
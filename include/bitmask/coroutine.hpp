@@ -0,0 +1,199 @@
+#pragma once
+
+/*
+    Awaitable bitmask
+    =================
+
+    `awaitable_bitmask<T>` is an atomic flag word that C++20 coroutines can `co_await` until any or all flags of
+    a `bitmask<T>` are set, without blocking a thread.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+
+#include <atomic>
+#include <utility>
+
+#if !defined(__cpp_impl_coroutine)
+#error "bitmask/coroutine.hpp requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+
+
+namespace bitmask {
+
+    // Resumes the awaiting coroutines right in the thread that sets the flags
+    struct inline_executor
+    {
+        void execute(std::coroutine_handle<> h) const { h.resume(); }
+    };
+
+    // Suspended coroutines are kept in a lock-free intrusive list of the nodes that live in their frames. `set()` that
+    // adds new flags takes the whole list, resumes the satisfied waiters on the executor and puts the rest back.
+    // With no waiters `set()` is a single atomic OR.
+    //
+    // `Executor` must have `execute(std::coroutine_handle<>)`. The waiters are resumed after the list is released,
+    // so they may `co_await` the same bitmask again. A suspended waiter must not be destroyed.
+    template<class T, class Executor = inline_executor>
+    class awaitable_bitmask
+    {
+    public:
+        using value_type = bitmask<T>;
+        using executor_type = Executor;
+
+        class awaiter;
+
+        awaitable_bitmask() = default;
+
+        explicit awaitable_bitmask(const value_type& initial, Executor executor = Executor())
+            : m_flags(initial)
+            , m_executor(std::move(executor))
+        {}
+
+        explicit awaitable_bitmask(Executor executor)
+            : m_executor(std::move(executor))
+        {}
+
+        awaitable_bitmask(const awaitable_bitmask&) = delete;
+        awaitable_bitmask& operator = (const awaitable_bitmask&) = delete;
+
+        value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept { return m_flags.load(order); }
+
+        // Sets the flags of `m`, resumes the waiters it satisfies and returns the previous value
+        value_type set(const value_type& m)
+        {
+            const value_type prev = m_flags.fetch_or(m);
+            if ((prev | m) != prev && m_head.load() != nullptr)
+                resume_satisfied();
+            return prev;
+        }
+
+        // Clears the flags of `m` and returns the previous value
+        value_type clear(const value_type& m) noexcept
+        {
+            return m_flags.fetch_and(~m);
+        }
+
+        // `co_await flags.any(m)` resumes once any of the flags of `m` is set and returns the value that satisfied it
+        awaiter any(const value_type& m) noexcept { return awaiter(*this, m, false); }
+
+        // `co_await flags.all(m)` resumes once all the flags of `m` are set
+        awaiter all(const value_type& m) noexcept { return awaiter(*this, m, true); }
+
+        executor_type& executor() noexcept { return m_executor; }
+
+        class awaiter
+        {
+        public:
+            bool await_ready() noexcept
+            {
+                m_result = m_owner.load();
+                return satisfied(m_result);
+            }
+
+            void await_suspend(std::coroutine_handle<> h)
+            {
+                m_handle = h;
+                // Once pushed the waiter may be resumed and destroyed by a concurrent `set()`, so nothing of it is
+                // touched after the push but these copies
+                awaitable_bitmask& owner = m_owner;
+                const value_type mask = m_mask;
+                const bool all = m_all;
+                owner.push(this, this);
+                // Checking after the registration: either `set()` sees the waiter or the waiter sees the flags
+                const value_type v = owner.load();
+                if (all ? v.contains_all(mask) : v.contains_any(mask))
+                    owner.resume_satisfied();
+            }
+
+            value_type await_resume() const noexcept { return m_result; }
+
+        private:
+            friend class awaitable_bitmask;
+
+            awaiter(awaitable_bitmask& owner, const value_type& m, bool all) noexcept
+                : m_owner(owner)
+                , m_mask(m)
+                , m_all(all)
+            {}
+
+            bool satisfied(const value_type& v) const noexcept
+            {
+                return m_all ? v.contains_all(m_mask) : v.contains_any(m_mask);
+            }
+
+            awaitable_bitmask& m_owner;
+            value_type m_mask;
+            bool m_all;
+            value_type m_result;
+            std::coroutine_handle<> m_handle;
+            awaiter* m_next = nullptr;
+        };
+
+    private:
+        // Pushes the chain of waiters `first`...`last`
+        void push(awaiter* first, awaiter* last) noexcept
+        {
+            awaiter* head = m_head.load(std::memory_order_relaxed);
+            do
+            {
+                last->m_next = head;
+            }
+            while (!m_head.compare_exchange_weak(head, first));
+        }
+
+        void resume_satisfied()
+        {
+            awaiter* ready = nullptr;
+            awaiter* list = m_head.exchange(nullptr);
+            while (list)
+            {
+                const value_type v = m_flags.load();
+                awaiter* keep = nullptr;
+                awaiter* keep_last = nullptr;
+                while (list)
+                {
+                    awaiter* w = list;
+                    list = w->m_next;
+                    if (w->satisfied(v))
+                    {
+                        w->m_result = v;
+                        w->m_next = ready;
+                        ready = w;
+                    }
+                    else
+                    {
+                        if (!keep)
+                            keep_last = w;
+                        w->m_next = keep;
+                        keep = w;
+                    }
+                }
+                if (keep)
+                    push(keep, keep_last);
+
+                // A concurrent `set()` might have seen the list empty while it was taken
+                if (m_flags.load() == v)
+                    break;
+                list = m_head.exchange(nullptr);
+            }
+
+            while (ready)
+            {
+                awaiter* w = ready;
+                ready = w->m_next;
+                m_executor.execute(w->m_handle);  // `w` is gone after that
+            }
+        }
+
+        atomic_bitmask<T> m_flags;
+        std::atomic<awaiter*> m_head{nullptr};
+        Executor m_executor;
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+/*
+    Flag counters
+    =============
+
+    `flag_counters<T>` counts how often each flag of `bitmask<T>` shows up, from many threads at once.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "algorithm.hpp"
+#include "atomic.hpp"
+#include "bitmask.hpp"
+#include "bitmask_vector.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace bitmask {
+
+    // Every thread counts into its own shard of the counters that starts at a cache line of its own, so the cores
+    // don't bounce the lines between each other. Reads sum all the shards up. When there are more threads than
+    // shards, they share the shards round robin, that's why the counters are still atomic.
+    template<class T>
+    class flag_counters
+    {
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+    public:
+        using value_type = bitmask<T>;
+        using counts_type = std::array<std::uint64_t, flag_count<T>::value>;
+
+        static constexpr std::size_t alignment = 64;
+
+        // One shard per hardware thread by default
+        explicit flag_counters(std::size_t shards = 0)
+            : m_shards(shards ? shards : default_shard_count())
+            , m_counters(m_shards * stride)
+        {}
+
+        std::size_t shard_count() const noexcept { return m_shards; }
+
+        // Adds `n` to the counter of every flag of `m`
+        void add(const value_type& m, std::uint64_t n = 1) noexcept
+        {
+            std::atomic<std::uint64_t>* shard = &m_counters[bitmask_detail::thread_ordinal() % m_shards * stride];
+            for (underlying_type bits = m.bits(); bits; bits = static_cast<underlying_type>(bits & (bits - 1u)))
+                shard[index_of_lowest(bits)].fetch_add(n, std::memory_order_relaxed);
+        }
+
+        std::uint64_t count(T flag) const noexcept
+        {
+            const std::size_t i = flag_index(flag);
+            std::uint64_t result = 0;
+            for (std::size_t s = 0; s != m_shards; ++s)
+                result += m_counters[s * stride + i].load(std::memory_order_relaxed);
+            return result;
+        }
+
+        // Counts of all the flags indexed by `flag_index()`
+        counts_type counts() const noexcept
+        {
+            counts_type result = {};
+            for (std::size_t s = 0; s != m_shards; ++s)
+            {
+                for (std::size_t i = 0; i != result.size(); ++i)
+                    result[i] += m_counters[s * stride + i].load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        // Not atomic with respect to the concurrent `add()`s
+        void reset() noexcept
+        {
+            for (auto& c: m_counters)
+                c.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        using underlying_type = typename value_type::underlying_type;
+
+        // Counters of a shard rounded up to whole cache lines
+        static constexpr std::size_t stride = (flag_count<T>::value * sizeof(std::uint64_t) + alignment - 1)
+            / alignment * alignment / sizeof(std::uint64_t);
+
+        static std::size_t default_shard_count() noexcept
+        {
+            const unsigned n = std::thread::hardware_concurrency();
+            return n ? n : 1;
+        }
+
+        static std::size_t index_of_lowest(underlying_type bits) noexcept
+        {
+            // Contiguous domains (the usual case) map bits to indices directly
+            return (bitmask<T>::mask_value & (bitmask<T>::mask_value + 1u)) == 0
+                ? static_cast<std::size_t>(bitmask_detail::lowest_bit_index(bits))
+                : flag_index(static_cast<T>(bits & (0u - bits)));
+        }
+
+        std::size_t m_shards;
+        std::vector<std::atomic<std::uint64_t>, bitmask_detail::aligned_allocator<std::atomic<std::uint64_t>, alignment>> m_counters;
+    };
+
+    template<class T>
+    constexpr std::size_t flag_counters<T>::alignment;
+
+    template<class T>
+    constexpr std::size_t flag_counters<T>::stride;
+}
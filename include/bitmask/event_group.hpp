@@ -0,0 +1,333 @@
+#pragma once
+
+/*
+    Bitmask event group
+    ===================
+
+    `event_group<T>` is a set of flags that threads can block on until any or all of a `bitmask<T>` get set,
+    like the event groups of real-time operating systems.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#endif
+
+
+namespace bitmask {
+
+    namespace bitmask_detail {
+        // Spinning is pointless when the thread that is waited for can't run at the same time
+        inline bool is_multiprocessor() noexcept
+        {
+            static const bool value = std::thread::hardware_concurrency() > 1;
+            return value;
+        }
+
+        // One-shot wake up signal for a single thread. Uses futex on Linux and a mutex with a condition variable
+        // elsewhere.
+        class parker
+        {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            bool is_notified() const noexcept { return m_notified.load(std::memory_order_acquire) != 0; }
+
+            // Blocks until `notify()` is called or `deadline` (if not null) passes. Returns false on timeout.
+            bool wait(const clock::time_point* deadline) noexcept
+            {
+#if defined(__linux__)
+                while (!is_notified())
+                {
+                    timespec ts;
+                    if (deadline)
+                    {
+                        // `steady_clock` is `CLOCK_MONOTONIC` that `FUTEX_WAIT_BITSET` takes as an absolute timeout
+                        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline->time_since_epoch()).count();
+                        ts.tv_sec = static_cast<std::time_t>(ns / 1000000000);
+                        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+                    }
+                    const long r = syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_notified),
+                                           FUTEX_WAIT_BITSET_PRIVATE, 0, deadline ? &ts : nullptr, nullptr, FUTEX_BITSET_MATCH_ANY);
+                    if (r != 0 && errno == ETIMEDOUT)
+                        return is_notified();
+                }
+                return true;
+#else
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!deadline)
+                {
+                    m_cv.wait(lock, [this] { return is_notified(); });
+                    return true;
+                }
+                return m_cv.wait_until(lock, *deadline, [this] { return is_notified(); });
+#endif
+            }
+
+            void notify() noexcept
+            {
+#if defined(__linux__)
+                m_notified.store(1, std::memory_order_release);
+                // The waiter may return and destroy the parker right after the store. Waking a futex by a stale
+                // address is harmless: at most it makes a spurious wake up that all futex waiters tolerate.
+                syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_notified), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_notified.store(1, std::memory_order_release);
+                m_cv.notify_one();
+#endif
+            }
+
+            void reset() noexcept { m_notified.store(0, std::memory_order_relaxed); }
+
+        private:
+            static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "Futex word must be 32 bits");
+
+            std::atomic<std::uint32_t> m_notified{0};
+#if !defined(__linux__)
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+#endif
+        };
+    }
+
+    // Setting flags wakes only the waiters whose condition became true: every blocked waiter parks on its own futex
+    // and registers its mask in a list that `set()` goes through. When there are no waiters `set()` is a single
+    // atomic OR. Waiters spin for a while before blocking, since the flag they wait for is often just about to be set.
+    template<class T>
+    class event_group
+    {
+    public:
+        using value_type = bitmask<T>;
+        using clock = std::chrono::steady_clock;
+
+        // Number of the checks the waiters do before blocking
+        static constexpr unsigned spin_count = 64;
+
+        event_group() = default;
+
+        explicit event_group(const value_type& initial): m_flags(initial) {}
+
+        event_group(const event_group&) = delete;
+        event_group& operator = (const event_group&) = delete;
+
+        value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept { return m_flags.load(order); }
+
+        // Sets the flags of `m`, wakes the waiters it satisfies and returns the previous value
+        value_type set(const value_type& m) noexcept
+        {
+            const value_type prev = m_flags.fetch_or(m);
+            if (m_waiters.load() != 0 && (prev | m) != prev)
+                wake_satisfied();
+            return prev;
+        }
+
+        // Clears the flags of `m` and returns the previous value
+        value_type clear(const value_type& m) noexcept
+        {
+            return m_flags.fetch_and(~m);
+        }
+
+        // Blocks until any of the flags of `m` is set. Returns the value that satisfied the condition.
+        // If `clear_on_wake` is true the flags of `m` are cleared atomically with the check, so only one of the waiters
+        // for the same flag consumes it.
+        value_type wait_any(const value_type& m, bool clear_on_wake = false) noexcept
+        {
+            return wait(m, false, clear_on_wake, nullptr);
+        }
+
+        // Blocks until all the flags of `m` are set
+        value_type wait_all(const value_type& m, bool clear_on_wake = false) noexcept
+        {
+            return wait(m, true, clear_on_wake, nullptr);
+        }
+
+        // Timed versions return the current value on timeout. Check it to find out if the condition is satisfied.
+
+        template<class Rep, class Period>
+        value_type wait_any_for(const value_type& m, const std::chrono::duration<Rep, Period>& timeout, bool clear_on_wake = false) noexcept
+        {
+            return wait_any_until(m, deadline_after(timeout), clear_on_wake);
+        }
+
+        value_type wait_any_until(const value_type& m, clock::time_point deadline, bool clear_on_wake = false) noexcept
+        {
+            return wait(m, false, clear_on_wake, &deadline);
+        }
+
+        template<class Rep, class Period>
+        value_type wait_all_for(const value_type& m, const std::chrono::duration<Rep, Period>& timeout, bool clear_on_wake = false) noexcept
+        {
+            return wait_all_until(m, deadline_after(timeout), clear_on_wake);
+        }
+
+        value_type wait_all_until(const value_type& m, clock::time_point deadline, bool clear_on_wake = false) noexcept
+        {
+            return wait(m, true, clear_on_wake, &deadline);
+        }
+
+    private:
+        struct waiter
+        {
+            value_type mask;
+            bool all;
+            bool linked;
+            waiter* prev;
+            waiter* next;
+            bitmask_detail::parker parker;
+        };
+
+        static bool satisfied(const value_type& v, const value_type& m, bool all) noexcept
+        {
+            return all ? v.contains_all(m) : v.contains_any(m);
+        }
+
+        template<class Rep, class Period>
+        static clock::time_point deadline_after(const std::chrono::duration<Rep, Period>& timeout) noexcept
+        {
+            return clock::now() + std::chrono::duration_cast<clock::duration>(timeout);
+        }
+
+        // Checks the condition and clears the flags if asked, all in one atomic step
+        bool try_consume(const value_type& m, bool all, bool clear_on_wake, value_type& result) noexcept
+        {
+            value_type v = m_flags.load();
+            while (satisfied(v, m, all))
+            {
+                if (!clear_on_wake || m_flags.compare_exchange_weak(v, v & ~m))
+                {
+                    result = v;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        value_type wait(const value_type& m, bool all, bool clear_on_wake, const clock::time_point* deadline) noexcept
+        {
+            value_type result;
+            const unsigned spins = bitmask_detail::is_multiprocessor() ? spin_count : 1;
+            for (unsigned i = 0; i != spins; ++i)
+            {
+                if (try_consume(m, all, clear_on_wake, result))
+                    return result;
+                bitmask_detail::cpu_relax();
+            }
+
+            waiter w;
+            w.mask = m;
+            w.all = all;
+            for (;;)
+            {
+                w.parker.reset();
+                link(w);
+                // Checking after the registration: either `set()` sees the waiter or the waiter sees the flags
+                if (try_consume(m, all, clear_on_wake, result))
+                {
+                    leave(w);
+                    return result;
+                }
+
+                const bool notified = w.parker.wait(deadline);
+                if (!notified)
+                    leave(w);
+                if (try_consume(m, all, clear_on_wake, result))
+                    return result;
+                if (!notified)
+                    return m_flags.load();
+                // Another waiter has consumed the flags first
+            }
+        }
+
+        void link(waiter& w) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            w.linked = true;
+            w.prev = nullptr;
+            w.next = m_head;
+            if (m_head)
+                m_head->prev = &w;
+            m_head = &w;
+            m_waiters.fetch_add(1);
+        }
+
+        void unlink(waiter& w) noexcept
+        {
+            (w.prev ? w.prev->next : m_head) = w.next;
+            if (w.next)
+                w.next->prev = w.prev;
+            w.linked = false;
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Unlinks the waiter that is not woken by `set()`. If `set()` has already taken it out of the list, waits for
+        // the notification so that the waiter outlives it.
+        void leave(waiter& w) noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (w.linked)
+                {
+                    unlink(w);
+                    return;
+                }
+            }
+            w.parker.wait(nullptr);
+        }
+
+        // Satisfied waiters are taken out of the list under the lock and notified after it is released,
+        // so a woken waiter does not block on the lock again right away
+        void wake_satisfied() noexcept
+        {
+            waiter* woken = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const value_type v = m_flags.load();
+                for (waiter* w = m_head; w;)
+                {
+                    waiter* next = w->next;
+                    if (satisfied(v, w->mask, w->all))
+                    {
+                        unlink(*w);
+                        w->next = woken;
+                        woken = w;
+                    }
+                    w = next;
+                }
+            }
+            while (woken)
+            {
+                waiter* next = woken->next;
+                woken->parker.notify();  // The waiter may be gone after that
+                woken = next;
+            }
+        }
+
+        atomic_bitmask<T> m_flags;
+        std::atomic<unsigned> m_waiters{0};
+        std::mutex m_mutex;
+        waiter* m_head = nullptr;
+    };
+
+    template<class T>
+    constexpr unsigned event_group<T>::spin_count;
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+/*
+    Formatting
+    ==========
+
+    `bitmask_formatter<T>` is what a log statement takes instead of a string: it keeps the bits and does
+    nothing until it is written to a stream or through `std::format` or {fmt}. Then it writes the names, hex or
+    binary to a buffer on the stack without allocating.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+#include "names.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#if defined(__has_include)
+#  if __has_include(<version>)
+#    include <version>
+#  endif
+#endif
+
+#if defined(__cpp_lib_format)
+#  include <format>
+#endif
+
+
+namespace bitmask {
+
+    enum class bitmask_format
+    {
+        names,   // "in|out|0x80" as `format_to()` writes it, hex if there are no names for the enum
+        hex,     // "0x83"
+        binary,  // "0b10000011", as many digits as the domain has
+    };
+
+    namespace bitmask_detail {
+        template<class T, bool = has_enum_names<T>::value>
+        struct names_format_size : std::integral_constant<std::size_t, name_table<T>::max_formatted_size> {};
+
+        template<class T>
+        struct names_format_size<T, false> : std::integral_constant<std::size_t, 0> {};
+
+        // Format style of the `n`, `x` and `b` format specs of `std::format` and {fmt}
+        inline constexpr bool is_format_spec(char c) noexcept
+        {
+            return c == 'n' || c == 'x' || c == 'b';
+        }
+
+        inline constexpr bitmask_format format_of_spec(char c) noexcept
+        {
+            return c == 'x' ? bitmask_format::hex : c == 'b' ? bitmask_format::binary : bitmask_format::names;
+        }
+    }
+
+    // Writes a bitmask when asked to and not before. The bits out of the domain, that a bitmask can only get from
+    // an unchecked value, are written in every style after `|!` as a hex number.
+    template<class T>
+    class bitmask_formatter
+    {
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value,
+                      "Bit index bitmasks are not supported by bitmask_formatter");
+
+    public:
+        using value_type = bitmask<T>;
+        using underlying_type = typename value_type::underlying_type;
+
+    private:
+        static constexpr std::size_t digits = std::numeric_limits<underlying_type>::digits;
+        static constexpr std::size_t hex_size = 2 + (digits + 3) / 4;
+        static constexpr std::size_t binary_size = 2 + digits + 2 + hex_size;
+        static constexpr std::size_t names_size = bitmask_detail::names_format_size<T>::value;
+
+    public:
+        // The most characters `write()` writes
+        static constexpr std::size_t max_size = names_size > binary_size ? names_size : binary_size;
+
+        constexpr bitmask_formatter(const value_type& m, bitmask_format format = bitmask_format::names) noexcept
+            : m_bits{m.bits()}, m_format{format} {}
+
+        // Of the raw bits, for example of the value from the wire before it is checked
+        constexpr bitmask_formatter(underlying_type bits, bitmask_format format) noexcept
+            : m_bits{bits}, m_format{format} {}
+
+        constexpr underlying_type bits() const noexcept { return m_bits; }
+        constexpr bitmask_format format() const noexcept { return m_format; }
+
+        // Writes the text to `out` that must have room for `max_size` characters. Returns the end of the text,
+        // which is not null terminated.
+        char* write(char* out) const noexcept
+        {
+            switch (m_format)
+            {
+            case bitmask_format::hex:
+                return write_hex(out);
+            case bitmask_format::binary:
+                return write_binary(out);
+            case bitmask_format::names:
+            default:
+                return write_names(out, bitmask_detail::has_enum_names<T>{});
+            }
+        }
+
+    private:
+        static constexpr underlying_type mask_value = value_type::mask_value;
+
+        constexpr underlying_type in_domain() const noexcept
+        {
+            return static_cast<underlying_type>(m_bits & mask_value);
+        }
+
+        // An empty bitmask is "0x0" rather than nothing, the in-domain part is left out if it is empty otherwise
+        constexpr bool writes_in_domain() const noexcept
+        {
+            return in_domain() || m_bits == in_domain();
+        }
+
+        char* write_names(char* out, std::true_type) const noexcept
+        {
+            return m_bits ? bitmask_detail::format_names_to<T>(out, m_bits) : write_hex(out);
+        }
+
+        char* write_names(char* out, std::false_type) const noexcept
+        {
+            return write_hex(out);
+        }
+
+        char* write_hex(char* out) const noexcept
+        {
+            const bool in = writes_in_domain();
+            if (in)
+                out = bitmask_detail::format_hex(out, in_domain());
+            return bitmask_detail::format_out_of_domain<T>(out, m_bits, !in);
+        }
+
+        char* write_binary(char* out) const noexcept
+        {
+            const bool in = writes_in_domain();
+            if (in)
+            {
+                *out++ = '0';
+                *out++ = 'b';
+                for (int i = mask_value ? bitmask_detail::highest_bit_index(mask_value) : 0; i >= 0; --i)
+                    *out++ = static_cast<char>('0' + ((in_domain() >> i) & 1u));
+            }
+            return bitmask_detail::format_out_of_domain<T>(out, m_bits, !in);
+        }
+
+        underlying_type m_bits;
+        bitmask_format m_format;
+    };
+
+    template<class T>
+    constexpr std::size_t bitmask_formatter<T>::max_size;
+
+    template<class T>
+    inline constexpr bitmask_formatter<T> as_names(const bitmask<T>& m) noexcept
+    {
+        return bitmask_formatter<T>{m, bitmask_format::names};
+    }
+
+    template<class T>
+    inline constexpr bitmask_formatter<T> as_hex(const bitmask<T>& m) noexcept
+    {
+        return bitmask_formatter<T>{m, bitmask_format::hex};
+    }
+
+    template<class T>
+    inline constexpr bitmask_formatter<T> as_binary(const bitmask<T>& m) noexcept
+    {
+        return bitmask_formatter<T>{m, bitmask_format::binary};
+    }
+
+    template<class T>
+    inline std::ostream& operator << (std::ostream& os, const bitmask_formatter<T>& f)
+    {
+        char buffer[bitmask_formatter<T>::max_size];
+        return os.write(buffer, f.write(buffer) - buffer);
+    }
+}
+
+
+#if defined(__cpp_lib_format)
+namespace std {
+    // `{}` and `{:n}` write the names, `{:x}` hex and `{:b}` binary. A `bitmask_formatter` is written in its own
+    // style unless the spec says otherwise.
+    template<class T>
+    struct formatter<bitmask::bitmask_formatter<T>, char>
+    {
+        constexpr format_parse_context::iterator parse(format_parse_context& ctx)
+        {
+            auto it = ctx.begin();
+            if (it != ctx.end() && bitmask::bitmask_detail::is_format_spec(*it))
+            {
+                m_spec = *it++;
+            }
+            if (it != ctx.end() && *it != '}')
+                throw format_error("invalid format spec for a bitmask, expected n, x or b");
+            return it;
+        }
+
+        template<class FormatContext>
+        typename FormatContext::iterator format(const bitmask::bitmask_formatter<T>& f, FormatContext& ctx) const
+        {
+            const bitmask::bitmask_formatter<T> g{f.bits(),
+                m_spec ? bitmask::bitmask_detail::format_of_spec(m_spec) : f.format()};
+            char buffer[bitmask::bitmask_formatter<T>::max_size];
+            return std::copy(static_cast<const char*>(buffer), static_cast<const char*>(g.write(buffer)), ctx.out());
+        }
+
+    private:
+        char m_spec = 0;
+    };
+
+    template<class T>
+    struct formatter<bitmask::bitmask<T>, char> : formatter<bitmask::bitmask_formatter<T>, char>
+    {
+        template<class FormatContext>
+        typename FormatContext::iterator format(const bitmask::bitmask<T>& m, FormatContext& ctx) const
+        {
+            return formatter<bitmask::bitmask_formatter<T>, char>::format(bitmask::bitmask_formatter<T>{m}, ctx);
+        }
+    };
+}
+#endif
+
+
+// {fmt} is supported if it is included before this header
+#if defined(FMT_VERSION)
+namespace fmt {
+    template<class T>
+    struct formatter<bitmask::bitmask_formatter<T>, char>
+    {
+        template<class ParseContext>
+        FMT_CONSTEXPR auto parse(ParseContext& ctx) -> decltype(ctx.begin())
+        {
+            auto it = ctx.begin();
+            if (it != ctx.end() && bitmask::bitmask_detail::is_format_spec(*it))
+            {
+                m_spec = *it++;
+            }
+            if (it != ctx.end() && *it != '}')
+                FMT_THROW(format_error("invalid format spec for a bitmask, expected n, x or b"));
+            return it;
+        }
+
+        template<class FormatContext>
+        auto format(const bitmask::bitmask_formatter<T>& f, FormatContext& ctx) const -> decltype(ctx.out())
+        {
+            const bitmask::bitmask_formatter<T> g{f.bits(),
+                m_spec ? bitmask::bitmask_detail::format_of_spec(m_spec) : f.format()};
+            char buffer[bitmask::bitmask_formatter<T>::max_size];
+            return std::copy(static_cast<const char*>(buffer), static_cast<const char*>(g.write(buffer)), ctx.out());
+        }
+
+    private:
+        char m_spec = 0;
+    };
+
+    template<class T>
+    struct formatter<bitmask::bitmask<T>, char> : formatter<bitmask::bitmask_formatter<T>, char>
+    {
+        template<class FormatContext>
+        auto format(const bitmask::bitmask<T>& m, FormatContext& ctx) const -> decltype(ctx.out())
+        {
+            return formatter<bitmask::bitmask_formatter<T>, char>::format(bitmask::bitmask_formatter<T>{m}, ctx);
+        }
+    };
+}
+#endif
@@ -0,0 +1,289 @@
+#pragma once
+
+/*
+    Hierarchical bitmap
+    ===================
+
+    `hierarchical_bitmap` is a bitmap of a huge domain with find-first, find-next and find-last that cost a few
+    bit scans whatever the size of the domain is.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+namespace bitmask {
+
+    namespace bitmask_detail {
+        inline std::uint64_t load_word(const std::uint64_t& w) noexcept { return w; }
+        inline std::uint64_t load_word(const std::atomic<std::uint64_t>& w) noexcept { return w.load(std::memory_order_acquire); }
+
+        inline std::uint64_t fetch_or_word(std::uint64_t& w, std::uint64_t m) noexcept
+        {
+            const std::uint64_t prev = w;
+            w |= m;
+            return prev;
+        }
+
+        inline std::uint64_t fetch_or_word(std::atomic<std::uint64_t>& w, std::uint64_t m) noexcept { return w.fetch_or(m); }
+
+        inline std::uint64_t fetch_and_word(std::uint64_t& w, std::uint64_t m) noexcept
+        {
+            const std::uint64_t prev = w;
+            w &= m;
+            return prev;
+        }
+
+        inline std::uint64_t fetch_and_word(std::atomic<std::uint64_t>& w, std::uint64_t m) noexcept { return w.fetch_and(m); }
+    }
+
+    // Level 0 is the bitmap itself. Bit `i` of level `k + 1` is set if word `i` of level `k` is not empty.
+    // The top level is a single word, so 2^18 bits take 3 levels and 2^24 bits take 4 levels.
+    // A search goes up from the word of the start position until it finds a non-empty word and then down,
+    // which is one bit scan per level each way.
+    //
+    // With `Word` being `std::atomic<std::uint64_t>`, `set`, `clear`, `test` and the searches may run concurrently.
+    // A search may run into an upper level bit of a word that has just been cleared, in which case it carries on with
+    // the next word. A `clear` that has emptied a word rechecks the word after clearing its upper level bit and
+    // restores the bit if a concurrent `set` has got there in between.
+    //
+    // A bit appears to the searches once `set` has returned, unless a `clear` of another bit that emptied the same
+    // word is still running: the searches may skip the word until that `clear` has restored its upper level bit.
+    template<class Word>
+    class basic_hierarchical_bitmap
+    {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        explicit basic_hierarchical_bitmap(std::size_t size)
+            : m_size(size)
+        {
+            std::size_t words = 0;
+            std::size_t bits = size;
+            do
+            {
+                m_offsets.push_back(words);
+                m_word_counts.push_back(bits ? (bits + 63) / 64 : 1);
+                words += m_word_counts.back();
+                bits = m_word_counts.back();
+            }
+            while (bits > 1);
+            m_words = std::vector<Word>(words);
+        }
+
+        basic_hierarchical_bitmap(const basic_hierarchical_bitmap&) = delete;
+        basic_hierarchical_bitmap& operator = (const basic_hierarchical_bitmap&) = delete;
+
+        std::size_t size() const noexcept { return m_size; }
+
+        std::size_t levels() const noexcept { return m_offsets.size(); }
+
+        bool empty() const noexcept { return !bitmask_detail::load_word(top()); }
+
+        bool test(std::size_t i) const noexcept
+        {
+            assert(i < m_size);
+            return (bitmask_detail::load_word(m_words[i / 64]) >> (i % 64)) & 1;
+        }
+
+        void set(std::size_t i) noexcept
+        {
+            assert(i < m_size);
+            set_from(0, i);
+        }
+
+        void clear(std::size_t i) noexcept
+        {
+            assert(i < m_size);
+            std::size_t w = i / 64;
+            std::uint64_t b = bit(i);
+            for (std::size_t level = 0;; ++level)
+            {
+                const std::uint64_t prev = bitmask_detail::fetch_and_word(word(level, w), ~b);
+                if (!(prev & b))
+                    return;
+                // The bit just cleared is the summary of the word below, which may have got a bit set meanwhile
+                if (level > 0 && bitmask_detail::load_word(word(level - 1, w * 64 + lowest_index(b))))
+                {
+                    set_from(level, w * 64 + lowest_index(b));
+                    return;
+                }
+                if ((prev & ~b) || level + 1 == levels())
+                    return;
+                b = bit(w);
+                w /= 64;
+            }
+        }
+
+        // Index of the lowest set bit or `npos` if there is none
+        std::size_t find_first() const noexcept { return find_next(0); }
+
+        // Index of the lowest set bit that is not less than `pos` or `npos` if there is none
+        std::size_t find_next(std::size_t pos) const noexcept
+        {
+            if (pos >= m_size)
+                return npos;
+
+            std::size_t level = 0;
+            std::size_t idx = pos;  // Bit position at `level`
+            for (;;)
+            {
+                // Up to the first level with a non-empty word at or after the position
+                for (;;)
+                {
+                    const std::size_t w = idx / 64;
+                    if (w >= m_word_counts[level])
+                        return npos;
+                    const std::uint64_t bits = bitmask_detail::load_word(word(level, w)) & (~std::uint64_t{0} << (idx % 64));
+                    if (bits)
+                    {
+                        idx = w * 64 + lowest_index(bits);
+                        break;
+                    }
+                    if (level + 1 == levels())
+                        return npos;
+                    idx = w + 1;
+                    ++level;
+                }
+
+                // And down along the lowest set bits
+                bool found = true;
+                while (level > 0)
+                {
+                    --level;
+                    const std::uint64_t bits = bitmask_detail::load_word(word(level, idx));
+                    if (!bits)
+                    {
+                        idx = (idx + 1) * 64;  // Cleared concurrently, carry on with the next word
+                        found = false;
+                        break;
+                    }
+                    idx = idx * 64 + lowest_index(bits);
+                }
+                if (found)
+                    return idx;
+            }
+        }
+
+        // Index of the highest set bit or `npos` if there is none
+        std::size_t find_last() const noexcept { return m_size ? find_prev(m_size - 1) : npos; }
+
+        // Index of the highest set bit that is not greater than `pos` or `npos` if there is none
+        std::size_t find_prev(std::size_t pos) const noexcept
+        {
+            if (!m_size)
+                return npos;
+            if (pos >= m_size)
+                pos = m_size - 1;
+
+            std::size_t level = 0;
+            std::size_t idx = pos;  // Bit position at `level`
+            for (;;)
+            {
+                // Up to the first level with a non-empty word at or before the position
+                for (;;)
+                {
+                    const std::size_t w = idx / 64;
+                    const std::uint64_t bits = bitmask_detail::load_word(word(level, w)) & (~std::uint64_t{0} >> (63 - idx % 64));
+                    if (bits)
+                    {
+                        idx = w * 64 + highest_index(bits);
+                        break;
+                    }
+                    if (w == 0 || level + 1 == levels())
+                        return npos;
+                    idx = w - 1;
+                    ++level;
+                }
+
+                // And down along the highest set bits
+                bool found = true;
+                while (level > 0)
+                {
+                    --level;
+                    const std::uint64_t bits = bitmask_detail::load_word(word(level, idx));
+                    if (!bits)
+                    {
+                        if (idx == 0)
+                            return npos;
+                        idx = idx * 64 - 1;
+                        found = false;
+                        break;
+                    }
+                    idx = idx * 64 + highest_index(bits);
+                }
+                if (found)
+                    return idx;
+            }
+        }
+
+    private:
+        static std::uint64_t bit(std::size_t i) noexcept { return std::uint64_t{1} << (i % 64); }
+
+        static std::size_t lowest_index(std::uint64_t bits) noexcept
+        {
+            return static_cast<std::size_t>(bitmask_detail::lowest_bit_index(bits));
+        }
+
+        static std::size_t highest_index(std::uint64_t bits) noexcept
+        {
+            return static_cast<std::size_t>(bitmask_detail::highest_bit_index(bits));
+        }
+
+        Word& word(std::size_t level, std::size_t w) noexcept { return m_words[m_offsets[level] + w]; }
+        const Word& word(std::size_t level, std::size_t w) const noexcept { return m_words[m_offsets[level] + w]; }
+        const Word& top() const noexcept { return m_words.back(); }
+
+        // Sets bit `i` of `level` and the upper level bits of the words that were empty
+        void set_from(std::size_t level, std::size_t i) noexcept
+        {
+            set_from(level, i, std::is_same<Word, std::uint64_t>{});
+        }
+
+        void set_from(std::size_t level, std::size_t i, std::true_type) noexcept
+        {
+            for (; level != levels(); ++level)
+            {
+                if (bitmask_detail::fetch_or_word(word(level, i / 64), bit(i)))
+                    return;
+                i /= 64;
+            }
+        }
+
+        // A word that was not empty may have been set by a concurrent `set` that has not got to the upper levels
+        // yet, so the concurrent bitmap goes up to the top level. The upper level bits that are set are only read.
+        void set_from(std::size_t level, std::size_t i, std::false_type) noexcept
+        {
+            bitmask_detail::fetch_or_word(word(level, i / 64), bit(i));
+            while (++level != levels())
+            {
+                i /= 64;
+                Word& w = word(level, i / 64);
+                if (!(bitmask_detail::load_word(w) & bit(i)))
+                    bitmask_detail::fetch_or_word(w, bit(i));
+            }
+        }
+
+        std::size_t m_size;
+        std::vector<std::size_t> m_offsets;      // Of the first word of every level
+        std::vector<std::size_t> m_word_counts;  // Of every level
+        std::vector<Word> m_words;
+    };
+
+    template<class Word>
+    constexpr std::size_t basic_hierarchical_bitmap<Word>::npos;
+
+    using hierarchical_bitmap = basic_hierarchical_bitmap<std::uint64_t>;
+    using concurrent_hierarchical_bitmap = basic_hierarchical_bitmap<std::atomic<std::uint64_t>>;
+}
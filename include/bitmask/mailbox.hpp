@@ -0,0 +1,124 @@
+#pragma once
+
+/*
+    Flag mailbox
+    ============
+
+    `flag_mailbox<T>` coalesces signals that many threads post to one consumer into a single `bitmask<T>` word.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+#include "event_group.hpp"
+
+#include <atomic>
+#include <chrono>
+
+
+namespace bitmask {
+
+    // Producers `post()` flags with one atomic OR. Only the post that makes the mailbox non-empty may wake
+    // the consumer, and only if it is blocked, so there is at most one wake up per drain. The consumer takes all
+    // the pending flags with one atomic exchange. Posting a flag that is already pending is coalesced with it.
+    //
+    // There must be a single consumer at a time.
+    template<class T>
+    class flag_mailbox
+    {
+    public:
+        using value_type = bitmask<T>;
+        using clock = std::chrono::steady_clock;
+
+        // Number of the checks the consumer does before blocking
+        static constexpr unsigned spin_count = 64;
+
+        flag_mailbox() = default;
+
+        flag_mailbox(const flag_mailbox&) = delete;
+        flag_mailbox& operator = (const flag_mailbox&) = delete;
+
+        // Posts the flags of `m` and returns the flags that were pending before
+        value_type post(const value_type& m) noexcept
+        {
+            const value_type prev = m_flags.fetch_or(m);
+            if (!prev && m && m_consumer_blocked.load())
+            {
+                m_consumer_blocked.store(false, std::memory_order_relaxed);
+                m_parker.notify();
+            }
+            return prev;
+        }
+
+        // Returns the pending flags without taking them
+        value_type pending(std::memory_order order = std::memory_order_seq_cst) const noexcept { return m_flags.load(order); }
+
+        // Takes all the pending flags. Returns an empty bitmask if there are none.
+        value_type try_drain() noexcept
+        {
+            return m_flags.load(std::memory_order_relaxed) ? m_flags.exchange(nullptr, std::memory_order_acquire) : value_type();
+        }
+
+        // Blocks until there are pending flags and takes all of them
+        value_type drain() noexcept
+        {
+            return drain(nullptr);
+        }
+
+        // Timed versions return an empty bitmask on timeout
+
+        template<class Rep, class Period>
+        value_type drain_for(const std::chrono::duration<Rep, Period>& timeout) noexcept
+        {
+            return drain_until(clock::now() + std::chrono::duration_cast<clock::duration>(timeout));
+        }
+
+        value_type drain_until(clock::time_point deadline) noexcept
+        {
+            return drain(&deadline);
+        }
+
+    private:
+        value_type drain(const clock::time_point* deadline) noexcept
+        {
+            const unsigned spins = bitmask_detail::is_multiprocessor() ? spin_count : 1;
+            for (unsigned i = 0; i != spins; ++i)
+            {
+                if (const value_type v = try_drain())
+                    return v;
+                bitmask_detail::cpu_relax();
+            }
+
+            for (;;)
+            {
+                m_parker.reset();
+                m_consumer_blocked.store(true);
+                // Checking after announcing: either `post()` sees the consumer blocked or the consumer sees the flags
+                if (const value_type v = m_flags.exchange(nullptr))
+                {
+                    m_consumer_blocked.store(false, std::memory_order_relaxed);
+                    return v;
+                }
+                const bool notified = m_parker.wait(deadline);
+                if (const value_type v = m_flags.exchange(nullptr, std::memory_order_acquire))
+                    return v;
+                if (!notified)
+                {
+                    m_consumer_blocked.store(false, std::memory_order_relaxed);
+                    return value_type();
+                }
+            }
+        }
+
+        atomic_bitmask<T> m_flags;
+        std::atomic<bool> m_consumer_blocked{false};
+        bitmask_detail::parker m_parker;
+    };
+
+    template<class T>
+    constexpr unsigned flag_mailbox<T>::spin_count;
+}
@@ -0,0 +1,723 @@
+#pragma once
+
+/*
+    Enumerator names
+    ================
+
+    `BITMASK_DEFINE_NAMES` registers the names of the flags of a bitmask enum. With them `parse()` reads
+    "in|out|binary" through a perfect hash table built at compile time and `format_to()` writes a bitmask
+    as names without allocating.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+
+namespace bitmask {
+
+    // Flag and its name as registered by `BITMASK_DEFINE_NAMES`
+    template<class T>
+    struct enum_name
+    {
+        T value;
+        const char* name;
+        std::size_t size;
+    };
+
+    // Names registered for `T` in the order they were listed
+    template<class T, std::size_t N>
+    struct enum_names
+    {
+        static constexpr std::size_t count = N;
+
+        enum_name<T> entries[N];
+    };
+
+    template<class T, std::size_t N>
+    constexpr std::size_t enum_names<T, N>::count;
+
+    namespace bitmask_detail {
+        // Returned by default `get_enum_names` to tell that no names are registered
+        struct no_names {};
+    }
+
+    template<class T>
+    inline constexpr bitmask_detail::no_names get_enum_names(const T&) noexcept
+    {
+        return {};
+    }
+
+    namespace bitmask_detail {
+        template<class T>
+        struct has_enum_names : std::integral_constant<bool,
+            !std::is_same<decltype(get_enum_names(std::declval<T>())), no_names>::value> {};
+
+        // The names are hashed 8 characters at a time with a multiply and a shift and then the hash is mixed down
+        // to a slot index. `seed` picks a member of the hash function family, the table keeps the first one
+        // that has no collisions.
+        inline constexpr std::uint64_t name_hash_basis(std::uint64_t seed) noexcept
+        {
+            return 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+        }
+
+        inline constexpr std::uint64_t name_hash_step(std::uint64_t h, std::uint64_t chunk) noexcept
+        {
+            return ((h ^ chunk) * 0x9e3779b97f4a7c15ull) ^ (((h ^ chunk) * 0x9e3779b97f4a7c15ull) >> 29);
+        }
+
+        // Up to 8 characters as a little endian number
+        inline constexpr std::uint64_t name_chunk(const char* s, std::size_t n) noexcept
+        {
+            return n ? static_cast<unsigned char>(*s) | (name_chunk(s + 1, n - 1) << 8) : 0;
+        }
+
+        // `size` is the length of the whole name, that is mixed into the hash after the last chunk
+        inline constexpr std::uint64_t name_hash_chunks(const char* s, std::size_t n, std::uint64_t h, std::size_t size) noexcept
+        {
+            return n > 8 ? name_hash_chunks(s + 8, n - 8, name_hash_step(h, name_chunk(s, 8)), size)
+                : name_hash_step(h, name_chunk(s, n)) ^ size;
+        }
+
+        inline constexpr std::uint64_t name_hash(const char* s, std::size_t n, std::uint64_t h) noexcept
+        {
+            return name_hash_chunks(s, n, h, n);
+        }
+
+        inline constexpr std::size_t name_slot(std::uint64_t h, unsigned bits) noexcept
+        {
+            return static_cast<std::size_t>((h * 0xbf58476d1ce4e5b9ull) >> (64 - bits));
+        }
+
+        inline std::uint64_t name_chunk_at_run_time(const char* s, std::size_t n) noexcept
+        {
+            std::uint64_t chunk = 0;
+            for (std::size_t i = n; i != 0; --i)
+                chunk = (chunk << 8) | static_cast<unsigned char>(s[i - 1]);
+            return chunk;
+        }
+
+        // Same as `name_slot(name_hash(...))` in a loop rather than in a recursion
+        inline std::size_t name_slot_at_run_time(const char* s, std::size_t n, std::uint64_t seed, unsigned bits) noexcept
+        {
+            std::uint64_t h = name_hash_basis(seed);
+            std::size_t rest = n;
+            for (; rest > 8; rest -= 8, s += 8)
+                h = name_hash_step(h, name_chunk_at_run_time(s, 8));
+            return name_slot(name_hash_step(h, name_chunk_at_run_time(s, rest)) ^ n, bits);
+        }
+
+        // Slots are 8 times the names rounded up to a power of two, but 512 at most, which gives a collision
+        // free seed in a few dozens of tries even for 64 names
+        inline constexpr unsigned name_slot_bits(std::size_t count, unsigned bits = 3) noexcept
+        {
+            return bits == 9 || (std::size_t{1} << bits) >= count * 8 ? bits : name_slot_bits(count, bits + 1);
+        }
+
+        // The recursions over the names below split the ranges in halves where they can to stay shallow
+
+        template<class Names>
+        inline constexpr std::size_t entry_slot(const Names& names, std::size_t i, std::uint64_t seed, unsigned bits) noexcept
+        {
+            return name_slot(name_hash(names.entries[i].name, names.entries[i].size, name_hash_basis(seed)), bits);
+        }
+
+        // Array that can be indexed in constant expressions, which `std::array` can't in C++11
+        template<class V, std::size_t N>
+        struct constant_array
+        {
+            V values[N];
+        };
+
+        // Set of the slots taken so far, as large as the largest table
+        struct slot_set
+        {
+            std::uint64_t words[8];
+        };
+
+        inline constexpr bool contains(const slot_set& s, std::size_t slot) noexcept
+        {
+            return ((s.words[slot / 64] >> (slot % 64)) & 1) != 0;
+        }
+
+        template<std::size_t... I>
+        inline constexpr slot_set with_slot(const slot_set& s, std::size_t slot, index_sequence<I...>) noexcept
+        {
+            return slot_set{{(I == slot / 64 ? s.words[I] | std::uint64_t{1} << (slot % 64) : s.words[I])...}};
+        }
+
+        template<class Names>
+        inline constexpr bool slots_are_distinct(const Names& names, std::size_t i, const slot_set& taken,
+                                                 std::uint64_t seed, unsigned bits) noexcept;
+
+        template<class Names>
+        inline constexpr bool slot_is_free(const Names& names, std::size_t i, std::size_t slot, const slot_set& taken,
+                                           std::uint64_t seed, unsigned bits) noexcept
+        {
+            return !contains(taken, slot)
+                && slots_are_distinct(names, i + 1, with_slot(taken, slot, make_index_sequence<8>{}), seed, bits);
+        }
+
+        // Every name from `i` on takes a slot of its own
+        template<class Names>
+        inline constexpr bool slots_are_distinct(const Names& names, std::size_t i, const slot_set& taken,
+                                                 std::uint64_t seed, unsigned bits) noexcept
+        {
+            return i == Names::count || slot_is_free(names, i, entry_slot(names, i, seed, bits), taken, seed, bits);
+        }
+
+        constexpr std::uint64_t no_seed = ~std::uint64_t{0};
+
+        template<class Names>
+        inline constexpr std::uint64_t find_name_seed(const Names& names, std::uint64_t first, std::uint64_t last, unsigned bits) noexcept;
+
+        template<class Names>
+        inline constexpr std::uint64_t name_seed_or_find(std::uint64_t seed, const Names& names, std::uint64_t first, std::uint64_t last,
+                                                         unsigned bits) noexcept
+        {
+            return seed != no_seed ? seed : find_name_seed(names, first, last, bits);
+        }
+
+        // The lowest seed of [first, last) that gives every name a slot of its own or `no_seed` if there is none
+        template<class Names>
+        inline constexpr std::uint64_t find_name_seed(const Names& names, std::uint64_t first, std::uint64_t last, unsigned bits) noexcept
+        {
+            return last - first == 1 ? (slots_are_distinct(names, 0, slot_set{{}}, first, bits) ? first : no_seed)
+                : name_seed_or_find(find_name_seed(names, first, (first + last) / 2, bits), names, (first + last) / 2, last, bits);
+        }
+
+        // Index + 1 of the name of [first, last) that takes `slot` or 0 if there is none
+        template<std::size_t N>
+        inline constexpr std::uint8_t name_in_slot(const constant_array<std::size_t, N>& entry_slots, std::size_t slot,
+                                                   std::size_t first, std::size_t last) noexcept
+        {
+            return last - first == 1 ? static_cast<std::uint8_t>(entry_slots.values[first] == slot ? first + 1 : 0)
+                : static_cast<std::uint8_t>(name_in_slot(entry_slots, slot, first, (first + last) / 2)
+                    + name_in_slot(entry_slots, slot, (first + last) / 2, last));
+        }
+
+        // Index + 1 of the name of [first, last) of the flag `bit` or 0 if there is none
+        template<class U, class Names>
+        inline constexpr std::uint8_t name_of_bit(const Names& names, U bit, std::size_t first, std::size_t last) noexcept
+        {
+            return last - first == 1 ? static_cast<std::uint8_t>(static_cast<U>(names.entries[first].value) == bit ? first + 1 : 0)
+                : static_cast<std::uint8_t>(name_of_bit(names, bit, first, (first + last) / 2)
+                    + name_of_bit(names, bit, (first + last) / 2, last));
+        }
+
+        template<class U, class Names>
+        inline constexpr U or_of_names(const Names& names, std::size_t first, std::size_t last) noexcept
+        {
+            return last - first == 1 ? static_cast<U>(names.entries[first].value)
+                : static_cast<U>(or_of_names<U>(names, first, (first + last) / 2) | or_of_names<U>(names, (first + last) / 2, last));
+        }
+
+        template<class U, class Names>
+        inline constexpr bool names_are_single_flags(const Names& names, std::size_t first, std::size_t last) noexcept
+        {
+            return last - first == 1 ? popcount(static_cast<U>(names.entries[first].value)) == 1
+                : names_are_single_flags<U>(names, first, (first + last) / 2) && names_are_single_flags<U>(names, (first + last) / 2, last);
+        }
+
+        template<class Names>
+        inline constexpr std::size_t sum_of_name_sizes(const Names& names, std::size_t first, std::size_t last) noexcept
+        {
+            return last - first == 1 ? names.entries[first].size
+                : sum_of_name_sizes(names, first, (first + last) / 2) + sum_of_name_sizes(names, (first + last) / 2, last);
+        }
+
+        template<class Names>
+        inline constexpr std::size_t max_name_size(const Names& names, std::size_t first, std::size_t last) noexcept
+        {
+            return last - first == 1 ? names.entries[first].size
+                : max_name_size(names, first, (first + last) / 2) > max_name_size(names, (first + last) / 2, last)
+                    ? max_name_size(names, first, (first + last) / 2) : max_name_size(names, (first + last) / 2, last);
+        }
+
+        template<class Names, std::size_t... I>
+        inline constexpr constant_array<std::size_t, sizeof...(I)> make_entry_slots(const Names& names, std::uint64_t seed, unsigned bits,
+                                                                                  index_sequence<I...>) noexcept
+        {
+            return constant_array<std::size_t, sizeof...(I)>{{entry_slot(names, I, seed, bits)...}};
+        }
+
+        template<std::size_t N, std::size_t... I>
+        inline constexpr constant_array<std::uint8_t, sizeof...(I)> make_name_slots(const constant_array<std::size_t, N>& entry_slots,
+                                                                                  index_sequence<I...>) noexcept
+        {
+            return constant_array<std::uint8_t, sizeof...(I)>{{name_in_slot(entry_slots, I, 0, N)...}};
+        }
+
+        template<class U, class Names, std::size_t... I>
+        inline constexpr constant_array<std::uint8_t, sizeof...(I)> make_names_of_bits(const Names& names, index_sequence<I...>) noexcept
+        {
+            return constant_array<std::uint8_t, sizeof...(I)>{{name_of_bit(names, static_cast<U>(U{1} << I), 0, Names::count)...}};
+        }
+
+        // Lookup tables over the names of `T` built at compile time
+        template<class T>
+        struct name_table
+        {
+            static_assert(has_enum_names<T>::value, "Names are not defined, use BITMASK_DEFINE_NAMES");
+            static_assert(!is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+            using underlying_type = underlying_type_t<T>;
+            using names_type = decltype(get_enum_names(std::declval<T>()));
+
+            static constexpr std::size_t digits = std::numeric_limits<underlying_type>::digits;
+
+            static constexpr names_type names = get_enum_names(static_cast<T>(0));
+
+            static_assert(names_are_single_flags<underlying_type>(names, 0, names_type::count)
+                && popcount(or_of_names<underlying_type>(names, 0, names_type::count)) == static_cast<int>(names_type::count)
+                && (or_of_names<underlying_type>(names, 0, names_type::count) & ~bitmask<T>::mask_value) == 0,
+                "Names must be given to distinct single flags of the domain");
+
+            static constexpr unsigned slot_bits = name_slot_bits(names_type::count);
+            static constexpr std::uint64_t seed = find_name_seed(names, 0, 4096, slot_bits);
+
+            static_assert(seed != no_seed, "Failed to find a perfect hash function for the names");
+
+            // Index + 1 of the name in every slot of the hash table, 0 for the empty slots
+            static constexpr constant_array<std::uint8_t, std::size_t{1} << slot_bits> slots = make_name_slots(
+                make_entry_slots(names, seed, slot_bits, make_index_sequence<names_type::count>{}),
+                make_index_sequence<std::size_t{1} << slot_bits>{});
+
+            // Index + 1 of the name of every bit, 0 for the bits that have no name
+            static constexpr constant_array<std::uint8_t, digits> names_of_bits =
+                make_names_of_bits<underlying_type>(names, make_index_sequence<digits>{});
+
+            // All the names separated by `|`, the flags that have no name and the bits out of the domain
+            // as hex numbers
+            static constexpr std::size_t max_formatted_size =
+                sum_of_name_sizes(names, 0, names_type::count) + names_type::count + 2 * (4 + (digits + 3) / 4);
+        };
+
+        template<class T>
+        constexpr std::size_t name_table<T>::digits;
+
+        template<class T>
+        constexpr typename name_table<T>::names_type name_table<T>::names;
+
+        template<class T>
+        constexpr unsigned name_table<T>::slot_bits;
+
+        template<class T>
+        constexpr std::uint64_t name_table<T>::seed;
+
+        template<class T>
+        constexpr constant_array<std::uint8_t, std::size_t{1} << name_table<T>::slot_bits> name_table<T>::slots;
+
+        template<class T>
+        constexpr constant_array<std::uint8_t, name_table<T>::digits> name_table<T>::names_of_bits;
+
+        template<class T>
+        constexpr std::size_t name_table<T>::max_formatted_size;
+
+        // Name with index `i - 1` or `nullptr` if `i` is 0
+        template<class T>
+        inline constexpr const char* name_at(std::size_t i) noexcept
+        {
+            return i ? name_table<T>::names.entries[i - 1].name : nullptr;
+        }
+
+        inline constexpr bool is_blank(char c) noexcept
+        {
+            return c == ' ' || c == '\t';
+        }
+
+        inline constexpr int hex_digit(char c) noexcept
+        {
+            return c >= '0' && c <= '9' ? c - '0'
+                : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                : -1;
+        }
+
+        inline constexpr bool has_hex_prefix(const char* s, std::size_t n) noexcept
+        {
+            return n >= 3 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X');
+        }
+
+        // Reads a hex number such as "0x1f". Fails on anything else and on the numbers that don't fit `U`.
+        template<class U>
+        inline bool parse_hex(const char* s, std::size_t n, U& value) noexcept
+        {
+            if (!has_hex_prefix(s, n))
+                return false;
+            value = 0;
+            for (std::size_t i = 2; i != n; ++i)
+            {
+                const int digit = hex_digit(s[i]);
+                if (digit < 0 || (value >> (std::numeric_limits<U>::digits - 4)) != 0)
+                    return false;
+                value = static_cast<U>((value << 4) | static_cast<U>(digit));
+            }
+            return true;
+        }
+
+        template<class U>
+        inline char* format_hex(char* out, U value) noexcept
+        {
+            static const char digits[] = "0123456789abcdef";
+            *out++ = '0';
+            *out++ = 'x';
+            int shift = value ? highest_bit_index(value) / 4 * 4 : 0;
+            for (; shift >= 0; shift -= 4)
+                *out++ = digits[(value >> shift) & 0xF];
+            return out;
+        }
+
+        // Writes the bits of `bits` out of the domain of `T` as `!0x...`, after a separator unless `first`
+        template<class T>
+        inline char* format_out_of_domain(char* out, underlying_type_t<T> bits, bool first) noexcept
+        {
+            const auto extra = static_cast<underlying_type_t<T>>(bits & ~bitmask<T>::mask_value);
+            if (!extra)
+                return out;
+            if (!first)
+                *out++ = '|';
+            *out++ = '!';
+            return format_hex(out, extra);
+        }
+    }
+
+    // Upper bound of the size of the text `format_to()` writes for a `bitmask<T>`
+    template<class T>
+    struct max_formatted_size : std::integral_constant<std::size_t, bitmask_detail::name_table<T>::max_formatted_size> {};
+
+    // Name of `flag` or `nullptr` if it has none
+    template<class T>
+    inline constexpr const char* name_of(T flag) noexcept
+    {
+        using underlying_type = bitmask_detail::underlying_type_t<T>;
+        return bitmask_constexpr_assert(bitmask_detail::popcount(static_cast<underlying_type>(flag)) == 1),
+            bitmask_detail::name_at<T>(bitmask_detail::name_table<T>::names_of_bits.values[
+                bitmask_detail::lowest_bit_index(static_cast<underlying_type>(flag))]);
+    }
+
+    namespace bitmask_detail {
+        // Entry of the name `s` of `n` characters or `nullptr` if there is no such name
+        template<class T>
+        inline const enum_name<T>* find_name(const char* s, std::size_t n) noexcept
+        {
+            using table = name_table<T>;
+            const std::size_t i = table::slots.values[name_slot_at_run_time(s, n, table::seed, table::slot_bits)];
+            if (!i)
+                return nullptr;
+            const enum_name<T>& e = table::names.entries[i - 1];
+            return e.size == n && std::memcmp(e.name, s, n) == 0 ? &e : nullptr;
+        }
+    }
+
+    // Result of `parse()`. `error` points to the first name that is not known or is `nullptr` if there is none.
+    template<class T>
+    struct parse_result
+    {
+        bitmask<T> value;
+        const char* error;
+
+        constexpr explicit operator bool() const noexcept { return !error; }
+    };
+
+    // Reads the names of the flags of `T` separated by `|`, for example "in|out|binary". Blanks around the names
+    // are skipped and a blank string is an empty bitmask. The flags that have no name may be given as hex numbers
+    // like "0x100". Every name costs a hash, a table lookup and a single string comparison.
+    template<class T>
+    inline parse_result<T> parse(const char* s, std::size_t n) noexcept
+    {
+        using table = bitmask_detail::name_table<T>;
+        using underlying_type = typename table::underlying_type;
+
+        underlying_type bits = 0;
+        const char* const end = s + n;
+        const char* p = s;
+        while (p != end && bitmask_detail::is_blank(*p))
+            ++p;
+        if (p == end)
+            return parse_result<T>{bitmask<T>(), nullptr};
+
+        for (;;)
+        {
+            while (p != end && bitmask_detail::is_blank(*p))
+                ++p;
+            const char* const first = p;
+            p = static_cast<const char*>(std::memchr(p, '|', static_cast<std::size_t>(end - p)));
+            if (!p)
+                p = end;
+            const char* last = p;
+            while (last != first && bitmask_detail::is_blank(last[-1]))
+                --last;
+            const std::size_t size = static_cast<std::size_t>(last - first);
+
+            underlying_type value = 0;
+            if (const enum_name<T>* e = bitmask_detail::find_name<T>(first, size))
+                bits = static_cast<underlying_type>(bits | static_cast<underlying_type>(e->value));
+            else if (bitmask_detail::parse_hex(first, size, value) && (value & ~bitmask<T>::mask_value) == 0)
+                bits = static_cast<underlying_type>(bits | value);
+            else
+                return parse_result<T>{bitmask<T>(), first};
+
+            if (p == end)
+                return parse_result<T>{bitmask_detail::to_enum<T>(bits), nullptr};
+            ++p;
+        }
+    }
+
+    template<class T>
+    inline parse_result<T> parse(const char* s) noexcept
+    {
+        return parse<T>(s, std::strlen(s));
+    }
+
+    namespace bitmask_detail {
+        // The same as `parse()` in recursions that may run at compile time. The errors are reported by
+        // `bitmask_constexpr_assert`, so they fail the compilation.
+
+        inline constexpr std::size_t skip_blanks(const char* s, std::size_t i, std::size_t n) noexcept
+        {
+            return i != n && is_blank(s[i]) ? skip_blanks(s, i + 1, n) : i;
+        }
+
+        inline constexpr std::size_t trim_blanks(const char* s, std::size_t first, std::size_t last) noexcept
+        {
+            return last != first && is_blank(s[last - 1]) ? trim_blanks(s, first, last - 1) : last;
+        }
+
+        inline constexpr std::size_t find_separator(const char* s, std::size_t i, std::size_t n) noexcept
+        {
+            return i == n || s[i] == '|' ? i : find_separator(s, i + 1, n);
+        }
+
+        inline constexpr bool equal_chars(const char* a, const char* b, std::size_t n) noexcept
+        {
+            return n == 0 || (*a == *b && equal_chars(a + 1, b + 1, n - 1));
+        }
+
+        template<class U>
+        inline constexpr bool hex_digits_fit(const char* s, std::size_t n, U value) noexcept
+        {
+            return n == 0 || (hex_digit(*s) >= 0 && (value >> (std::numeric_limits<U>::digits - 4)) == 0
+                && hex_digits_fit<U>(s + 1, n - 1, static_cast<U>((value << 4) | static_cast<U>(hex_digit(*s)))));
+        }
+
+        template<class U>
+        inline constexpr U hex_digits_value(const char* s, std::size_t n, U value) noexcept
+        {
+            return n == 0 ? value : hex_digits_value<U>(s + 1, n - 1, static_cast<U>((value << 4) | static_cast<U>(hex_digit(*s))));
+        }
+
+        // An unknown name is reported from a function named after the error to get the name into the compiler message
+        template<class T>
+        inline constexpr underlying_type_t<T> unknown_flag_name() noexcept
+        {
+            return bitmask_constexpr_assert(false), 0;
+        }
+
+        template<class T>
+        inline constexpr underlying_type_t<T> checked_flag_number(const char* s, std::size_t n) noexcept
+        {
+            return bitmask_constexpr_assert(hex_digits_fit<underlying_type_t<T>>(s + 2, n - 2, 0)
+                    && (hex_digits_value<underlying_type_t<T>>(s + 2, n - 2, 0) & ~bitmask<T>::mask_value) == 0),
+                hex_digits_value<underlying_type_t<T>>(s + 2, n - 2, 0);
+        }
+
+        // `i` is the index + 1 of the name in the slot of `s`
+        template<class T>
+        inline constexpr underlying_type_t<T> constant_flag_in_slot(const char* s, std::size_t n, std::size_t i) noexcept
+        {
+            return i && name_table<T>::names.entries[i - 1].size == n && equal_chars(name_table<T>::names.entries[i - 1].name, s, n)
+                ? static_cast<underlying_type_t<T>>(name_table<T>::names.entries[i - 1].value)
+                : has_hex_prefix(s, n) ? checked_flag_number<T>(s, n)
+                : unknown_flag_name<T>();
+        }
+
+        template<class T>
+        inline constexpr underlying_type_t<T> constant_flag(const char* s, std::size_t n) noexcept
+        {
+            return constant_flag_in_slot<T>(s, n, name_table<T>::slots.values[
+                name_slot(name_hash(s, n, name_hash_basis(name_table<T>::seed)), name_table<T>::slot_bits)]);
+        }
+
+        template<class T>
+        inline constexpr underlying_type_t<T> parse_constant_from(const char* s, std::size_t i, std::size_t n) noexcept;
+
+        // The name is [first, separator) without the blanks at the end
+        template<class T>
+        inline constexpr underlying_type_t<T> parse_constant_name(const char* s, std::size_t first, std::size_t separator,
+                                                                  std::size_t n) noexcept
+        {
+            return static_cast<underlying_type_t<T>>(constant_flag<T>(s + first, trim_blanks(s, first, separator) - first)
+                | (separator == n ? 0 : parse_constant_from<T>(s, separator + 1, n)));
+        }
+
+        template<class T>
+        inline constexpr underlying_type_t<T> parse_constant_from(const char* s, std::size_t i, std::size_t n) noexcept
+        {
+            return parse_constant_name<T>(s, skip_blanks(s, i, n), find_separator(s, i, n), n);
+        }
+
+        template<class T>
+        inline constexpr underlying_type_t<T> parse_constant(const char* s, std::size_t n) noexcept
+        {
+            return skip_blanks(s, 0, n) == n ? 0 : parse_constant_from<T>(s, 0, n);
+        }
+    }
+
+    // The same as `parse()` for the string literals but `constexpr`. An unknown name fails the compilation when
+    // evaluated at compile time and the assertion at run time. See also `BITMASK_LITERAL`.
+    template<class T, std::size_t N>
+    inline constexpr bitmask<T> parse_literal(const char (&text)[N]) noexcept
+    {
+        return bitmask_detail::to_enum<T>(bitmask_detail::parse_constant<T>(text, N - 1));
+    }
+
+    namespace bitmask_detail {
+        // `format_to()` of the raw bits, that may be out of the domain
+        template<class T>
+        inline char* format_names_to(char* out, underlying_type_t<T> bits) noexcept
+        {
+            using table = name_table<T>;
+            using underlying_type = underlying_type_t<T>;
+
+            underlying_type unnamed = 0;
+            bool first = true;
+            for (underlying_type b = static_cast<underlying_type>(bits & bitmask<T>::mask_value); b;
+                 b = static_cast<underlying_type>(b & (b - 1u)))
+            {
+                const std::size_t i = table::names_of_bits.values[lowest_bit_index(b)];
+                if (!i)
+                {
+                    unnamed = static_cast<underlying_type>(unnamed | (b & (0u - b)));
+                    continue;
+                }
+                const enum_name<T>& e = table::names.entries[i - 1];
+                if (!first)
+                    *out++ = '|';
+                std::memcpy(out, e.name, e.size);
+                out += e.size;
+                first = false;
+            }
+            if (unnamed)
+            {
+                if (!first)
+                    *out++ = '|';
+                out = format_hex(out, unnamed);
+                first = false;
+            }
+            return format_out_of_domain<T>(out, bits, first);
+        }
+    }
+
+    // Writes the names of the flags of `m` from the lowest bit to the highest separated by `|` and then the flags
+    // that have no name as a hex number. Writes nothing for an empty bitmask. The bits out of the domain, that
+    // a bitmask can only get from an unchecked value, follow as `!` and a hex number. `out` must have room for
+    // `max_formatted_size<T>::value` characters. Returns the end of the text, which is not null terminated.
+    template<class T>
+    inline char* format_to(char* out, const bitmask<T>& m) noexcept
+    {
+        return bitmask_detail::format_names_to<T>(out, m.bits());
+    }
+}
+
+
+// Implementation detail macros
+#define BITMASK_DETAIL_EXPAND(x) x
+
+#define BITMASK_DETAIL_COUNT_IMPL(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64, N, ...) N
+#define BITMASK_DETAIL_COUNT(...) \
+    BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_COUNT_IMPL(__VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+
+#define BITMASK_DETAIL_NAME_ENTRY(value_type, name) {value_type::name, #name, sizeof(#name) - 1}
+#define BITMASK_DETAIL_NAME_ENTRIES_1(value_type, name) BITMASK_DETAIL_NAME_ENTRY(value_type, name)
+#define BITMASK_DETAIL_NAME_ENTRIES_2(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_1(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_3(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_2(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_4(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_3(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_5(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_4(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_6(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_5(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_7(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_6(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_8(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_7(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_9(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_8(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_10(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_9(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_11(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_10(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_12(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_11(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_13(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_12(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_14(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_13(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_15(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_14(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_16(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_15(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_17(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_16(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_18(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_17(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_19(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_18(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_20(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_19(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_21(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_20(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_22(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_21(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_23(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_22(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_24(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_23(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_25(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_24(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_26(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_25(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_27(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_26(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_28(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_27(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_29(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_28(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_30(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_29(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_31(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_30(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_32(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_31(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_33(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_32(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_34(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_33(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_35(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_34(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_36(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_35(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_37(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_36(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_38(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_37(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_39(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_38(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_40(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_39(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_41(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_40(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_42(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_41(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_43(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_42(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_44(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_43(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_45(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_44(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_46(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_45(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_47(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_46(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_48(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_47(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_49(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_48(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_50(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_49(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_51(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_50(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_52(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_51(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_53(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_52(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_54(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_53(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_55(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_54(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_56(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_55(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_57(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_56(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_58(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_57(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_59(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_58(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_60(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_59(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_61(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_60(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_62(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_61(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_63(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_62(value_type, __VA_ARGS__))
+#define BITMASK_DETAIL_NAME_ENTRIES_64(value_type, name, ...) BITMASK_DETAIL_NAME_ENTRY(value_type, name), BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_NAME_ENTRIES_63(value_type, __VA_ARGS__))
+
+
+// Public macros
+
+// Registers the names of the flags of 'value_type' listed after it, for example
+// BITMASK_DEFINE_NAMES(open_mode, in, out, binary). Every listed element must be a single flag.
+// Up to 64 names.
+#define BITMASK_DEFINE_NAMES(value_type, ...) \
+    inline constexpr bitmask::enum_names<value_type, BITMASK_DETAIL_COUNT(__VA_ARGS__)> get_enum_names(value_type) noexcept { \
+        return {{BITMASK_DETAIL_EXPAND(BITMASK_DETAIL_CONCAT(BITMASK_DETAIL_NAME_ENTRIES_, BITMASK_DETAIL_COUNT(__VA_ARGS__))(value_type, __VA_ARGS__))}}; \
+    }
+
+// Parses the names of the flags of 'value_type' in the string literal 'text' at compile time,
+// for example BITMASK_LITERAL(open_mode, "app|binary"). An unknown name is a compilation error.
+#define BITMASK_LITERAL(value_type, text) \
+    (::bitmask::bitmask<value_type>(::bitmask::bitmask_detail::to_enum<value_type>(std::integral_constant< \
+        ::bitmask::bitmask_detail::underlying_type_t<value_type>, \
+        ::bitmask::bitmask_detail::parse_constant<value_type>(text, sizeof(text) - 1)>::value)))
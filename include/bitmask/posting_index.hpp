@@ -0,0 +1,669 @@
+#pragma once
+
+/*
+    Bitmask posting index
+    =====================
+
+    `bitmask_posting_index<T>` keeps a column of `bitmask<T>` as one compressed set of row numbers (postings) per flag.
+    The sets (`row_set`) are Roaring-style: the row numbers are split by the high 16 bits into containers that hold
+    the low 16 bits as a sorted array, a bitmap or a list of runs, whichever is the smallest.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "algorithm.hpp"
+#include "bitmask.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+
+namespace bitmask {
+
+    namespace bitmask_detail {
+        const std::size_t row_container_bitmap_words = 1024;
+        // Arrays larger than this take more space than a bitmap
+        const std::size_t row_container_max_array_size = 4096;
+
+        // Set of 16 bit values that share the high 16 bits (`key`) of a `row_set`
+        struct row_container
+        {
+            enum class kind: std::uint8_t { array, bitmap, run };
+
+            std::uint16_t key = 0;
+            kind type = kind::array;
+            std::uint32_t cardinality = 0;
+            // Sorted values of an array, or (start, length - 1) pairs of a run container
+            std::vector<std::uint16_t> values;
+            // Bits of a bitmap container
+            std::vector<std::uint64_t> words;
+
+            bool contains(std::uint16_t v) const noexcept
+            {
+                switch (type)
+                {
+                    case kind::array:
+                        return std::binary_search(values.begin(), values.end(), v);
+                    case kind::bitmap:
+                        return (words[v / 64] >> (v % 64)) & 1u;
+                    case kind::run:
+                        return run_containing(v) != runs();
+                }
+                return false;
+            }
+
+            std::size_t runs() const noexcept { return values.size() / 2; }
+            std::uint16_t run_start(std::size_t i) const noexcept { return values[i * 2]; }
+            std::uint32_t run_end(std::size_t i) const noexcept { return std::uint32_t{values[i * 2]} + values[i * 2 + 1] + 1; }
+
+            // Index of the run that contains `v` or `runs()` if there is no such run
+            std::size_t run_containing(std::uint16_t v) const noexcept
+            {
+                std::size_t lo = 0, hi = runs();
+                while (lo != hi)
+                {
+                    const std::size_t mid = (lo + hi) / 2;
+                    if (run_end(mid) <= v)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                return lo != runs() && run_start(lo) <= v ? lo : runs();
+            }
+
+            // Calls `fn(v)` for every value in the ascending order
+            template<class Fn>
+            void for_each(Fn&& fn) const
+            {
+                switch (type)
+                {
+                    case kind::array:
+                        for (auto v : values)
+                            fn(v);
+                        break;
+                    case kind::bitmap:
+                        for (std::size_t i = 0; i != row_container_bitmap_words; ++i)
+                        {
+                            for (std::uint64_t w = words[i]; w; w &= w - 1)
+                                fn(static_cast<std::uint16_t>(i * 64 + static_cast<std::size_t>(lowest_bit_index(w))));
+                        }
+                        break;
+                    case kind::run:
+                        for (std::size_t i = 0; i != runs(); ++i)
+                        {
+                            for (std::uint32_t v = run_start(i); v != run_end(i); ++v)
+                                fn(static_cast<std::uint16_t>(v));
+                        }
+                        break;
+                }
+            }
+
+            // The values as a bitmap regardless of the container type
+            std::vector<std::uint64_t> to_bitmap() const
+            {
+                if (type == kind::bitmap)
+                    return words;
+
+                std::vector<std::uint64_t> bitmap(row_container_bitmap_words);
+                if (type == kind::array)
+                {
+                    for (auto v : values)
+                        bitmap[v / 64] |= std::uint64_t{1} << (v % 64);
+                }
+                else
+                {
+                    for (std::size_t i = 0; i != runs(); ++i)
+                        set_range(bitmap.data(), run_start(i), run_end(i));
+                }
+                return bitmap;
+            }
+
+            static void set_range(std::uint64_t* bitmap, std::uint32_t first, std::uint32_t last) noexcept
+            {
+                for (; first != last && first % 64; ++first)
+                    bitmap[first / 64] |= std::uint64_t{1} << (first % 64);
+                for (; last - first >= 64; first += 64)
+                    bitmap[first / 64] = ~std::uint64_t{0};
+                for (; first != last; ++first)
+                    bitmap[first / 64] |= std::uint64_t{1} << (first % 64);
+            }
+
+            // Appends a value greater than all the present ones to an array or bitmap container
+            void append(std::uint16_t v)
+            {
+                assert(type != kind::run);
+                if (type == kind::array)
+                {
+                    if (values.size() == row_container_max_array_size)
+                    {
+                        words = to_bitmap();
+                        std::vector<std::uint16_t>().swap(values);
+                        type = kind::bitmap;
+                    }
+                    else
+                    {
+                        values.push_back(v);
+                        ++cardinality;
+                        return;
+                    }
+                }
+                words[v / 64] |= std::uint64_t{1} << (v % 64);
+                ++cardinality;
+            }
+
+            // Number of the runs of consecutive values
+            std::size_t count_runs() const noexcept
+            {
+                switch (type)
+                {
+                    case kind::array:
+                    {
+                        std::size_t result = 0;
+                        for (std::size_t i = 0; i != values.size(); ++i)
+                            result += i == 0 || values[i] != values[i - 1] + 1;
+                        return result;
+                    }
+                    case kind::bitmap:
+                    {
+                        // A run starts at every set bit that has the previous bit clear
+                        std::size_t result = 0;
+                        std::uint64_t carry = 0;
+                        for (auto w : words)
+                        {
+                            result += static_cast<std::size_t>(popcount(w & ~((w << 1) | carry)));
+                            carry = w >> 63;
+                        }
+                        return result;
+                    }
+                    case kind::run:
+                        return runs();
+                }
+                return 0;
+            }
+
+            // Converts the container to the smallest of the representations
+            void optimize()
+            {
+                const std::size_t run_bytes = count_runs() * 4;
+                const std::size_t array_bytes = cardinality * 2;
+                const std::size_t bitmap_bytes = row_container_bitmap_words * 8;
+
+                if (run_bytes < (std::min)(array_bytes, bitmap_bytes))
+                {
+                    if (type != kind::run)
+                    {
+                        std::vector<std::uint16_t> runs;
+                        runs.reserve(run_bytes / 2);
+                        for_each([&](std::uint16_t v) {
+                            if (!runs.empty() && std::uint32_t{runs[runs.size() - 2]} + runs.back() + 1 == v)
+                                ++runs.back();
+                            else
+                            {
+                                runs.push_back(v);
+                                runs.push_back(0);
+                            }
+                        });
+                        values = std::move(runs);
+                        std::vector<std::uint64_t>().swap(words);
+                        type = kind::run;
+                    }
+                }
+                else
+                {
+                    *this = from_bitmap_or_array(key, *this);
+                }
+            }
+
+            // Array or bitmap container with the values of `c`, whichever is smaller
+            static row_container from_bitmap_or_array(std::uint16_t key, const row_container& c)
+            {
+                row_container result;
+                result.key = key;
+                result.cardinality = c.cardinality;
+                if (c.cardinality <= row_container_max_array_size)
+                {
+                    if (c.type == kind::array)
+                        result.values = c.values;
+                    else
+                    {
+                        result.values.reserve(c.cardinality);
+                        c.for_each([&](std::uint16_t v) { result.values.push_back(v); });
+                    }
+                }
+                else
+                {
+                    result.type = kind::bitmap;
+                    result.words = c.to_bitmap();
+                }
+                return result;
+            }
+
+            static row_container from_bitmap(std::uint16_t key, std::vector<std::uint64_t> bitmap)
+            {
+                row_container result;
+                result.key = key;
+                result.type = kind::bitmap;
+                result.cardinality = static_cast<std::uint32_t>(simd::popcount_words(bitmap.data(), bitmap.size()));
+                result.words = std::move(bitmap);
+                if (result.cardinality <= row_container_max_array_size)
+                    return from_bitmap_or_array(key, result);
+                return result;
+            }
+
+            static row_container from_array(std::uint16_t key, std::vector<std::uint16_t> values)
+            {
+                row_container result;
+                result.key = key;
+                result.cardinality = static_cast<std::uint32_t>(values.size());
+                result.values = std::move(values);
+                if (result.cardinality > row_container_max_array_size)
+                    return from_bitmap_or_array(key, result);
+                return result;
+            }
+
+            // Values of `a` that are (`keep` is true) or are not in `b`
+            static std::vector<std::uint16_t> filter_array(const row_container& a, const row_container& b, bool keep)
+            {
+                std::vector<std::uint16_t> result(a.values.size());
+                std::size_t n = 0;
+                if (b.type == kind::array && b.values.size() <= a.values.size() * 16)
+                {
+                    // Branchless merge: every step advances past the smaller value or both of the equal ones
+                    const std::uint16_t* x = a.values.data();
+                    const std::uint16_t* y = b.values.data();
+                    const std::uint16_t* x_end = x + a.values.size();
+                    const std::uint16_t* y_end = y + b.values.size();
+                    while (x != x_end && y != y_end)
+                    {
+                        const std::uint16_t u = *x, v = *y;
+                        result[n] = u;
+                        n += keep ? u == v : u < v;
+                        x += u <= v;
+                        y += v <= u;
+                    }
+                    if (!keep)
+                        n = static_cast<std::size_t>(std::copy(x, x_end, result.begin() + static_cast<std::ptrdiff_t>(n)) - result.begin());
+                }
+                else if (b.type == kind::array)
+                {
+                    // Binary search over the much longer `b`
+                    auto it = b.values.begin();
+                    for (auto v : a.values)
+                    {
+                        it = std::lower_bound(it, b.values.end(), v);
+                        if ((it != b.values.end() && *it == v) == keep)
+                            result[n++] = v;
+                    }
+                }
+                else
+                {
+                    for (auto v : a.values)
+                    {
+                        if (b.contains(v) == keep)
+                            result[n++] = v;
+                    }
+                }
+                result.resize(n);
+                return result;
+            }
+
+            static row_container intersect(const row_container& a, const row_container& b)
+            {
+                if (a.type == kind::array && (b.type != kind::array || a.cardinality <= b.cardinality))
+                    return from_array(a.key, filter_array(a, b, true));
+                if (b.type == kind::array)
+                    return from_array(a.key, filter_array(b, a, true));
+
+                if (a.type == kind::run && b.type == kind::run)
+                {
+                    row_container result;
+                    result.key = a.key;
+                    result.type = kind::run;
+                    std::size_t i = 0, j = 0;
+                    while (i != a.runs() && j != b.runs())
+                    {
+                        const std::uint32_t first = (std::max)(a.run_start(i), b.run_start(j));
+                        const std::uint32_t last = (std::min)(a.run_end(i), b.run_end(j));
+                        if (first < last)
+                        {
+                            result.values.push_back(static_cast<std::uint16_t>(first));
+                            result.values.push_back(static_cast<std::uint16_t>(last - first - 1));
+                            result.cardinality += last - first;
+                        }
+                        if (a.run_end(i) < b.run_end(j))
+                            ++i;
+                        else
+                            ++j;
+                    }
+                    // Fragmented runs may intersect into many short ones that take more space than an array
+                    result.optimize();
+                    return result;
+                }
+
+                auto bitmap = a.to_bitmap();
+                const auto other = b.to_bitmap();
+                simd::and_words(bitmap.data(), bitmap.data(), other.data(), row_container_bitmap_words);
+                return from_bitmap(a.key, std::move(bitmap));
+            }
+
+            static row_container unite(const row_container& a, const row_container& b)
+            {
+                if (a.type == kind::array && b.type == kind::array && a.cardinality + b.cardinality <= row_container_max_array_size)
+                {
+                    std::vector<std::uint16_t> values;
+                    values.reserve(a.cardinality + b.cardinality);
+                    std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+                    return from_array(a.key, std::move(values));
+                }
+
+                auto bitmap = a.to_bitmap();
+                const auto other = b.to_bitmap();
+                simd::or_words(bitmap.data(), bitmap.data(), other.data(), row_container_bitmap_words);
+                return from_bitmap(a.key, std::move(bitmap));
+            }
+
+            static row_container subtract(const row_container& a, const row_container& b)
+            {
+                if (a.type == kind::array)
+                    return from_array(a.key, filter_array(a, b, false));
+
+                auto bitmap = a.to_bitmap();
+                if (b.type == kind::array)
+                {
+                    for (auto v : b.values)
+                        bitmap[v / 64] &= ~(std::uint64_t{1} << (v % 64));
+                }
+                else
+                {
+                    const auto other = b.to_bitmap();
+                    simd::not_words(bitmap.data(), other.data(), bitmap.data(), row_container_bitmap_words);
+                }
+                return from_bitmap(a.key, std::move(bitmap));
+            }
+
+            friend bool operator == (const row_container& l, const row_container& r)
+            {
+                if (l.key != r.key || l.cardinality != r.cardinality)
+                    return false;
+                if (l.type == r.type)
+                    return l.values == r.values && l.words == r.words;
+                return l.to_bitmap() == r.to_bitmap();
+            }
+        };
+    }
+
+    // Compressed set of 32 bit row numbers
+    class row_set
+    {
+    public:
+        using value_type = std::uint32_t;
+        using size_type = std::size_t;
+
+        row_set() = default;
+
+        // Set of the rows `[first, last)`
+        static row_set range(std::uint64_t first, std::uint64_t last)
+        {
+            assert(first <= last && last <= std::uint64_t{std::numeric_limits<value_type>::max()} + 1);
+
+            row_set result;
+            while (first != last)
+            {
+                const std::uint64_t key = first >> 16;
+                const std::uint64_t end = (std::min)(last, (key + 1) << 16);
+
+                container c;
+                c.key = static_cast<std::uint16_t>(key);
+                c.type = container::kind::run;
+                c.cardinality = static_cast<std::uint32_t>(end - first);
+                c.values = {static_cast<std::uint16_t>(first & 0xFFFF), static_cast<std::uint16_t>(end - first - 1)};
+                result.m_containers.push_back(std::move(c));
+                first = end;
+            }
+            return result;
+        }
+
+        // Adds a row greater than all the present ones
+        void append(value_type row)
+        {
+            const auto key = static_cast<std::uint16_t>(row >> 16);
+            if (m_containers.empty() || m_containers.back().key != key)
+            {
+                assert(m_containers.empty() || m_containers.back().key < key);
+                container c;
+                c.key = key;
+                m_containers.push_back(std::move(c));
+            }
+            m_containers.back().append(static_cast<std::uint16_t>(row));
+        }
+
+        bool contains(value_type row) const noexcept
+        {
+            const container* c = find(static_cast<std::uint16_t>(row >> 16));
+            return c && c->contains(static_cast<std::uint16_t>(row));
+        }
+
+        // Number of the rows, no decompression involved
+        std::uint64_t cardinality() const noexcept
+        {
+            std::uint64_t result = 0;
+            for (const auto& c : m_containers)
+                result += c.cardinality;
+            return result;
+        }
+
+        bool empty() const noexcept { return m_containers.empty(); }
+
+        // Switches every container to the smallest representation including runs. Call it when done with `append()`.
+        void optimize()
+        {
+            for (auto& c : m_containers)
+                c.optimize();
+        }
+
+        // Approximate memory taken by the set
+        size_type size_in_bytes() const noexcept
+        {
+            size_type result = sizeof(*this);
+            for (const auto& c : m_containers)
+                result += sizeof(c) + c.values.capacity() * sizeof(std::uint16_t) + c.words.capacity() * sizeof(std::uint64_t);
+            return result;
+        }
+
+        // Calls `fn(row)` for every row in the ascending order
+        template<class Fn>
+        void for_each(Fn&& fn) const
+        {
+            for (const auto& c : m_containers)
+            {
+                const value_type high = value_type{c.key} << 16;
+                c.for_each([&](std::uint16_t low) { fn(high | low); });
+            }
+        }
+
+        std::vector<value_type> to_vector() const
+        {
+            std::vector<value_type> result;
+            result.reserve(static_cast<size_type>(cardinality()));
+            for_each([&](value_type row) { result.push_back(row); });
+            return result;
+        }
+
+        friend row_set operator & (const row_set& l, const row_set& r)
+        {
+            row_set result;
+            result.m_containers.reserve((std::min)(l.m_containers.size(), r.m_containers.size()));
+            auto i = l.m_containers.begin(), j = r.m_containers.begin();
+            while (i != l.m_containers.end() && j != r.m_containers.end())
+            {
+                if (i->key < j->key)
+                    ++i;
+                else if (j->key < i->key)
+                    ++j;
+                else
+                    result.push_nonempty(container::intersect(*i++, *j++));
+            }
+            return result;
+        }
+
+        friend row_set operator | (const row_set& l, const row_set& r)
+        {
+            row_set result;
+            auto i = l.m_containers.begin(), j = r.m_containers.begin();
+            while (i != l.m_containers.end() || j != r.m_containers.end())
+            {
+                if (j == r.m_containers.end() || (i != l.m_containers.end() && i->key < j->key))
+                    result.m_containers.push_back(*i++);
+                else if (i == l.m_containers.end() || j->key < i->key)
+                    result.m_containers.push_back(*j++);
+                else
+                    result.m_containers.push_back(container::unite(*i++, *j++));
+            }
+            return result;
+        }
+
+        // Rows of `l` that are not in `r` (AND NOT)
+        friend row_set operator - (const row_set& l, const row_set& r)
+        {
+            row_set result;
+            auto j = r.m_containers.begin();
+            for (const auto& c : l.m_containers)
+            {
+                while (j != r.m_containers.end() && j->key < c.key)
+                    ++j;
+                if (j != r.m_containers.end() && j->key == c.key)
+                    result.push_nonempty(container::subtract(c, *j));
+                else
+                    result.m_containers.push_back(c);
+            }
+            return result;
+        }
+
+        row_set& operator &= (const row_set& r) { return *this = *this & r; }
+        row_set& operator |= (const row_set& r) { return *this = *this | r; }
+        row_set& operator -= (const row_set& r) { return *this = *this - r; }
+
+        friend bool operator == (const row_set& l, const row_set& r) { return l.m_containers == r.m_containers; }
+        friend bool operator != (const row_set& l, const row_set& r) { return !(l == r); }
+
+    private:
+        using container = bitmask_detail::row_container;
+
+        const container* find(std::uint16_t key) const noexcept
+        {
+            const auto it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+                                             [](const container& c, std::uint16_t k) { return c.key < k; });
+            return it != m_containers.end() && it->key == key ? &*it : nullptr;
+        }
+
+        void push_nonempty(container&& c)
+        {
+            if (c.cardinality)
+                m_containers.push_back(std::move(c));
+        }
+
+        std::vector<container> m_containers;
+    };
+
+    template<class T>
+    class bitmask_posting_index
+    {
+    public:
+        using value_type = bitmask<T>;
+        using size_type = std::size_t;
+
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+        // One posting set per flag of the domain, ordered by `flag_index()`
+        static constexpr std::size_t posting_count = flag_count<T>::value;
+
+        bitmask_posting_index() = default;
+
+        bitmask_posting_index(const value_type* first, const value_type* last)
+            : m_size(static_cast<size_type>(last - first))
+        {
+            assert(m_size <= size_type{std::numeric_limits<row_set::value_type>::max()} + 1);
+
+            for (size_type row = 0; row != m_size; ++row)
+            {
+                for (T flag : first[row])
+                    m_postings[flag_index(flag)].append(static_cast<row_set::value_type>(row));
+            }
+            for (auto& p : m_postings)
+                p.optimize();
+        }
+
+        // Number of the rows
+        size_type size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        // Rows that have `flag` set
+        const row_set& postings(T flag) const noexcept { return m_postings[flag_index(flag)]; }
+
+        // Rows that have all the bits of `must` and none of the bits of `must_not` set
+        row_set select(const value_type& must, const value_type& must_not = value_type{}) const
+        {
+            // Intersect starting from the rarest flag so the intermediate sets are as small as possible
+            std::array<const row_set*, posting_count> required;
+            std::size_t n = 0;
+            for (T flag : must)
+                required[n++] = &postings(flag);
+            std::sort(required.begin(), required.begin() + n,
+                      [](const row_set* l, const row_set* r) { return l->cardinality() < r->cardinality(); });
+
+            row_set result = n == 0 ? row_set::range(0, m_size) : n == 1 ? *required[0] : *required[0] & *required[1];
+            for (std::size_t i = 2; i < n && !result.empty(); ++i)
+                result &= *required[i];
+            for (T flag : must_not)
+            {
+                if (result.empty())
+                    break;
+                result -= postings(flag);
+            }
+            return result;
+        }
+
+        // Rows that have any of the bits of `m` set
+        row_set select_any(const value_type& m) const
+        {
+            row_set result;
+            for (T flag : m)
+                result |= postings(flag);
+            return result;
+        }
+
+        // Number of the rows selected by `select(must, must_not)`
+        std::uint64_t count(const value_type& must, const value_type& must_not = value_type{}) const
+        {
+            if (!must_not && must.has_single_bit())
+                return postings(*must.begin()).cardinality();
+            return select(must, must_not).cardinality();
+        }
+
+        // Approximate memory taken by the postings
+        size_type size_in_bytes() const noexcept
+        {
+            size_type result = sizeof(*this);
+            for (const auto& p : m_postings)
+                result += p.size_in_bytes() - sizeof(p);
+            return result;
+        }
+
+    private:
+        size_type m_size = 0;
+        std::array<row_set, posting_count> m_postings;
+    };
+
+    template<class T>
+    constexpr std::size_t bitmask_posting_index<T>::posting_count;
+}
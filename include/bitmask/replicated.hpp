@@ -0,0 +1,136 @@
+#pragma once
+
+/*
+    Replicated bitmask
+    ==================
+
+    `replicated_bitmask<T>` keeps a copy of a read-mostly `bitmask<T>` per thread slot, so the readers never share
+    a cache line with each other or with a writer.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+#include "bitmask_vector.hpp"
+#include "seqlock.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace bitmask {
+
+    // Reads take the slot of the calling thread (threads are spread over the slots round robin) and do a plain
+    // atomic load there. Bit index bitmasks are wider than an atomic, so their slots are `seqlock_bitmask<T>`
+    // and the readers never see a half written value. Writers are serialized by a mutex and write the new value
+    // to every slot in turn, so for a short time some readers may still see the previous value.
+    template<class T>
+    class replicated_bitmask
+    {
+    public:
+        using value_type = bitmask<T>;
+
+        static constexpr std::size_t alignment = 64;
+
+        // One slot per hardware thread by default. The number of the slots is rounded up to a power of two.
+        explicit replicated_bitmask(const value_type& initial = value_type(), std::size_t slots = 0)
+            : m_value(initial)
+            , m_slots(round_up_to_power_of_two(slots ? slots : default_slot_count()))
+        {
+            for (auto& s: m_slots)
+                s.replica.store(initial);
+        }
+
+        replicated_bitmask(const replicated_bitmask&) = delete;
+        replicated_bitmask& operator = (const replicated_bitmask&) = delete;
+
+        std::size_t slot_count() const noexcept { return m_slots.size(); }
+
+        // Reads the copy of the calling thread's slot
+        value_type load() const noexcept
+        {
+            return m_slots[bitmask_detail::thread_ordinal() & (m_slots.size() - 1)].replica.load();
+        }
+
+        // Number of the writes done so far. Readers may compare it to find out if the value has changed.
+        std::uint64_t generation() const noexcept { return m_generation.load(std::memory_order_acquire); }
+
+        void store(const value_type& v)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            publish(v);
+        }
+
+        // Sets the flags of `m` and returns the previous value
+        value_type set(const value_type& m)
+        {
+            return modify([&m](value_type& v) { v |= m; });
+        }
+
+        // Clears the flags of `m` and returns the previous value
+        value_type clear(const value_type& m)
+        {
+            return modify([&m](value_type& v) { v &= ~m; });
+        }
+
+        // Calls `fn(value_type&)` on the current value, publishes the result and returns the previous value
+        template<class Fn>
+        value_type modify(Fn&& fn)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const value_type prev = m_value;
+            value_type v = prev;
+            fn(v);
+            publish(v);
+            return prev;
+        }
+
+    private:
+        using replica_type = typename std::conditional<bitmask_detail::is_bit_index_enum<T>::value,
+            seqlock_bitmask<T>, atomic_bitmask<T>>::type;
+
+        struct alignas(alignment) slot
+        {
+            replica_type replica;
+        };
+
+        static std::size_t default_slot_count() noexcept
+        {
+            const unsigned n = std::thread::hardware_concurrency();
+            return n ? n : 1;
+        }
+
+        static std::size_t round_up_to_power_of_two(std::size_t n) noexcept
+        {
+            std::size_t p = 1;
+            while (p < n)
+                p *= 2;
+            return p;
+        }
+
+        void publish(const value_type& v) noexcept
+        {
+            m_value = v;
+            for (auto& s: m_slots)
+                s.replica.store(v);
+            m_generation.fetch_add(1, std::memory_order_release);
+        }
+
+        std::mutex m_mutex;
+        value_type m_value;
+        std::atomic<std::uint64_t> m_generation{0};
+        std::vector<slot, bitmask_detail::aligned_allocator<slot, alignment>> m_slots;
+    };
+
+    template<class T>
+    constexpr std::size_t replicated_bitmask<T>::alignment;
+}
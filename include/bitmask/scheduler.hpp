@@ -0,0 +1,224 @@
+#pragma once
+
+/*
+    Priority scheduler
+    ==================
+
+    `priority_run_queue<T, Task>` is a set of FIFO run queues, one per priority level, with a `bitmask<T>` of
+    the non-empty levels, so picking the next task is a single bit scan however many tasks are queued.
+    `work_stealing_scheduler<T, Task>` gives every worker such a queue and lets idle workers steal from the others.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+#include "bitmask_vector.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+
+namespace bitmask {
+
+    // Base of the tasks that go to the run queues. The queues link the tasks through it, so a task is in one queue
+    // at a time and the queues never allocate.
+    class run_queue_hook
+    {
+        template<class T, class Task> friend class priority_run_queue;
+
+        run_queue_hook* m_next = nullptr;
+    };
+
+    // The flags of `T` are the priority levels, a higher bit is a higher priority. Tasks of the same level run in
+    // the order they were pushed. Not thread safe.
+    template<class T, class Task>
+    class priority_run_queue
+    {
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+        static_assert(std::is_base_of<run_queue_hook, Task>::value, "Task must derive from run_queue_hook");
+
+    public:
+        using value_type = bitmask<T>;
+
+        priority_run_queue() = default;
+
+        priority_run_queue(const priority_run_queue&) = delete;
+        priority_run_queue& operator = (const priority_run_queue&) = delete;
+
+        bool empty() const noexcept { return !m_ready; }
+
+        // Levels that have tasks queued
+        value_type ready() const noexcept { return bitmask_detail::to_enum<T>(m_ready); }
+
+        void push(T level, Task& task) noexcept
+        {
+            const std::size_t i = index_of(level);
+            run_queue_hook* h = &task;
+            assert(!h->m_next);
+            queue& q = m_queues[i];
+            if (m_ready & bit(i))
+                q.tail->m_next = h;
+            else
+            {
+                q.head = h;
+                m_ready = static_cast<underlying_type>(m_ready | bit(i));
+            }
+            q.tail = h;
+        }
+
+        // Takes the first task of the highest non-empty level or returns `nullptr` if there is none
+        Task* pop_highest() noexcept
+        {
+            if (!m_ready)
+                return nullptr;
+            const std::size_t i = static_cast<std::size_t>(bitmask_detail::highest_bit_index(m_ready));
+            queue& q = m_queues[i];
+            run_queue_hook* h = q.head;
+            q.head = h->m_next;
+            if (!q.head)
+                m_ready = static_cast<underlying_type>(m_ready & ~bit(i));
+            h->m_next = nullptr;
+            return static_cast<Task*>(h);
+        }
+
+    private:
+        using underlying_type = typename value_type::underlying_type;
+
+        struct queue
+        {
+            run_queue_hook* head = nullptr;
+            run_queue_hook* tail = nullptr;  // Valid only while the level is ready
+        };
+
+        static underlying_type bit(std::size_t i) noexcept { return static_cast<underlying_type>(underlying_type{1} << i); }
+
+        static std::size_t index_of(T level) noexcept
+        {
+            const auto b = static_cast<underlying_type>(level);
+            assert(b != 0 && (b & (b - 1u)) == 0 && (b & value_type::mask_value) == b);
+            return static_cast<std::size_t>(bitmask_detail::lowest_bit_index(b));
+        }
+
+        // Indexed by the bit of the level, the queues of the bits out of the domain are never used
+        std::array<queue, std::numeric_limits<underlying_type>::digits> m_queues;
+        underlying_type m_ready = 0;
+    };
+
+    // Every worker has its own run queue under its own mutex and publishes the levels the queue has in an atomic
+    // bitmask. A worker pops from its own queue first. When that is empty it reads the published bitmasks of the
+    // other workers, which costs no lock and no write, and steals from the one with the highest level.
+    // Since a higher top bit is a greater number, that is the worker with the greatest bitmask.
+    template<class T, class Task>
+    class work_stealing_scheduler
+    {
+    public:
+        using value_type = bitmask<T>;
+
+        static constexpr std::size_t alignment = 64;
+
+        explicit work_stealing_scheduler(std::size_t workers)
+            : m_workers(workers)
+        {
+            assert(workers > 0);
+        }
+
+        work_stealing_scheduler(const work_stealing_scheduler&) = delete;
+        work_stealing_scheduler& operator = (const work_stealing_scheduler&) = delete;
+
+        std::size_t worker_count() const noexcept { return m_workers.size(); }
+
+        // Levels that have tasks queued at any worker, may be stale by the time it returns
+        value_type ready() const noexcept
+        {
+            value_type result;
+            for (const auto& w: m_workers)
+                result |= w.ready.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        // Queues `task` to the run queue of `worker`. Any thread may push to any worker.
+        void push(std::size_t worker, T level, Task& task)
+        {
+            worker_queue& w = m_workers[worker];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            w.queue.push(level, task);
+            publish(w);
+        }
+
+        // Takes the highest priority task of `worker`'s own queue or else steals the highest priority task
+        // of the others. Returns `nullptr` if all the queues are empty.
+        Task* pop(std::size_t worker)
+        {
+            if (Task* task = pop_from(m_workers[worker]))
+                return task;
+            return steal(worker);
+        }
+
+        // Steals the highest priority task of the workers other than `thief` or returns `nullptr` if there is none
+        Task* steal(std::size_t thief)
+        {
+            for (;;)
+            {
+                worker_queue* victim = nullptr;
+                underlying_type best = 0;
+                for (std::size_t i = 1; i != m_workers.size(); ++i)
+                {
+                    worker_queue& w = m_workers[(thief + i) % m_workers.size()];
+                    const underlying_type levels = w.ready.load(std::memory_order_relaxed).bits();
+                    if (levels > best)
+                    {
+                        best = levels;
+                        victim = &w;
+                    }
+                }
+                if (!victim)
+                    return nullptr;
+                // The victim may have run out of tasks since, then look again
+                if (Task* task = pop_from(*victim))
+                    return task;
+            }
+        }
+
+    private:
+        using underlying_type = typename value_type::underlying_type;
+
+        struct alignas(alignment) worker_queue
+        {
+            std::mutex mutex;
+            priority_run_queue<T, Task> queue;
+            atomic_bitmask<T> ready{value_type()};  // Copy of `queue.ready()` for the thieves
+        };
+
+        static void publish(worker_queue& w) noexcept
+        {
+            // Written only when it changes, so the thieves' cache lines stay valid
+            const value_type levels = w.queue.ready();
+            if (w.ready.load(std::memory_order_relaxed) != levels)
+                w.ready.store(levels, std::memory_order_relaxed);
+        }
+
+        static Task* pop_from(worker_queue& w)
+        {
+            if (!w.ready.load(std::memory_order_relaxed))
+                return nullptr;
+            std::lock_guard<std::mutex> lock(w.mutex);
+            Task* task = w.queue.pop_highest();
+            publish(w);
+            return task;
+        }
+
+        std::vector<worker_queue, bitmask_detail::aligned_allocator<worker_queue, alignment>> m_workers;
+    };
+
+    template<class T, class Task>
+    constexpr std::size_t work_stealing_scheduler<T, Task>::alignment;
+}
@@ -0,0 +1,344 @@
+#pragma once
+
+/*
+    Name-keyed serialization
+    ========================
+
+    Records stay raw `bits()` words and a dictionary of the flag names is stored once per file or stream. When
+    the enum gains, drops or renumbers flags between releases, `schema_remap<T>` built from the stored dictionary
+    translates every record to the current bits with a table lookup per byte or PEXT and PDEP.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+#include "names.hpp"
+#include "serialize.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+
+namespace bitmask {
+
+    // What happens to the stored flags that the current enum does not have
+    enum class unknown_flags
+    {
+        drop,  // They are cleared
+        fail,  // The record fails with `decode_error::out_of_domain`
+    };
+
+    // Size of the dictionary `write_schema()` writes: the word size, the number of the flags and the bit and
+    // the name of every flag of the domain
+    template<class T>
+    struct schema_size : std::integral_constant<std::size_t, 2 + 2 * flag_count<T>::value
+        + bitmask_detail::sum_of_name_sizes(bitmask_detail::name_table<T>::names, 0,
+                                            bitmask_detail::name_table<T>::names_type::count)> {};
+
+    // Writes the dictionary of the flags of `T` that the records written with `encode_fixed()` are read with.
+    // The flags that have no name are written with an empty name and are matched by their bit.
+    template<class T>
+    inline unsigned char* write_schema(unsigned char* out) noexcept
+    {
+        static_assert(bitmask_detail::has_enum_names<T>::value, "Names are not defined, use BITMASK_DEFINE_NAMES");
+
+        using table = bitmask_detail::name_table<T>;
+
+        static_assert(bitmask_detail::max_name_size(table::names, 0, table::names_type::count) <= 0xFF,
+                      "The names of the dictionary are limited to 255 characters");
+        using underlying_type = bitmask_detail::underlying_type_t<T>;
+
+        *out++ = static_cast<unsigned char>(fixed_size<T>::value);
+        *out++ = static_cast<unsigned char>(flag_count<T>::value);
+        for (underlying_type b = bitmask<T>::mask_value; b; b = static_cast<underlying_type>(b & (b - 1u)))
+        {
+            const int bit = bitmask_detail::lowest_bit_index(b);
+            const std::size_t i = table::names_of_bits.values[bit];
+            const std::size_t size = i ? table::names.entries[i - 1].size : 0;
+            *out++ = static_cast<unsigned char>(bit);
+            *out++ = static_cast<unsigned char>(size);
+            if (size)
+                std::memcpy(out, table::names.entries[i - 1].name, size);
+            out += size;
+        }
+        return out;
+    }
+
+    struct schema_read_result
+    {
+        const unsigned char* next;  // Past the dictionary on success, at its start on failure
+        decode_error error;
+
+        explicit constexpr operator bool() const noexcept { return error == decode_error::none; }
+    };
+
+    // Translates the records written with the dictionary read by `read_schema()` to the current flags of `T`.
+    // The translation is picked once per dictionary:
+    // - nothing changed or the flags were only added: the records are masked
+    // - the flags kept their order: PEXT of the stored bits and PDEP to the current ones, if the CPU supports them
+    // - otherwise: a lookup per byte of the record in the tables of 256 entries
+    template<class T>
+    class schema_remap
+    {
+        static_assert(bitmask_detail::has_enum_names<T>::value, "Names are not defined, use BITMASK_DEFINE_NAMES");
+
+    public:
+        using value_type = bitmask<T>;
+        using underlying_type = typename value_type::underlying_type;
+
+        // Reads the records written by this build
+        schema_remap() noexcept
+            : m_word_size{fixed_size<T>::value}, m_stored{value_type::mask_value}, m_known{value_type::mask_value},
+              m_target{value_type::mask_value}, m_rejected{0}, m_strategy{strategy::identity} {}
+
+        // Reads the dictionary that `write_schema()` wrote. On failure the remap is left as it was.
+        schema_read_result read_schema(const unsigned char* in, const unsigned char* end,
+                                       unknown_flags unknown = unknown_flags::drop) noexcept
+        {
+            const unsigned char* const start = in;
+            if (end - in < 2)
+                return {start, decode_error::truncated};
+            const std::size_t word_size = in[0];
+            const std::size_t count = in[1];
+            in += 2;
+            if ((word_size != 1 && word_size != 2 && word_size != 4 && word_size != 8) || count > word_size * 8)
+                return {start, decode_error::bad_schema};
+
+            int map[64];  // The current bit of every stored one or -1
+            for (int& m: map)
+                m = -1;
+            std::uint64_t stored = 0;
+            underlying_type mapped = 0;
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                if (end - in < 2 || static_cast<std::size_t>(end - in) - 2 < in[1])
+                    return {start, decode_error::truncated};
+                const unsigned bit = in[0];
+                const std::size_t size = in[1];
+                in += 2;
+                if (bit >= word_size * 8 || (stored >> bit) & 1u)
+                    return {start, decode_error::bad_schema};
+                stored |= std::uint64_t{1} << bit;
+
+                const int target = size ? named_bit(reinterpret_cast<const char*>(in), size) : unnamed_bit(bit);
+                in += size;
+                if (target < 0)
+                    continue;
+                if ((mapped >> target) & 1u)
+                    return {start, decode_error::bad_schema};
+                mapped = static_cast<underlying_type>(mapped | underlying_type{1} << target);
+                map[bit] = target;
+            }
+
+            build(word_size, stored, map, unknown);
+            return {in, decode_error::none};
+        }
+
+        // Bytes of a record
+        std::size_t record_size() const noexcept { return m_word_size; }
+
+        // Bits of the stored flags that have no flag now
+        std::uint64_t unknown_bits() const noexcept { return m_stored & ~m_known; }
+
+        decode_result<T> decode(const unsigned char* in, const unsigned char* end) const noexcept
+        {
+            if (static_cast<std::size_t>(end - in) < m_word_size)
+                return bitmask_detail::decode_failure<T>(in, decode_error::truncated);
+            const auto word = bitmask_detail::load_le<std::uint64_t>(in, m_word_size);
+            if (word & m_rejected)
+                return bitmask_detail::decode_failure<T>(in, decode_error::out_of_domain);
+            return {bitmask_detail::to_enum<T>(translate(word)), in + m_word_size, decode_error::none};
+        }
+
+        // Fills `[first, last)` and stops at the first record that fails like the bulk functions of `serialize.hpp`
+        bulk_decode_result decode(const unsigned char* in, const unsigned char* end,
+                                  value_type* first, value_type* last) const noexcept
+        {
+            const std::size_t n = static_cast<std::size_t>(last - first);
+            const std::size_t whole = bitmask_detail::values_available(in, end, m_word_size, n);
+            bulk_decode_result r;
+            switch (m_word_size)
+            {
+            case 1: r = decode_records<1>(in, first, whole); break;
+            case 2: r = decode_records<2>(in, first, whole); break;
+            case 4: r = decode_records<4>(in, first, whole); break;
+            default: r = decode_records<8>(in, first, whole); break;
+            }
+            if (r && whole != n)
+                r.error = decode_error::truncated;
+            return r;
+        }
+
+    private:
+        enum class strategy
+        {
+            identity,
+            gather,
+            lookup,
+        };
+
+        static int named_bit(const char* s, std::size_t size) noexcept
+        {
+            const enum_name<T>* e = bitmask_detail::find_name<T>(s, size);
+            return e ? bitmask_detail::lowest_bit_index(static_cast<underlying_type>(e->value)) : -1;
+        }
+
+        // The flag that has no name is matched by its bit if it has no name now either
+        static int unnamed_bit(unsigned bit) noexcept
+        {
+            return bit < static_cast<unsigned>(std::numeric_limits<underlying_type>::digits)
+                && ((value_type::mask_value >> bit) & 1u)
+                && !bitmask_detail::name_table<T>::names_of_bits.values[bit] ? static_cast<int>(bit) : -1;
+        }
+
+        void build(std::size_t word_size, std::uint64_t stored, const int* map, unknown_flags unknown) noexcept
+        {
+            m_word_size = word_size;
+            m_stored = stored;
+            m_known = 0;
+            m_target = 0;
+            bool identity = word_size == fixed_size<T>::value;
+            bool ordered = true;
+            int last = -1;
+            for (unsigned bit = 0; bit != word_size * 8; ++bit)
+            {
+                if (map[bit] < 0)
+                    continue;
+                m_known |= std::uint64_t{1} << bit;
+                m_target = static_cast<underlying_type>(m_target | underlying_type{1} << map[bit]);
+                identity = identity && map[bit] == static_cast<int>(bit);
+                ordered = ordered && map[bit] > last;
+                last = map[bit];
+            }
+            m_rejected = unknown == unknown_flags::fail ? ~m_known : 0;
+
+            m_strategy = identity ? strategy::identity
+                : ordered && simd::detected_cpu_features().bmi2 ? strategy::gather
+                : strategy::lookup;
+            if (m_strategy != strategy::lookup)
+                return;
+
+            // Every entry is the one without its lowest bit and the current bit of that one
+            for (std::size_t k = 0; k != word_size; ++k)
+            {
+                m_tables[k][0] = 0;
+                for (unsigned v = 1; v != 256; ++v)
+                {
+                    const int target = map[k * 8 + static_cast<unsigned>(bitmask_detail::lowest_bit_index(v))];
+                    m_tables[k][v] = static_cast<underlying_type>(m_tables[k][v & (v - 1)]
+                        | (target < 0 ? underlying_type{0} : static_cast<underlying_type>(underlying_type{1} << target)));
+                }
+            }
+        }
+
+        // Unrolled by hand, the compilers keep the loop over the bytes
+        template<std::size_t WordSize>
+        static underlying_type look_up(const underlying_type (*tables)[256], std::uint64_t word) noexcept
+        {
+            std::uint64_t bits = tables[0][word & 0xFFu];
+            if (WordSize > 1)
+                bits |= tables[1][(word >> 8) & 0xFFu];
+            if (WordSize > 2)
+                bits |= tables[2][(word >> 16) & 0xFFu] | tables[3][(word >> 24) & 0xFFu];
+            if (WordSize > 4)
+                bits |= tables[4][(word >> 32) & 0xFFu] | tables[5][(word >> 40) & 0xFFu]
+                    | tables[6][(word >> 48) & 0xFFu] | tables[7][(word >> 56) & 0xFFu];
+            return static_cast<underlying_type>(bits);
+        }
+
+        underlying_type translate(std::uint64_t word) const noexcept
+        {
+            switch (m_strategy)
+            {
+            case strategy::identity:
+                return static_cast<underlying_type>(word & m_known);
+#if BITMASK_SIMD_X86
+            case strategy::gather:
+                return static_cast<underlying_type>(
+                    bitmask_detail::bmi2::deposit(bitmask_detail::bmi2::extract(word, m_known), m_target));
+#endif
+            default:
+                switch (m_word_size)
+                {
+                case 1: return look_up<1>(m_tables, word);
+                case 2: return look_up<2>(m_tables, word);
+                case 4: return look_up<4>(m_tables, word);
+                default: return look_up<8>(m_tables, word);
+                }
+            }
+        }
+
+        // The members are copied to the locals as the stores to `first` could alias them
+        template<std::size_t WordSize, class Translate>
+        bulk_decode_result decode_with(const unsigned char* in, value_type* first, std::size_t n,
+                                       Translate translate) const noexcept
+        {
+            const std::uint64_t rejected = m_rejected;
+            for (std::size_t i = 0; i != n; ++i, in += WordSize)
+            {
+                const auto word = bitmask_detail::load_le<std::uint64_t>(in, WordSize);
+                if (word & rejected)
+                    return {i, in, decode_error::out_of_domain};
+                first[i] = bitmask_detail::to_enum<T>(translate(word));
+            }
+            return {n, in, decode_error::none};
+        }
+
+#if BITMASK_SIMD_X86
+        template<std::size_t WordSize>
+        BITMASK_DETAIL_TARGET("bmi2")
+        bulk_decode_result decode_gathered(const unsigned char* in, value_type* first, std::size_t n) const noexcept
+        {
+            const std::uint64_t rejected = m_rejected;
+            const std::uint64_t known = m_known;
+            const std::uint64_t target = m_target;
+            for (std::size_t i = 0; i != n; ++i, in += WordSize)
+            {
+                const auto word = bitmask_detail::load_le<std::uint64_t>(in, WordSize);
+                if (word & rejected)
+                    return {i, in, decode_error::out_of_domain};
+                first[i] = bitmask_detail::to_enum<T>(static_cast<underlying_type>(
+                    bitmask_detail::bmi2::deposit(bitmask_detail::bmi2::extract(word, known), target)));
+            }
+            return {n, in, decode_error::none};
+        }
+#endif
+
+        template<std::size_t WordSize>
+        bulk_decode_result decode_records(const unsigned char* in, value_type* first, std::size_t n) const noexcept
+        {
+            const std::uint64_t known = m_known;
+            const underlying_type (*tables)[256] = m_tables;
+            switch (m_strategy)
+            {
+            case strategy::identity:
+                return decode_with<WordSize>(in, first, n, [known](std::uint64_t word) {
+                    return static_cast<underlying_type>(word & known);
+                });
+#if BITMASK_SIMD_X86
+            case strategy::gather:
+                return decode_gathered<WordSize>(in, first, n);
+#endif
+            default:
+                return decode_with<WordSize>(in, first, n, [tables](std::uint64_t word) {
+                    return look_up<WordSize>(tables, word);
+                });
+            }
+        }
+
+        std::size_t m_word_size;
+        std::uint64_t m_stored;     // Bits of the flags in the dictionary
+        std::uint64_t m_known;      // Stored bits that have a flag now
+        underlying_type m_target;   // Current bits of them
+        std::uint64_t m_rejected;   // Stored bits that fail the record
+        strategy m_strategy;
+        underlying_type m_tables[8][256];
+    };
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+/*
+    Seqlock bitmask
+    ===============
+
+    `seqlock_bitmask<T>` is a bit index bitmask shared between threads. Readers take consistent snapshots of all
+    its words without locking.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace bitmask {
+
+    // The words are guarded by a sequence number that is odd while a writer is modifying them. A reader copies
+    // the words and retries only if the sequence number was odd or has changed meanwhile, i.e. only when it has
+    // overlapped with a write. Readers never write to the shared memory. Writers exclude each other by making
+    // the sequence number odd with a CAS.
+    //
+    // The words are atomics accessed with relaxed loads and stores, ordered by fences, so the concurrent access
+    // is not a data race.
+    template<class T>
+    class seqlock_bitmask
+    {
+        static_assert(bitmask_detail::is_bit_index_enum<T>::value,
+                      "Use atomic_bitmask for the bitmasks that fit in a single word");
+
+    public:
+        using value_type = bitmask<T>;
+        using word_type = typename value_type::word_type;
+
+        static constexpr std::size_t word_count = value_type::word_count;
+
+        seqlock_bitmask() = default;
+
+        explicit seqlock_bitmask(const value_type& v) noexcept
+        {
+            for (std::size_t i = 0; i != word_count; ++i)
+                m_words[i].store(v.word(i), std::memory_order_relaxed);
+        }
+
+        seqlock_bitmask(const seqlock_bitmask&) = delete;
+        seqlock_bitmask& operator = (const seqlock_bitmask&) = delete;
+
+        value_type load() const noexcept
+        {
+            value_type v;
+            for (;;)
+            {
+                const std::uint64_t seq = m_seq.load(std::memory_order_acquire);
+                if (!(seq & 1))
+                {
+                    for (std::size_t i = 0; i != word_count; ++i)
+                        v.data()[i] = m_words[i].load(std::memory_order_relaxed);
+                    if (validate(seq))
+                        return v;
+                }
+                bitmask_detail::cpu_relax();
+            }
+        }
+
+        // Reads a single flag. A single word is always consistent, so there is no need for the sequence number.
+        bool test(T index) const noexcept
+        {
+            const auto i = static_cast<std::size_t>(index);
+            return (m_words[i / value_type::word_bits].load(std::memory_order_acquire) >> (i % value_type::word_bits)) & 1;
+        }
+
+        void store(const value_type& v) noexcept
+        {
+            const std::uint64_t seq = lock();
+            for (std::size_t i = 0; i != word_count; ++i)
+                m_words[i].store(v.word(i), std::memory_order_relaxed);
+            unlock(seq);
+        }
+
+        // Calls `fn(value_type&)` on the current value with the writers locked out, stores the result
+        // and returns the previous value. Only the words that have changed are written.
+        template<class Fn>
+        value_type modify(Fn&& fn)
+        {
+            const std::uint64_t seq = lock();
+            value_type prev;
+            for (std::size_t i = 0; i != word_count; ++i)
+                prev.data()[i] = m_words[i].load(std::memory_order_relaxed);
+            value_type v = prev;
+            fn(v);
+            for (std::size_t i = 0; i != word_count; ++i)
+            {
+                if (v.word(i) != prev.word(i))
+                    m_words[i].store(v.word(i), std::memory_order_relaxed);
+            }
+            unlock(seq);
+            return prev;
+        }
+
+        // Sets the flags of `m` and returns the previous value
+        value_type fetch_or(const value_type& m) noexcept
+        {
+            return fetch_op(m, [](word_type a, word_type b) { return a | b; });
+        }
+
+        // Keeps only the flags of `m` and returns the previous value
+        value_type fetch_and(const value_type& m) noexcept
+        {
+            return fetch_op(m, [](word_type a, word_type b) { return a & b; });
+        }
+
+        // Number of the completed writes
+        std::uint64_t version() const noexcept { return m_seq.load(std::memory_order_acquire) / 2; }
+
+    private:
+        // Word by word, so the values are not copied around as a whole
+        template<class Op>
+        value_type fetch_op(const value_type& m, Op op) noexcept
+        {
+            const std::uint64_t seq = lock();
+            value_type prev;
+            for (std::size_t i = 0; i != word_count; ++i)
+            {
+                const word_type w = m_words[i].load(std::memory_order_relaxed);
+                prev.data()[i] = w;
+                m_words[i].store(op(w, m.word(i)), std::memory_order_relaxed);
+            }
+            unlock(seq);
+            return prev;
+        }
+
+        bool validate(std::uint64_t seq) const noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_seq.load(std::memory_order_relaxed) == seq;
+        }
+
+        std::uint64_t lock() noexcept
+        {
+            for (;;)
+            {
+                std::uint64_t seq = m_seq.load(std::memory_order_relaxed);
+                if (!(seq & 1) && m_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    // The word stores must not become visible before the odd sequence number
+                    std::atomic_thread_fence(std::memory_order_release);
+                    return seq;
+                }
+                bitmask_detail::cpu_relax();
+            }
+        }
+
+        void unlock(std::uint64_t seq) noexcept
+        {
+            m_seq.store(seq + 2, std::memory_order_release);
+        }
+
+        std::atomic<std::uint64_t> m_seq{0};
+        std::atomic<word_type> m_words[word_count] = {};
+    };
+
+    template<class T>
+    constexpr std::size_t seqlock_bitmask<T>::word_count;
+}
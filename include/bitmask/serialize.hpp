@@ -0,0 +1,460 @@
+#pragma once
+
+/*
+    Binary serialization
+    ====================
+
+    Encodings of `bitmask<T>` for the wire and the disk: fixed width little-endian, LEB128 varint and dense,
+    which keeps only the bits of the domain. Every encoding comes for a single value and for arrays of them.
+    Decoding checks the input and never produces a bitmask with bits out of the domain.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+#include "algorithm.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define BITMASK_DETAIL_BIG_ENDIAN 1
+#else
+#define BITMASK_DETAIL_BIG_ENDIAN 0
+#endif
+
+
+namespace bitmask {
+
+    enum class decode_error
+    {
+        none,
+        truncated,      // The input ends in the middle of a value
+        out_of_domain,  // The value has bits out of the domain
+        overlong,       // A varint is longer than the type or has redundant trailing bytes
+        bad_schema,     // The name dictionary of `schema.hpp` is malformed
+    };
+
+    template<class T>
+    struct decode_result
+    {
+        bitmask<T> value;
+        const unsigned char* next;  // Past the value on success, at the start of the value on failure
+        decode_error error;
+
+        explicit constexpr operator bool() const noexcept { return error == decode_error::none; }
+    };
+
+    struct bulk_decode_result
+    {
+        std::size_t count;           // Number of the values decoded
+        const unsigned char* next;   // Past the last value decoded, which is the start of the value that failed
+        decode_error error;
+
+        explicit constexpr operator bool() const noexcept { return error == decode_error::none; }
+    };
+
+    // Bytes of a value in the fixed width encoding
+    template<class T>
+    struct fixed_size : std::integral_constant<std::size_t, sizeof(bitmask_detail::underlying_type_t<T>)> {};
+
+    // Bytes of a value in the dense encoding: one bit per flag of the domain
+    template<class T>
+    struct dense_size : std::integral_constant<std::size_t, (flag_count<T>::value + 7) / 8> {};
+
+    // The most bytes of a value in the varint encoding
+    template<class T>
+    struct max_varint_size
+        : std::integral_constant<std::size_t, (std::numeric_limits<bitmask_detail::underlying_type_t<T>>::digits + 6) / 7> {};
+
+    namespace bitmask_detail {
+        template<class U>
+        inline U to_little_endian(U value) noexcept
+        {
+#if BITMASK_DETAIL_BIG_ENDIAN
+            U swapped = 0;
+            for (std::size_t i = 0; i != sizeof(U); ++i, value = static_cast<U>(value >> 8))
+                swapped = static_cast<U>((swapped << 8) | (value & 0xFFu));
+            return swapped;
+#else
+            return value;
+#endif
+        }
+
+        // Stores the first `size` bytes of the little-endian representation of `value`
+        template<class U>
+        inline unsigned char* store_le(unsigned char* out, U value, std::size_t size) noexcept
+        {
+            value = to_little_endian(value);
+            std::memcpy(out, &value, size);
+            return out + size;
+        }
+
+        template<class U>
+        inline U load_le(const unsigned char* in, std::size_t size) noexcept
+        {
+            U value = 0;
+            std::memcpy(&value, in, size);
+            return to_little_endian(value);
+        }
+
+        template<class T>
+        inline decode_result<T> decode_failure(const unsigned char* at, decode_error error) noexcept
+        {
+            return {bitmask<T>{}, at, error};
+        }
+
+        template<class T>
+        inline constexpr bool has_bits_out_of_domain(underlying_type_t<T> bits) noexcept
+        {
+            return (bits & ~bitmask<T>::mask_value) != 0;
+        }
+
+        template<class T>
+        inline void check_serializable() noexcept
+        {
+            static_assert(!is_bit_index_enum<T>::value, "Bit index bitmasks are not supported by the serialization");
+        }
+
+        // The dense encoding moves every run of adjacent bits of `Mask` down next to the previous one, the run
+        // lands at bit `Dense`. It's a shift and a mask per run, all known at compile time. It's what PEXT and
+        // PDEP do in a single instruction.
+        template<class U, U Mask, unsigned Dense = 0, bool = Mask == 0>
+        struct dense_runs
+        {
+            static constexpr unsigned low = static_cast<unsigned>(lowest_bit_index(Mask));
+            static constexpr U run = static_cast<U>(Mask & ~static_cast<U>(Mask + (U{1} << low)));
+            using next = dense_runs<U, static_cast<U>(Mask & ~run), Dense + static_cast<unsigned>(popcount(run))>;
+
+            static U extract(U bits) noexcept
+            {
+                return static_cast<U>(static_cast<U>((bits & run) >> (low - Dense)) | next::extract(bits));
+            }
+
+            static U deposit(U dense) noexcept
+            {
+                return static_cast<U>(static_cast<U>(static_cast<U>(dense << (low - Dense)) & run) | next::deposit(dense));
+            }
+        };
+
+        template<class U, U Mask, unsigned Dense>
+        struct dense_runs<U, Mask, Dense, true>
+        {
+            static U extract(U) noexcept { return 0; }
+            static U deposit(U) noexcept { return 0; }
+        };
+
+        template<class T>
+        using dense_runs_of = dense_runs<underlying_type_t<T>, bitmask<T>::mask_value>;
+
+        // The bits of the dense encoding that do not stand for a flag
+        template<class T>
+        struct dense_padding : std::integral_constant<underlying_type_t<T>,
+            flag_count<T>::value == static_cast<std::size_t>(std::numeric_limits<underlying_type_t<T>>::digits) ? 0
+                : static_cast<underlying_type_t<T>>(~((underlying_type_t<T>{1} << flag_count<T>::value) - 1u))> {};
+
+#if BITMASK_SIMD_X86
+        namespace bmi2 {
+            BITMASK_DETAIL_TARGET("bmi2")
+            inline std::uint64_t extract(std::uint64_t bits, std::uint64_t mask) noexcept { return _pext_u64(bits, mask); }
+
+            BITMASK_DETAIL_TARGET("bmi2")
+            inline std::uint64_t deposit(std::uint64_t dense, std::uint64_t mask) noexcept { return _pdep_u64(dense, mask); }
+        }
+#endif
+
+        // PEXT and PDEP when the code is compiled for BMI2, the runs otherwise
+        template<class T>
+        inline underlying_type_t<T> extract_dense(underlying_type_t<T> bits) noexcept
+        {
+#if BITMASK_SIMD_X86 && defined(__BMI2__)
+            return static_cast<underlying_type_t<T>>(bmi2::extract(bits, bitmask<T>::mask_value));
+#else
+            return dense_runs_of<T>::extract(bits);
+#endif
+        }
+
+        template<class T>
+        inline underlying_type_t<T> deposit_dense(underlying_type_t<T> dense) noexcept
+        {
+#if BITMASK_SIMD_X86 && defined(__BMI2__)
+            return static_cast<underlying_type_t<T>>(bmi2::deposit(dense, bitmask<T>::mask_value));
+#else
+            return dense_runs_of<T>::deposit(dense);
+#endif
+        }
+    }
+
+    // Fixed width encoding: the underlying value in little-endian byte order
+
+    template<class T>
+    inline unsigned char* encode_fixed(unsigned char* out, const bitmask<T>& m) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        return bitmask_detail::store_le(out, m.bits(), fixed_size<T>::value);
+    }
+
+    template<class T>
+    inline decode_result<T> decode_fixed(const unsigned char* in, const unsigned char* end) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        if (static_cast<std::size_t>(end - in) < fixed_size<T>::value)
+            return bitmask_detail::decode_failure<T>(in, decode_error::truncated);
+        const auto bits = bitmask_detail::load_le<bitmask_detail::underlying_type_t<T>>(in, fixed_size<T>::value);
+        if (bitmask_detail::has_bits_out_of_domain<T>(bits))
+            return bitmask_detail::decode_failure<T>(in, decode_error::out_of_domain);
+        return {bitmask_detail::to_enum<T>(bits), in + fixed_size<T>::value, decode_error::none};
+    }
+
+    // Varint encoding: LEB128, 7 bits per byte from the lowest with the high bit set on all the bytes but the last
+
+    template<class T>
+    inline unsigned char* encode_varint(unsigned char* out, const bitmask<T>& m) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        using underlying_type = bitmask_detail::underlying_type_t<T>;
+
+        underlying_type bits = m.bits();
+        for (; bits >= 0x80u; bits = static_cast<underlying_type>(bits >> 7))
+            *out++ = static_cast<unsigned char>(bits | 0x80u);
+        *out++ = static_cast<unsigned char>(bits);
+        return out;
+    }
+
+    template<class T>
+    inline decode_result<T> decode_varint(const unsigned char* in, const unsigned char* end) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        using underlying_type = bitmask_detail::underlying_type_t<T>;
+        const unsigned digits = static_cast<unsigned>(std::numeric_limits<underlying_type>::digits);
+
+        underlying_type bits = 0;
+        const unsigned char* p = in;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            if (p == end)
+                return bitmask_detail::decode_failure<T>(in, decode_error::truncated);
+            const unsigned char byte = *p++;
+            const auto payload = static_cast<underlying_type>(byte & 0x7Fu);
+            if (shift + 7 > digits && (payload >> (digits - shift)) != 0)
+                return bitmask_detail::decode_failure<T>(in, decode_error::out_of_domain);
+            bits = static_cast<underlying_type>(bits | static_cast<underlying_type>(payload << shift));
+            if (!(byte & 0x80u))
+            {
+                if (byte == 0 && shift != 0)
+                    return bitmask_detail::decode_failure<T>(in, decode_error::overlong);
+                break;
+            }
+            if (shift + 7 >= digits)
+                return bitmask_detail::decode_failure<T>(in, decode_error::overlong);
+        }
+        if (bitmask_detail::has_bits_out_of_domain<T>(bits))
+            return bitmask_detail::decode_failure<T>(in, decode_error::out_of_domain);
+        return {bitmask_detail::to_enum<T>(bits), p, decode_error::none};
+    }
+
+    // Dense encoding: bit `i` is the `i`-th flag of the domain (see `flag_index()`), `dense_size<T>::value` bytes in
+    // little-endian byte order. The domain of 9 flags spread over 32 bits takes 2 bytes.
+
+    template<class T>
+    inline unsigned char* encode_dense(unsigned char* out, const bitmask<T>& m) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        return bitmask_detail::store_le(out, bitmask_detail::extract_dense<T>(m.bits()), dense_size<T>::value);
+    }
+
+    template<class T>
+    inline decode_result<T> decode_dense(const unsigned char* in, const unsigned char* end) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        if (static_cast<std::size_t>(end - in) < dense_size<T>::value)
+            return bitmask_detail::decode_failure<T>(in, decode_error::truncated);
+        const auto dense = bitmask_detail::load_le<bitmask_detail::underlying_type_t<T>>(in, dense_size<T>::value);
+        if (dense & bitmask_detail::dense_padding<T>::value)
+            return bitmask_detail::decode_failure<T>(in, decode_error::out_of_domain);
+        return {bitmask_detail::to_enum<T>(bitmask_detail::deposit_dense<T>(dense)), in + dense_size<T>::value,
+                decode_error::none};
+    }
+
+    namespace bitmask_detail {
+        // Bulk kernels. The decoding ones stop at the first value that fails.
+
+        template<class T>
+        inline unsigned char* encode_dense_runs(unsigned char* out, const bitmask<T>* first, const bitmask<T>* last) noexcept
+        {
+            for (; first != last; ++first)
+                out = store_le(out, extract_dense<T>(first->bits()), dense_size<T>::value);
+            return out;
+        }
+
+        template<class T>
+        inline bulk_decode_result decode_dense_runs(const unsigned char* in, bitmask<T>* first, std::size_t n) noexcept
+        {
+            using underlying_type = underlying_type_t<T>;
+            for (std::size_t i = 0; i != n; ++i, in += dense_size<T>::value)
+            {
+                const auto dense = load_le<underlying_type>(in, dense_size<T>::value);
+                if (dense & dense_padding<T>::value)
+                    return {i, in, decode_error::out_of_domain};
+                first[i] = to_enum<T>(deposit_dense<T>(dense));
+            }
+            return {n, in, decode_error::none};
+        }
+
+#if BITMASK_SIMD_X86
+        namespace bmi2 {
+            template<class T>
+            BITMASK_DETAIL_TARGET("bmi2")
+            inline unsigned char* encode_dense(unsigned char* out, const bitmask<T>* first, const bitmask<T>* last) noexcept
+            {
+                for (; first != last; ++first)
+                    out = store_le(out, static_cast<underlying_type_t<T>>(extract(first->bits(), bitmask<T>::mask_value)),
+                                   dense_size<T>::value);
+                return out;
+            }
+
+            template<class T>
+            BITMASK_DETAIL_TARGET("bmi2")
+            inline bulk_decode_result decode_dense(const unsigned char* in, bitmask<T>* first, std::size_t n) noexcept
+            {
+                using underlying_type = underlying_type_t<T>;
+                for (std::size_t i = 0; i != n; ++i, in += dense_size<T>::value)
+                {
+                    const auto dense = load_le<underlying_type>(in, dense_size<T>::value);
+                    if (dense & dense_padding<T>::value)
+                        return {i, in, decode_error::out_of_domain};
+                    first[i] = to_enum<T>(static_cast<underlying_type>(deposit(dense, bitmask<T>::mask_value)));
+                }
+                return {n, in, decode_error::none};
+            }
+        }
+#endif
+
+        // Number of the whole values of `size` bytes in the input but not more than `n`
+        inline std::size_t values_available(const unsigned char* in, const unsigned char* end, std::size_t size,
+                                            std::size_t n) noexcept
+        {
+            const std::size_t available = size ? static_cast<std::size_t>(end - in) / size : n;
+            return available < n ? available : n;
+        }
+    }
+
+    // Bulk encoding and decoding of the ranges of bitmasks. The encoding functions return the end of the output.
+    // The decoding functions fill `[first, last)` and stop at the first value that fails, the elements from it on
+    // are left empty or untouched.
+
+    template<class T>
+    inline unsigned char* encode_fixed(unsigned char* out, const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        const std::size_t n = static_cast<std::size_t>(last - first);
+#if BITMASK_DETAIL_BIG_ENDIAN
+        for (std::size_t i = 0; i != n; ++i)
+            out = encode_fixed(out, first[i]);
+        return out;
+#else
+        std::memcpy(out, bitmask_detail::raw_bits(first), n * fixed_size<T>::value);
+        return out + n * fixed_size<T>::value;
+#endif
+    }
+
+    // Copies the values a chunk at a time and checks the whole chunk against the domain with a SIMD reduction
+    template<class T>
+    inline bulk_decode_result decode_fixed(const unsigned char* in, const unsigned char* end,
+                                           bitmask<T>* first, bitmask<T>* last) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        using underlying_type = bitmask_detail::underlying_type_t<T>;
+        const std::size_t size = fixed_size<T>::value;
+        const std::size_t chunk = 1024;
+
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        const std::size_t whole = bitmask_detail::values_available(in, end, size, n);
+        for (std::size_t i = 0; i < whole; i += chunk)
+        {
+            const std::size_t k = whole - i < chunk ? whole - i : chunk;
+#if BITMASK_DETAIL_BIG_ENDIAN
+            for (std::size_t j = 0; j != k; ++j)
+            {
+                const auto bits = bitmask_detail::load_le<underlying_type>(in + (i + j) * size, size);
+                std::memcpy(static_cast<void*>(first + i + j), &bits, size);
+            }
+#else
+            std::memcpy(static_cast<void*>(first + i), in + i * size, k * size);
+#endif
+            const underlying_type* bits = bitmask_detail::raw_bits(first + i);
+            if (bitmask_detail::has_bits_out_of_domain<T>(simd::reduce_or(bits, k)))
+            {
+                std::size_t j = 0;
+                while (!bitmask_detail::has_bits_out_of_domain<T>(bits[j]))
+                    ++j;
+                for (std::size_t l = j; l != k; ++l)
+                    first[i + l] = bitmask<T>{};
+                return {i + j, in + (i + j) * size, decode_error::out_of_domain};
+            }
+        }
+        return {whole, in + whole * size, whole == n ? decode_error::none : decode_error::truncated};
+    }
+
+    template<class T>
+    inline unsigned char* encode_varint(unsigned char* out, const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        for (; first != last; ++first)
+            out = encode_varint(out, *first);
+        return out;
+    }
+
+    template<class T>
+    inline bulk_decode_result decode_varint(const unsigned char* in, const unsigned char* end,
+                                            bitmask<T>* first, bitmask<T>* last) noexcept
+    {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            const decode_result<T> r = decode_varint<T>(in, end);
+            if (!r)
+                return {i, in, r.error};
+            first[i] = r.value;
+            in = r.next;
+        }
+        return {n, in, decode_error::none};
+    }
+
+    // Uses PEXT and PDEP if the CPU supports them even if the code is compiled for a target without them
+    template<class T>
+    inline unsigned char* encode_dense(unsigned char* out, const bitmask<T>* first, const bitmask<T>* last) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+#if BITMASK_SIMD_X86
+        if (simd::detected_cpu_features().bmi2)
+            return bitmask_detail::bmi2::encode_dense(out, first, last);
+#endif
+        return bitmask_detail::encode_dense_runs(out, first, last);
+    }
+
+    template<class T>
+    inline bulk_decode_result decode_dense(const unsigned char* in, const unsigned char* end,
+                                           bitmask<T>* first, bitmask<T>* last) noexcept
+    {
+        bitmask_detail::check_serializable<T>();
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        const std::size_t whole = bitmask_detail::values_available(in, end, dense_size<T>::value, n);
+        bulk_decode_result r;
+#if BITMASK_SIMD_X86
+        if (simd::detected_cpu_features().bmi2)
+            r = bitmask_detail::bmi2::decode_dense(in, first, whole);
+        else
+#endif
+            r = bitmask_detail::decode_dense_runs(in, first, whole);
+        if (r && whole != n)
+            r.error = decode_error::truncated;
+        return r;
+    }
+}
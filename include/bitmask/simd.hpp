@@ -0,0 +1,1200 @@
+#pragma once
+
+/*
+    Bitmask SIMD kernels
+    ====================
+
+    Explicitly vectorized (SSE2, AVX2 and AVX-512) kernels over arrays of 64 bit words
+    and the bit index bitmask operations built on top of them.
+    The instruction set is selected at run time with a portable scalar fallback.
+
+    Define `BITMASK_NO_SIMD` to disable the vectorized kernels.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "bitmask.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#if !defined(BITMASK_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define BITMASK_SIMD_X86 1
+#include <immintrin.h>
+#define BITMASK_DETAIL_TARGET(isa) __attribute__((target(isa)))
+#if !defined(__clang__)
+// GCC 12 reports the `_mm512_undefined_epi32()` that the AVX-512 shift and permute intrinsics pass to their builtins
+// as used uninitialized in every function they are inlined into
+#define BITMASK_DETAIL_AVX512_WARNINGS_BEGIN \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Wuninitialized\"") \
+    _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define BITMASK_DETAIL_AVX512_WARNINGS_END _Pragma("GCC diagnostic pop")
+#else
+#define BITMASK_DETAIL_AVX512_WARNINGS_BEGIN
+#define BITMASK_DETAIL_AVX512_WARNINGS_END
+#endif
+#else
+#define BITMASK_SIMD_X86 0
+#endif
+
+
+namespace bitmask {
+namespace simd {
+
+    enum class instruction_set
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512,
+    };
+
+    struct cpu_features
+    {
+        bool popcnt = false;
+        bool sse2 = false;
+        bool avx2 = false;
+        bool avx512 = false;            // AVX-512 F
+        bool avx512bw = false;
+        bool avx512_vpopcntdq = false;
+        bool bmi2 = false;              // PEXT and PDEP
+    };
+
+    namespace simd_detail {
+        inline cpu_features detect_cpu_features() noexcept
+        {
+            cpu_features f;
+#if BITMASK_SIMD_X86
+            __builtin_cpu_init();
+            f.popcnt = __builtin_cpu_supports("popcnt");
+            f.sse2 = __builtin_cpu_supports("sse2");
+            f.avx2 = __builtin_cpu_supports("avx2");
+            f.avx512 = __builtin_cpu_supports("avx512f");
+            f.avx512bw = f.avx512 && __builtin_cpu_supports("avx512bw");
+            f.avx512_vpopcntdq = f.avx512 && __builtin_cpu_supports("avx512vpopcntdq");
+            f.bmi2 = __builtin_cpu_supports("bmi2");
+#endif
+            return f;
+        }
+    }
+
+    // Features of the CPU the program runs on. Detected once.
+    inline const cpu_features& detected_cpu_features() noexcept
+    {
+        static const cpu_features features = simd_detail::detect_cpu_features();
+        return features;
+    }
+
+    // The widest instruction set supported by both the compiler and the CPU
+    inline instruction_set detected_instruction_set() noexcept
+    {
+        return detected_cpu_features().avx512 ? instruction_set::avx512
+            : detected_cpu_features().avx2 ? instruction_set::avx2
+            : detected_cpu_features().sse2 ? instruction_set::sse2
+            : instruction_set::scalar;
+    }
+
+    namespace simd_detail {
+        // Word operations. `andnot` is `~a & b` as the x86 instructions do.
+        struct op_and
+        {
+            static constexpr std::uint64_t identity() noexcept { return ~std::uint64_t{0}; }
+            static std::uint64_t scalar(std::uint64_t a, std::uint64_t b) noexcept { return a & b; }
+#if BITMASK_SIMD_X86
+            BITMASK_DETAIL_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_and_si128(a, b); }
+            BITMASK_DETAIL_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_and_si256(a, b); }
+            BITMASK_DETAIL_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_and_si512(a, b); }
+#endif
+        };
+
+        struct op_or
+        {
+            static constexpr std::uint64_t identity() noexcept { return 0; }
+            static std::uint64_t scalar(std::uint64_t a, std::uint64_t b) noexcept { return a | b; }
+#if BITMASK_SIMD_X86
+            BITMASK_DETAIL_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_or_si128(a, b); }
+            BITMASK_DETAIL_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_or_si256(a, b); }
+            BITMASK_DETAIL_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_or_si512(a, b); }
+#endif
+        };
+
+        struct op_xor
+        {
+            static constexpr std::uint64_t identity() noexcept { return 0; }
+            static std::uint64_t scalar(std::uint64_t a, std::uint64_t b) noexcept { return a ^ b; }
+#if BITMASK_SIMD_X86
+            BITMASK_DETAIL_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_xor_si128(a, b); }
+            BITMASK_DETAIL_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(a, b); }
+            BITMASK_DETAIL_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_xor_si512(a, b); }
+#endif
+        };
+
+        struct op_andnot
+        {
+            static std::uint64_t scalar(std::uint64_t a, std::uint64_t b) noexcept { return ~a & b; }
+#if BITMASK_SIMD_X86
+            BITMASK_DETAIL_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_andnot_si128(a, b); }
+            BITMASK_DETAIL_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_andnot_si256(a, b); }
+            // Ternary logic rather than `_mm512_andnot_si512`, that is built on `_mm512_undefined_epi32()` and warns in GCC 12
+            BITMASK_DETAIL_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_ternarylogic_epi64(a, b, b, 0x0C); }
+#endif
+        };
+
+        namespace scalar {
+            template<class Op>
+            inline void transform(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                for (std::size_t i = 0; i != n; ++i)
+                    dst[i] = Op::scalar(a[i], b[i]);
+            }
+
+            // Returns true if `Op(a, b)` is zero for all the words
+            template<class Op>
+            inline bool all_zero(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                std::uint64_t acc = 0;
+                for (std::size_t i = 0; i != n; ++i)
+                    acc |= Op::scalar(a[i], b[i]);
+                return acc == 0;
+            }
+
+            inline std::size_t popcount(const std::uint64_t* a, std::size_t n) noexcept
+            {
+                std::size_t result = 0;
+                for (std::size_t i = 0; i != n; ++i)
+                    result += static_cast<std::size_t>(bitmask_detail::popcount(a[i]));
+                return result;
+            }
+        }
+
+#if BITMASK_SIMD_X86
+        namespace popcnt {
+            BITMASK_DETAIL_TARGET("popcnt")
+            inline std::size_t popcount(const std::uint64_t* a, std::size_t n) noexcept
+            {
+                // Several accumulators break the dependency chain
+                std::uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+                std::size_t i = 0;
+                const std::size_t m = n & ~std::size_t{3};
+                for (; i < m; i += 4)
+                {
+                    c0 += static_cast<std::uint64_t>(__builtin_popcountll(a[i]));
+                    c1 += static_cast<std::uint64_t>(__builtin_popcountll(a[i + 1]));
+                    c2 += static_cast<std::uint64_t>(__builtin_popcountll(a[i + 2]));
+                    c3 += static_cast<std::uint64_t>(__builtin_popcountll(a[i + 3]));
+                }
+                for (; i < n; ++i)
+                    c0 += static_cast<std::uint64_t>(__builtin_popcountll(a[i]));
+                return static_cast<std::size_t>(c0 + c1 + c2 + c3);
+            }
+        }
+
+        namespace sse2 {
+            template<class Op>
+            BITMASK_DETAIL_TARGET("sse2")
+            inline void transform(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                std::size_t i = 0;
+                const std::size_t m = n & ~std::size_t{1};
+                for (; i < m; i += 2)
+                {
+                    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Op::sse2(va, vb));
+                }
+                for (; i < n; ++i)
+                    dst[i] = Op::scalar(a[i], b[i]);
+            }
+
+            template<class Op>
+            BITMASK_DETAIL_TARGET("sse2")
+            inline bool all_zero(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                __m128i acc = _mm_setzero_si128();
+                std::size_t i = 0;
+                const std::size_t m = n & ~std::size_t{1};
+                for (; i < m; i += 2)
+                {
+                    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                    acc = _mm_or_si128(acc, Op::sse2(va, vb));
+                }
+                std::uint64_t tail = 0;
+                for (; i < n; ++i)
+                    tail |= Op::scalar(a[i], b[i]);
+                return tail == 0 && _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) == 0xFFFF;
+            }
+        }
+
+        namespace avx2 {
+            template<class Op>
+            BITMASK_DETAIL_TARGET("avx2")
+            inline void transform(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                std::size_t i = 0;
+                const std::size_t m = n & ~std::size_t{3};
+                for (; i < m; i += 4)
+                {
+                    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Op::avx2(va, vb));
+                }
+                for (; i < n; ++i)
+                    dst[i] = Op::scalar(a[i], b[i]);
+            }
+
+            template<class Op>
+            BITMASK_DETAIL_TARGET("avx2")
+            inline bool all_zero(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                __m256i acc = _mm256_setzero_si256();
+                std::size_t i = 0;
+                const std::size_t m = n & ~std::size_t{3};
+                for (; i < m; i += 4)
+                {
+                    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                    acc = _mm256_or_si256(acc, Op::avx2(va, vb));
+                }
+                std::uint64_t tail = 0;
+                for (; i < n; ++i)
+                    tail |= Op::scalar(a[i], b[i]);
+                return tail == 0 && _mm256_testz_si256(acc, acc);
+            }
+
+            // Nibble lookup popcount (Mula, Kurz, Lemire "Faster Population Counts Using AVX2 Instructions")
+            BITMASK_DETAIL_TARGET("avx2")
+            inline __m256i popcount_bytes(__m256i v) noexcept
+            {
+                const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+                const __m256i low_mask = _mm256_set1_epi8(0x0F);
+                const __m256i lo = _mm256_and_si256(v, low_mask);
+                const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+                return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+            }
+
+            BITMASK_DETAIL_TARGET("avx2,popcnt")
+            inline std::size_t popcount(const std::uint64_t* a, std::size_t n) noexcept
+            {
+                __m256i acc = _mm256_setzero_si256();
+                std::size_t i = 0;
+                const std::size_t m = n & ~std::size_t{3};
+                for (; i < m; i += 4)
+                {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(popcount_bytes(v), _mm256_setzero_si256()));
+                }
+                std::uint64_t result = static_cast<std::uint64_t>(_mm256_extract_epi64(acc, 0))
+                    + static_cast<std::uint64_t>(_mm256_extract_epi64(acc, 1))
+                    + static_cast<std::uint64_t>(_mm256_extract_epi64(acc, 2))
+                    + static_cast<std::uint64_t>(_mm256_extract_epi64(acc, 3));
+                for (; i < n; ++i)
+                    result += static_cast<std::uint64_t>(__builtin_popcountll(a[i]));
+                return static_cast<std::size_t>(result);
+            }
+        }
+
+        namespace avx512 {
+            // The sum of the lanes. `_mm512_reduce_add_epi64` extracts the halves into `_mm256_undefined_si256()`
+            // that GCC 12 reports as used uninitialized wherever it is inlined.
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline std::uint64_t sum_lanes(__m512i v) noexcept
+            {
+                alignas(64) std::uint64_t lanes[8];
+                _mm512_store_si512(lanes, v);
+                return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+            }
+
+            template<class Op>
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline void transform(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                std::size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    _mm512_storeu_si512(dst + i, Op::avx512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+                if (i != n)
+                {
+                    // The tail is processed with masked loads and stores
+                    const __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+                    const __m512i va = _mm512_maskz_loadu_epi64(tail, a + i);
+                    const __m512i vb = _mm512_maskz_loadu_epi64(tail, b + i);
+                    _mm512_mask_storeu_epi64(dst + i, tail, Op::avx512(va, vb));
+                }
+            }
+
+            template<class Op>
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline bool all_zero(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+            {
+                __m512i acc = _mm512_setzero_si512();
+                std::size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    acc = _mm512_or_si512(acc, Op::avx512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+                if (i != n)
+                {
+                    const __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+                    const __m512i va = _mm512_maskz_loadu_epi64(tail, a + i);
+                    const __m512i vb = _mm512_maskz_loadu_epi64(tail, b + i);
+                    // Masked out lanes of `Op(va, vb)` may be non-zero (e.g. for `andnot`) so they are not tested
+                    acc = _mm512_mask_or_epi64(acc, tail, acc, Op::avx512(va, vb));
+                }
+                return _mm512_test_epi64_mask(acc, acc) == 0;
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f,avx512vpopcntdq")
+            inline std::size_t popcount(const std::uint64_t* a, std::size_t n) noexcept
+            {
+                __m512i acc = _mm512_setzero_si512();
+                std::size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(a + i)));
+                if (i != n)
+                {
+                    const __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+                    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(tail, a + i)));
+                }
+                return static_cast<std::size_t>(sum_lanes(acc));
+            }
+        }
+#endif
+
+        template<class Op>
+        inline void transform(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+        {
+#if BITMASK_SIMD_X86
+            switch (detected_instruction_set())
+            {
+                case instruction_set::avx512: return avx512::transform<Op>(dst, a, b, n);
+                case instruction_set::avx2: return avx2::transform<Op>(dst, a, b, n);
+                case instruction_set::sse2: return sse2::transform<Op>(dst, a, b, n);
+                case instruction_set::scalar: break;
+            }
+#endif
+            scalar::transform<Op>(dst, a, b, n);
+        }
+
+        template<class Op>
+        inline bool all_zero(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+        {
+#if BITMASK_SIMD_X86
+            switch (detected_instruction_set())
+            {
+                case instruction_set::avx512: return avx512::all_zero<Op>(a, b, n);
+                case instruction_set::avx2: return avx2::all_zero<Op>(a, b, n);
+                case instruction_set::sse2: return sse2::all_zero<Op>(a, b, n);
+                case instruction_set::scalar: break;
+            }
+#endif
+            return scalar::all_zero<Op>(a, b, n);
+        }
+    }
+
+    // Kernels over arrays of `n` 64 bit words. `dst` may be the same as any of the sources.
+
+    inline void and_words(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+    {
+        simd_detail::transform<simd_detail::op_and>(dst, a, b, n);
+    }
+
+    inline void or_words(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+    {
+        simd_detail::transform<simd_detail::op_or>(dst, a, b, n);
+    }
+
+    inline void xor_words(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+    {
+        simd_detail::transform<simd_detail::op_xor>(dst, a, b, n);
+    }
+
+    // `dst = ~a & mask`
+    inline void not_words(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* mask, std::size_t n) noexcept
+    {
+        simd_detail::transform<simd_detail::op_andnot>(dst, a, mask, n);
+    }
+
+    inline bool equal_words(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+    {
+        return simd_detail::all_zero<simd_detail::op_xor>(a, b, n);
+    }
+
+    // Returns true if all the bits set in `b` are set in `a`
+    inline bool contains_all_words(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+    {
+        return simd_detail::all_zero<simd_detail::op_andnot>(a, b, n);
+    }
+
+    inline std::size_t popcount_words(const std::uint64_t* a, std::size_t n) noexcept
+    {
+#if BITMASK_SIMD_X86
+        if (detected_cpu_features().avx512_vpopcntdq)
+            return simd_detail::avx512::popcount(a, n);
+        if (detected_cpu_features().avx2 && detected_cpu_features().popcnt)
+            return simd_detail::avx2::popcount(a, n);
+        if (detected_cpu_features().popcnt)
+            return simd_detail::popcnt::popcount(a, n);
+#endif
+        return simd_detail::scalar::popcount(a, n);
+    }
+
+    namespace simd_detail {
+        // Match kernels: set bit `i` of `bitmap` if `((x[i] & and_mask) == value) != negate`.
+        // Every kernel produces the bitmap words for 64 elements at a time, the tail is handled by `scalar::match`.
+        // The vector kernels access the elements through the intrinsics only, so `fixed_uint_t` pointers
+        // are used just to select the element width.
+
+        template<class U>
+        using fixed_uint_t = typename std::conditional<sizeof(U) == 1, std::uint8_t,
+            typename std::conditional<sizeof(U) == 2, std::uint16_t,
+            typename std::conditional<sizeof(U) == 4, std::uint32_t, std::uint64_t>::type>::type>::type;
+
+        namespace scalar {
+            template<class U>
+            inline std::uint64_t match_word(const U* x, std::size_t n, U and_mask, U value) noexcept
+            {
+                std::uint64_t word = 0;
+                for (std::size_t i = 0; i != n; ++i)
+                    word |= static_cast<std::uint64_t>((x[i] & and_mask) == value) << i;
+                return word;
+            }
+
+            template<class U>
+            inline void match(const U* x, std::size_t n, U and_mask, U value, bool negate, std::uint64_t* bitmap) noexcept
+            {
+                const std::uint64_t flip = negate ? ~std::uint64_t{0} : 0;
+                std::size_t i = 0;
+                for (; i + 64 <= n; i += 64)
+                    *bitmap++ = match_word(x + i, 64, and_mask, value) ^ flip;
+                if (i != n)
+                    *bitmap = (match_word(x + i, n - i, and_mask, value) ^ flip) & ((std::uint64_t{1} << (n - i)) - 1);
+            }
+        }
+
+#if BITMASK_SIMD_X86
+        namespace avx2 {
+            BITMASK_DETAIL_TARGET("avx2")
+            inline __m256i load_masked(const void* p, __m256i and_mask) noexcept
+            {
+                return _mm256_and_si256(_mm256_loadu_si256(static_cast<const __m256i*>(p)), and_mask);
+            }
+
+            BITMASK_DETAIL_TARGET("avx2")
+            inline std::uint64_t match_word(const std::uint8_t* x, __m256i and_mask, __m256i value) noexcept
+            {
+                const auto lo = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load_masked(x, and_mask), value)));
+                const auto hi = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load_masked(x + 32, and_mask), value)));
+                return lo | static_cast<std::uint64_t>(hi) << 32;
+            }
+
+            // Packs the 16 bit compare results of 32 elements into bytes and takes their sign bits
+            BITMASK_DETAIL_TARGET("avx2")
+            inline std::uint32_t match_half_word(const std::uint16_t* x, __m256i and_mask, __m256i value) noexcept
+            {
+                const __m256i c0 = _mm256_cmpeq_epi16(load_masked(x, and_mask), value);
+                const __m256i c1 = _mm256_cmpeq_epi16(load_masked(x + 16, and_mask), value);
+                // packs works within 128 bit lanes so the 64 bit quarters have to be put back in order
+                return static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                    _mm256_permute4x64_epi64(_mm256_packs_epi16(c0, c1), 0xD8)));
+            }
+
+            BITMASK_DETAIL_TARGET("avx2")
+            inline std::uint64_t match_word(const std::uint16_t* x, __m256i and_mask, __m256i value) noexcept
+            {
+                return match_half_word(x, and_mask, value)
+                    | static_cast<std::uint64_t>(match_half_word(x + 32, and_mask, value)) << 32;
+            }
+
+            BITMASK_DETAIL_TARGET("avx2")
+            inline std::uint64_t match_word(const std::uint32_t* x, __m256i and_mask, __m256i value) noexcept
+            {
+                std::uint64_t word = 0;
+                for (int i = 0; i != 8; ++i)
+                {
+                    const __m256i c = _mm256_cmpeq_epi32(load_masked(x + i * 8, and_mask), value);
+                    word |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(c)))) << (i * 8);
+                }
+                return word;
+            }
+
+            BITMASK_DETAIL_TARGET("avx2")
+            inline std::uint64_t match_word(const std::uint64_t* x, __m256i and_mask, __m256i value) noexcept
+            {
+                std::uint64_t word = 0;
+                for (int i = 0; i != 16; ++i)
+                {
+                    const __m256i c = _mm256_cmpeq_epi64(load_masked(x + i * 4, and_mask), value);
+                    word |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(c)))) << (i * 4);
+                }
+                return word;
+            }
+
+            BITMASK_DETAIL_TARGET("avx2") inline __m256i broadcast(std::uint8_t v) noexcept { return _mm256_set1_epi8(static_cast<char>(v)); }
+            BITMASK_DETAIL_TARGET("avx2") inline __m256i broadcast(std::uint16_t v) noexcept { return _mm256_set1_epi16(static_cast<short>(v)); }
+            BITMASK_DETAIL_TARGET("avx2") inline __m256i broadcast(std::uint32_t v) noexcept { return _mm256_set1_epi32(static_cast<int>(v)); }
+            BITMASK_DETAIL_TARGET("avx2") inline __m256i broadcast(std::uint64_t v) noexcept { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+
+            template<class U>
+            BITMASK_DETAIL_TARGET("avx2")
+            inline void match(const U* x, std::size_t n, U and_mask, U value, bool negate, std::uint64_t* bitmap) noexcept
+            {
+                const __m256i vmask = broadcast(static_cast<fixed_uint_t<U>>(and_mask));
+                const __m256i vvalue = broadcast(static_cast<fixed_uint_t<U>>(value));
+                const std::uint64_t flip = negate ? ~std::uint64_t{0} : 0;
+                std::size_t i = 0;
+                for (; i + 64 <= n; i += 64)
+                    *bitmap++ = match_word(reinterpret_cast<const fixed_uint_t<U>*>(x + i), vmask, vvalue) ^ flip;
+                scalar::match(x + i, n - i, and_mask, value, negate, bitmap);
+            }
+        }
+
+        namespace avx512 {
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw")
+            inline std::uint64_t match_word(const std::uint8_t* x, __m512i and_mask, __m512i value) noexcept
+            {
+                return _mm512_cmpeq_epi8_mask(_mm512_and_si512(_mm512_loadu_si512(x), and_mask), value);
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw")
+            inline std::uint64_t match_word(const std::uint16_t* x, __m512i and_mask, __m512i value) noexcept
+            {
+                return _mm512_cmpeq_epi16_mask(_mm512_and_si512(_mm512_loadu_si512(x), and_mask), value)
+                    | static_cast<std::uint64_t>(_mm512_cmpeq_epi16_mask(_mm512_and_si512(_mm512_loadu_si512(x + 32), and_mask), value)) << 32;
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw")
+            inline std::uint64_t match_word(const std::uint32_t* x, __m512i and_mask, __m512i value) noexcept
+            {
+                std::uint64_t word = 0;
+                for (int i = 0; i != 4; ++i)
+                    word |= static_cast<std::uint64_t>(_mm512_cmpeq_epi32_mask(_mm512_and_si512(_mm512_loadu_si512(x + i * 16), and_mask), value)) << (i * 16);
+                return word;
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw")
+            inline std::uint64_t match_word(const std::uint64_t* x, __m512i and_mask, __m512i value) noexcept
+            {
+                std::uint64_t word = 0;
+                for (int i = 0; i != 8; ++i)
+                    word |= static_cast<std::uint64_t>(_mm512_cmpeq_epi64_mask(_mm512_and_si512(_mm512_loadu_si512(x + i * 8), and_mask), value)) << (i * 8);
+                return word;
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw") inline __m512i broadcast(std::uint8_t v) noexcept { return _mm512_set1_epi8(static_cast<char>(v)); }
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw") inline __m512i broadcast(std::uint16_t v) noexcept { return _mm512_set1_epi16(static_cast<short>(v)); }
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw") inline __m512i broadcast(std::uint32_t v) noexcept { return _mm512_set1_epi32(static_cast<int>(v)); }
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw") inline __m512i broadcast(std::uint64_t v) noexcept { return _mm512_set1_epi64(static_cast<long long>(v)); }
+
+            template<class U>
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw")
+            inline void match(const U* x, std::size_t n, U and_mask, U value, bool negate, std::uint64_t* bitmap) noexcept
+            {
+                const __m512i vmask = broadcast(static_cast<fixed_uint_t<U>>(and_mask));
+                const __m512i vvalue = broadcast(static_cast<fixed_uint_t<U>>(value));
+                const std::uint64_t flip = negate ? ~std::uint64_t{0} : 0;
+                std::size_t i = 0;
+                for (; i + 64 <= n; i += 64)
+                    *bitmap++ = match_word(reinterpret_cast<const fixed_uint_t<U>*>(x + i), vmask, vvalue) ^ flip;
+                scalar::match(x + i, n - i, and_mask, value, negate, bitmap);
+            }
+        }
+#endif
+    }
+
+    namespace simd_detail {
+        // Reduction kernels: combine `acc` and all the `n` elements of `x` with `Op`.
+        // If `can_stop` is true the kernels return as soon as the result is equal to `stop` (checked once per chunk).
+        // The vector kernels treat the elements as a plain byte array and fold the vector lanes down to the element
+        // width in the end. It works because the operations are bitwise.
+
+        // Combines the halves of the 64 bit word with `Op` until it's down to `U`
+        template<class Op, class U>
+        inline U fold_word(std::uint64_t w) noexcept
+        {
+            for (std::size_t bits = 64; bits > sizeof(U) * 8; bits /= 2)
+                w = Op::scalar(w, w >> (bits / 2));
+            return static_cast<U>(w);
+        }
+
+        namespace scalar {
+            template<class Op, class U>
+            inline U reduce(const U* x, std::size_t n, U acc, U stop, bool can_stop) noexcept
+            {
+                const std::size_t chunk = 1024;
+                const U identity = static_cast<U>(Op::identity());
+
+                std::size_t i = 0;
+                while (i != n)
+                {
+                    const std::size_t end = n - i > chunk ? i + chunk : n;
+                    // Several accumulators break the dependency chain
+                    U a0 = identity, a1 = identity, a2 = identity, a3 = identity;
+                    for (; i + 4 <= end; i += 4)
+                    {
+                        a0 = static_cast<U>(Op::scalar(a0, x[i]));
+                        a1 = static_cast<U>(Op::scalar(a1, x[i + 1]));
+                        a2 = static_cast<U>(Op::scalar(a2, x[i + 2]));
+                        a3 = static_cast<U>(Op::scalar(a3, x[i + 3]));
+                    }
+                    for (; i != end; ++i)
+                        a0 = static_cast<U>(Op::scalar(a0, x[i]));
+
+                    acc = static_cast<U>(Op::scalar(acc, Op::scalar(Op::scalar(a0, a1), Op::scalar(a2, a3))));
+                    if (can_stop && acc == stop)
+                        return acc;
+                }
+                return acc;
+            }
+        }
+
+#if BITMASK_SIMD_X86
+        namespace avx2 {
+            template<class Op, class U>
+            BITMASK_DETAIL_TARGET("avx2")
+            inline U reduce(const U* x, std::size_t n, U acc, U stop, bool can_stop) noexcept
+            {
+                const std::size_t per_vector = 32 / sizeof(U);
+                const std::size_t chunk = per_vector * 64;  // 2 KiB
+                const __m256i identity = _mm256_set1_epi64x(static_cast<long long>(Op::identity()));
+
+                std::size_t i = 0;
+                for (; i + chunk <= n; i += chunk)
+                {
+                    __m256i a0 = identity, a1 = identity, a2 = identity, a3 = identity;
+                    for (std::size_t j = i; j != i + chunk; j += per_vector * 4)
+                    {
+                        a0 = Op::avx2(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j)));
+                        a1 = Op::avx2(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j + per_vector)));
+                        a2 = Op::avx2(a2, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j + per_vector * 2)));
+                        a3 = Op::avx2(a3, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j + per_vector * 3)));
+                    }
+
+                    alignas(32) std::uint64_t lanes[4];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), Op::avx2(Op::avx2(a0, a1), Op::avx2(a2, a3)));
+                    const std::uint64_t w = Op::scalar(Op::scalar(lanes[0], lanes[1]), Op::scalar(lanes[2], lanes[3]));
+                    acc = static_cast<U>(Op::scalar(acc, fold_word<Op, U>(w)));
+                    if (can_stop && acc == stop)
+                        return acc;
+                }
+                return scalar::reduce<Op>(x + i, n - i, acc, stop, can_stop);
+            }
+        }
+
+        namespace avx512 {
+            template<class Op, class U>
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline U reduce(const U* x, std::size_t n, U acc, U stop, bool can_stop) noexcept
+            {
+                const std::size_t per_vector = 64 / sizeof(U);
+                const std::size_t chunk = per_vector * 64;  // 4 KiB
+                const __m512i identity = _mm512_set1_epi64(static_cast<long long>(Op::identity()));
+
+                std::size_t i = 0;
+                for (; i + chunk <= n; i += chunk)
+                {
+                    __m512i a0 = identity, a1 = identity, a2 = identity, a3 = identity;
+                    for (std::size_t j = i; j != i + chunk; j += per_vector * 4)
+                    {
+                        a0 = Op::avx512(a0, _mm512_loadu_si512(x + j));
+                        a1 = Op::avx512(a1, _mm512_loadu_si512(x + j + per_vector));
+                        a2 = Op::avx512(a2, _mm512_loadu_si512(x + j + per_vector * 2));
+                        a3 = Op::avx512(a3, _mm512_loadu_si512(x + j + per_vector * 3));
+                    }
+
+                    alignas(64) std::uint64_t lanes[8];
+                    _mm512_store_si512(lanes, Op::avx512(Op::avx512(a0, a1), Op::avx512(a2, a3)));
+                    std::uint64_t w = lanes[0];
+                    for (int k = 1; k != 8; ++k)
+                        w = Op::scalar(w, lanes[k]);
+                    acc = static_cast<U>(Op::scalar(acc, fold_word<Op, U>(w)));
+                    if (can_stop && acc == stop)
+                        return acc;
+                }
+                return scalar::reduce<Op>(x + i, n - i, acc, stop, can_stop);
+            }
+        }
+#endif
+
+        template<class Op, class U>
+        inline U reduce(const U* x, std::size_t n, U acc, U stop, bool can_stop) noexcept
+        {
+            static_assert(std::is_unsigned<U>::value && 64 % sizeof(U) == 0, "U is not a fixed width unsigned integer type");
+#if BITMASK_SIMD_X86
+            switch (detected_instruction_set())
+            {
+                case instruction_set::avx512: return avx512::reduce<Op>(x, n, acc, stop, can_stop);
+                case instruction_set::avx2: return avx2::reduce<Op>(x, n, acc, stop, can_stop);
+                case instruction_set::sse2:
+                case instruction_set::scalar: break;
+            }
+#endif
+            return scalar::reduce<Op>(x, n, acc, stop, can_stop);
+        }
+    }
+
+    // Bitwise reductions of the `n` elements of `x`. The AND and OR ones return early once the result
+    // becomes zero and `stop` respectively.
+
+    template<class U>
+    inline U reduce_or(const U* x, std::size_t n, U stop = static_cast<U>(~U{0})) noexcept
+    {
+        return simd_detail::reduce<simd_detail::op_or>(x, n, U{0}, stop, true);
+    }
+
+    template<class U>
+    inline U reduce_and(const U* x, std::size_t n, U init = static_cast<U>(~U{0})) noexcept
+    {
+        return simd_detail::reduce<simd_detail::op_and>(x, n, init, U{0}, true);
+    }
+
+    template<class U>
+    inline U reduce_xor(const U* x, std::size_t n) noexcept
+    {
+        return simd_detail::reduce<simd_detail::op_xor>(x, n, U{0}, U{0}, false);
+    }
+
+    namespace simd_detail {
+        // Positional popcount kernels: add the number of elements that have bit `j` set to `counts[j]`
+        // for every bit `j` of `U`. Harley-Seal: blocks of 16 elements (vectors) go through a tree of carry-save adders,
+        // so only the bits carried out of the tree, each one standing for 16 set bits, are spread into the counters.
+        // The vector kernels view the elements as an array of 64 bit lanes where bit `p` of a lane is
+        // bit `p % (8 * sizeof(U))` of some element, and keep a vector of counters per lane bit.
+
+        namespace scalar {
+            // Adds `weight` to the counters of the bits set in `v`
+            template<class U>
+            inline void add_bit_counts(std::uint64_t* counts, U v, std::uint64_t weight) noexcept
+            {
+                for (; v; v = static_cast<U>(v & (v - 1u)))
+                    counts[bitmask_detail::lowest_bit_index(v)] += weight;
+            }
+
+            // Carry-save adder: `high:low` is the per bit sum of `a`, `b` and `c`
+            template<class U>
+            inline void csa(U& high, U& low, U a, U b, U c) noexcept
+            {
+                const U u = static_cast<U>(a ^ b);
+                high = static_cast<U>((a & b) | (u & c));
+                low = static_cast<U>(u ^ c);
+            }
+
+            template<class U>
+            inline void positional_popcount(const U* x, std::size_t n, std::uint64_t* counts) noexcept
+            {
+                U ones = 0, twos = 0, fours = 0, eights = 0;
+                U twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+
+                std::size_t i = 0;
+                for (; i + 16 <= n; i += 16)
+                {
+                    csa(twos_a, ones, ones, x[i], x[i + 1]);
+                    csa(twos_b, ones, ones, x[i + 2], x[i + 3]);
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, x[i + 4], x[i + 5]);
+                    csa(twos_b, ones, ones, x[i + 6], x[i + 7]);
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_a, fours, fours, fours_a, fours_b);
+                    csa(twos_a, ones, ones, x[i + 8], x[i + 9]);
+                    csa(twos_b, ones, ones, x[i + 10], x[i + 11]);
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, x[i + 12], x[i + 13]);
+                    csa(twos_b, ones, ones, x[i + 14], x[i + 15]);
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_b, fours, fours, fours_a, fours_b);
+                    csa(sixteens, eights, eights, eights_a, eights_b);
+                    add_bit_counts(counts, sixteens, 16);
+                }
+                add_bit_counts(counts, eights, 8);
+                add_bit_counts(counts, fours, 4);
+                add_bit_counts(counts, twos, 2);
+                add_bit_counts(counts, ones, 1);
+
+                for (; i != n; ++i)
+                    add_bit_counts(counts, x[i], 1);
+            }
+        }
+
+#if BITMASK_SIMD_X86
+        namespace avx2 {
+            BITMASK_DETAIL_TARGET("avx2")
+            inline void csa(__m256i& high, __m256i& low, __m256i a, __m256i b, __m256i c) noexcept
+            {
+                const __m256i u = _mm256_xor_si256(a, b);
+                high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+                low = _mm256_xor_si256(u, c);
+            }
+
+            // Adds the bits of `v` multiplied by `2^shift` to the counters of the 64 lane bits
+            BITMASK_DETAIL_TARGET("avx2")
+            inline void add_bit_counts(__m256i* counters, __m256i v, int shift) noexcept
+            {
+                const __m256i one = _mm256_set1_epi64x(1);
+                for (int p = 0; p != 64; ++p, v = _mm256_srli_epi64(v, 1))
+                    counters[p] = _mm256_add_epi64(counters[p], _mm256_slli_epi64(_mm256_and_si256(v, one), shift));
+            }
+
+            template<class U>
+            BITMASK_DETAIL_TARGET("avx2")
+            inline void positional_popcount(const U* x, std::size_t n, std::uint64_t* counts) noexcept
+            {
+                const std::size_t per_vector = 32 / sizeof(U);
+
+                __m256i counters[64];
+                for (auto& c : counters)
+                    c = _mm256_setzero_si256();
+
+                __m256i ones = _mm256_setzero_si256(), twos = ones, fours = ones, eights = ones;
+                __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+
+                std::size_t i = 0;
+                for (; i + per_vector * 16 <= n; i += per_vector * 16)
+                {
+                    const __m256i* v = reinterpret_cast<const __m256i*>(x + i);
+                    csa(twos_a, ones, ones, _mm256_loadu_si256(v), _mm256_loadu_si256(v + 1));
+                    csa(twos_b, ones, ones, _mm256_loadu_si256(v + 2), _mm256_loadu_si256(v + 3));
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, _mm256_loadu_si256(v + 4), _mm256_loadu_si256(v + 5));
+                    csa(twos_b, ones, ones, _mm256_loadu_si256(v + 6), _mm256_loadu_si256(v + 7));
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_a, fours, fours, fours_a, fours_b);
+                    csa(twos_a, ones, ones, _mm256_loadu_si256(v + 8), _mm256_loadu_si256(v + 9));
+                    csa(twos_b, ones, ones, _mm256_loadu_si256(v + 10), _mm256_loadu_si256(v + 11));
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, _mm256_loadu_si256(v + 12), _mm256_loadu_si256(v + 13));
+                    csa(twos_b, ones, ones, _mm256_loadu_si256(v + 14), _mm256_loadu_si256(v + 15));
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_b, fours, fours, fours_a, fours_b);
+                    csa(sixteens, eights, eights, eights_a, eights_b);
+                    add_bit_counts(counters, sixteens, 4);
+                }
+                add_bit_counts(counters, eights, 3);
+                add_bit_counts(counters, fours, 2);
+                add_bit_counts(counters, twos, 1);
+                add_bit_counts(counters, ones, 0);
+
+                for (std::size_t p = 0; p != 64; ++p)
+                {
+                    alignas(32) std::uint64_t lanes[4];
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counters[p]);
+                    counts[p % (8 * sizeof(U))] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+                }
+                scalar::positional_popcount(x + i, n - i, counts);
+            }
+        }
+
+        BITMASK_DETAIL_AVX512_WARNINGS_BEGIN
+        namespace avx512 {
+            // Ternary logic computes the carry (majority) and the sum (3-way XOR) with an instruction each
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline void csa(__m512i& high, __m512i& low, __m512i a, __m512i b, __m512i c) noexcept
+            {
+                high = _mm512_ternarylogic_epi64(a, b, c, 0xE8);
+                low = _mm512_ternarylogic_epi64(a, b, c, 0x96);
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline void add_bit_counts(__m512i* counters, __m512i v, unsigned shift) noexcept
+            {
+                const __m512i one = _mm512_set1_epi64(1);
+                for (int p = 0; p != 64; ++p, v = _mm512_srli_epi64(v, 1))
+                    counters[p] = _mm512_add_epi64(counters[p], _mm512_slli_epi64(_mm512_and_si512(v, one), shift));
+            }
+
+            template<class U>
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline void positional_popcount(const U* x, std::size_t n, std::uint64_t* counts) noexcept
+            {
+                const std::size_t per_vector = 64 / sizeof(U);
+
+                __m512i counters[64];
+                for (auto& c : counters)
+                    c = _mm512_setzero_si512();
+
+                __m512i ones = _mm512_setzero_si512(), twos = ones, fours = ones, eights = ones;
+                __m512i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+
+                std::size_t i = 0;
+                for (; i + per_vector * 16 <= n; i += per_vector * 16)
+                {
+                    const U* v = x + i;
+                    const std::size_t k = per_vector;
+                    csa(twos_a, ones, ones, _mm512_loadu_si512(v), _mm512_loadu_si512(v + k));
+                    csa(twos_b, ones, ones, _mm512_loadu_si512(v + k * 2), _mm512_loadu_si512(v + k * 3));
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, _mm512_loadu_si512(v + k * 4), _mm512_loadu_si512(v + k * 5));
+                    csa(twos_b, ones, ones, _mm512_loadu_si512(v + k * 6), _mm512_loadu_si512(v + k * 7));
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_a, fours, fours, fours_a, fours_b);
+                    csa(twos_a, ones, ones, _mm512_loadu_si512(v + k * 8), _mm512_loadu_si512(v + k * 9));
+                    csa(twos_b, ones, ones, _mm512_loadu_si512(v + k * 10), _mm512_loadu_si512(v + k * 11));
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, _mm512_loadu_si512(v + k * 12), _mm512_loadu_si512(v + k * 13));
+                    csa(twos_b, ones, ones, _mm512_loadu_si512(v + k * 14), _mm512_loadu_si512(v + k * 15));
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_b, fours, fours, fours_a, fours_b);
+                    csa(sixteens, eights, eights, eights_a, eights_b);
+                    add_bit_counts(counters, sixteens, 4);
+                }
+                add_bit_counts(counters, eights, 3);
+                add_bit_counts(counters, fours, 2);
+                add_bit_counts(counters, twos, 1);
+                add_bit_counts(counters, ones, 0);
+
+                for (std::size_t p = 0; p != 64; ++p)
+                    counts[p % (8 * sizeof(U))] += sum_lanes(counters[p]);
+                scalar::positional_popcount(x + i, n - i, counts);
+            }
+        }
+        BITMASK_DETAIL_AVX512_WARNINGS_END
+#endif
+    }
+
+    // Positional popcount: adds the number of the elements of `x` that have bit `j` set to `counts[j]`
+    // for every bit of `U`. `counts` must have `8 * sizeof(U)` elements. `U` is any of the fixed width
+    // unsigned integer types.
+    template<class U>
+    inline void positional_popcount(const U* x, std::size_t n, std::uint64_t* counts) noexcept
+    {
+        static_assert(std::is_unsigned<U>::value && (sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4 || sizeof(U) == 8),
+                      "U is not a fixed width unsigned integer type");
+#if BITMASK_SIMD_X86
+        if (detected_cpu_features().avx512)
+            return simd_detail::avx512::positional_popcount(x, n, counts);
+        if (detected_cpu_features().avx2)
+            return simd_detail::avx2::positional_popcount(x, n, counts);
+#endif
+        simd_detail::scalar::positional_popcount(x, n, counts);
+    }
+
+    namespace simd_detail {
+        // Bit matrix transpose kernels for blocks of 64 rows. `slices[j]` gets bit `i` set if row `i` has bit `j` set,
+        // so every slice is a bitmap word of the 64 rows. Transposing back gives the rows again.
+
+        namespace scalar {
+            // In place transpose of the 64x64 bit matrix where `a[i]` bit `j` is element (i, j).
+            // Swaps the off-diagonal blocks of 32x32, then 16x16 ones within them and so on.
+            inline void transpose_64x64(std::uint64_t* a) noexcept
+            {
+                std::uint64_t m = 0x00000000FFFFFFFFull;
+                for (unsigned j = 32; j != 0; j >>= 1, m ^= m << j)
+                {
+                    for (unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j)
+                    {
+                        const std::uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+                        a[k] ^= t << j;
+                        a[k | j] ^= t;
+                    }
+                }
+            }
+        }
+
+#if BITMASK_SIMD_X86
+        namespace avx2 {
+            // 8 bit rows: a byte shift puts bit `j` of every byte into its top bit and `movemask` collects them
+            BITMASK_DETAIL_TARGET("avx2")
+            inline void bit_slice_8(const std::uint8_t* rows, std::uint64_t* slices) noexcept
+            {
+                const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows));
+                const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + 32));
+                for (int j = 0; j != 8; ++j)
+                {
+                    const auto l = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi64(lo, 7 - j)));
+                    const auto h = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi64(hi, 7 - j)));
+                    slices[j] = l | (static_cast<std::uint64_t>(h) << 32);
+                }
+            }
+        }
+
+        BITMASK_DETAIL_AVX512_WARNINGS_BEGIN
+        namespace avx512 {
+            BITMASK_DETAIL_TARGET("avx512f,avx512bw")
+            inline void bit_slice_8(const std::uint8_t* rows, std::uint64_t* slices) noexcept
+            {
+                const __m512i v = _mm512_loadu_si512(rows);
+                for (int j = 0; j != 8; ++j)
+                    slices[j] = _mm512_movepi8_mask(_mm512_slli_epi64(v, 7 - j));
+            }
+
+            // One step of `scalar::transpose_64x64` for the rows `j` apart that are in different vectors
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline void transpose_swap(__m512i& a, __m512i& b, unsigned j, __m512i m) noexcept
+            {
+                const __m512i t = _mm512_and_si512(_mm512_xor_si512(_mm512_srli_epi64(a, j), b), m);
+                a = _mm512_xor_si512(a, _mm512_slli_epi64(t, j));
+                b = _mm512_xor_si512(b, t);
+            }
+
+            // Same for the rows within a vector: `partner` holds the rows `j` apart and `high` selects the second row
+            // of every pair
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline __m512i transpose_swap_lanes(__m512i a, __m512i partner, unsigned j, __m512i m, __mmask8 high) noexcept
+            {
+                const __m512i t_low = _mm512_and_si512(_mm512_xor_si512(_mm512_srli_epi64(a, j), partner), m);
+                const __m512i t_high = _mm512_and_si512(_mm512_xor_si512(_mm512_srli_epi64(partner, j), a), m);
+                return _mm512_mask_blend_epi64(high, _mm512_xor_si512(a, _mm512_slli_epi64(t_low, j)),
+                                               _mm512_xor_si512(a, t_high));
+            }
+
+            BITMASK_DETAIL_TARGET("avx512f")
+            inline void transpose_64x64(std::uint64_t* a) noexcept
+            {
+                __m512i r[8];
+                for (int i = 0; i != 8; ++i)
+                    r[i] = _mm512_loadu_si512(a + i * 8);
+
+                const __m512i m32 = _mm512_set1_epi64(0x00000000FFFFFFFFll);
+                for (int i = 0; i != 4; ++i)
+                    transpose_swap(r[i], r[i + 4], 32, m32);
+
+                const __m512i m16 = _mm512_set1_epi64(0x0000FFFF0000FFFFll);
+                for (int i : {0, 1, 4, 5})
+                    transpose_swap(r[i], r[i + 2], 16, m16);
+
+                const __m512i m8 = _mm512_set1_epi64(0x00FF00FF00FF00FFll);
+                for (int i = 0; i != 8; i += 2)
+                    transpose_swap(r[i], r[i + 1], 8, m8);
+
+                const __m512i m4 = _mm512_set1_epi64(0x0F0F0F0F0F0F0F0Fll);
+                const __m512i m2 = _mm512_set1_epi64(0x3333333333333333ll);
+                const __m512i m1 = _mm512_set1_epi64(0x5555555555555555ll);
+                for (int i = 0; i != 8; ++i)
+                {
+                    __m512i v = r[i];
+                    v = transpose_swap_lanes(v, _mm512_shuffle_i64x2(v, v, _MM_SHUFFLE(1, 0, 3, 2)), 4, m4, 0xF0);
+                    v = transpose_swap_lanes(v, _mm512_permutex_epi64(v, _MM_SHUFFLE(1, 0, 3, 2)), 2, m2, 0xCC);
+                    v = transpose_swap_lanes(v, _mm512_permutex_epi64(v, _MM_SHUFFLE(2, 3, 0, 1)), 1, m1, 0xAA);
+                    _mm512_storeu_si512(a + i * 8, v);
+                }
+            }
+        }
+        BITMASK_DETAIL_AVX512_WARNINGS_END
+#endif
+
+        inline void transpose_64x64(std::uint64_t* a) noexcept
+        {
+#if BITMASK_SIMD_X86
+            if (detected_cpu_features().avx512)
+                return avx512::transpose_64x64(a);
+#endif
+            scalar::transpose_64x64(a);
+        }
+    }
+
+    // Bit slices of a block of `n <= 64` rows: `slices[j]` bit `i` is set if `rows[i]` has bit `j` set.
+    // `slices` must have `8 * sizeof(U)` words. `U` is any of the fixed width unsigned integer types.
+    template<class U>
+    inline void bit_slice(const U* rows, std::size_t n, std::uint64_t* slices) noexcept
+    {
+        static_assert(std::is_unsigned<U>::value && (sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4 || sizeof(U) == 8),
+                      "U is not a fixed width unsigned integer type");
+        assert(n <= 64);
+
+#if BITMASK_SIMD_X86
+        if (sizeof(U) == 1 && n == 64)
+        {
+            if (detected_cpu_features().avx512bw)
+                return simd_detail::avx512::bit_slice_8(reinterpret_cast<const std::uint8_t*>(rows), slices);
+            if (detected_cpu_features().avx2)
+                return simd_detail::avx2::bit_slice_8(reinterpret_cast<const std::uint8_t*>(rows), slices);
+        }
+#endif
+        std::uint64_t a[64];
+        std::size_t i = 0;
+        for (; i != n; ++i)
+            a[i] = rows[i];
+        for (; i != 64; ++i)
+            a[i] = 0;
+        simd_detail::transpose_64x64(a);
+        for (std::size_t j = 0; j != 8 * sizeof(U); ++j)
+            slices[j] = a[j];
+    }
+
+    // Reverse of `bit_slice()`: restores `n <= 64` rows from their `8 * sizeof(U)` bit slices
+    template<class U>
+    inline void bit_unslice(const std::uint64_t* slices, U* rows, std::size_t n) noexcept
+    {
+        static_assert(std::is_unsigned<U>::value && (sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4 || sizeof(U) == 8),
+                      "U is not a fixed width unsigned integer type");
+        assert(n <= 64);
+
+        std::uint64_t a[64];
+        std::size_t j = 0;
+        for (; j != 8 * sizeof(U); ++j)
+            a[j] = slices[j];
+        for (; j != 64; ++j)
+            a[j] = 0;
+        simd_detail::transpose_64x64(a);
+        for (std::size_t i = 0; i != n; ++i)
+            rows[i] = static_cast<U>(a[i]);
+    }
+
+    // Number of the bitmap words for `n` elements
+    inline constexpr std::size_t bitmap_words(std::size_t n) noexcept { return (n + 63) / 64; }
+
+    // Appends the indices of the bits set in the `words` words of `bitmap` to `indices`
+    template<class Container>
+    inline void append_bitmap_indices(const std::uint64_t* bitmap, std::size_t words, Container& indices)
+    {
+        for (std::size_t i = 0; i != words; ++i)
+        {
+            for (std::uint64_t w = bitmap[i]; w; w &= w - 1)
+                indices.push_back(i * 64 + static_cast<std::size_t>(bitmask_detail::lowest_bit_index(w)));
+        }
+    }
+
+    // Sets bit `i` of `bitmap` if `((x[i] & and_mask) == value) != negate` and clears it otherwise.
+    // `bitmap` must have `bitmap_words(n)` words. `U` is any of the fixed width unsigned integer types.
+    template<class U>
+    inline void match(const U* x, std::size_t n, U and_mask, U value, bool negate, std::uint64_t* bitmap) noexcept
+    {
+        static_assert(std::is_unsigned<U>::value && (sizeof(U) == 1 || sizeof(U) == 2 || sizeof(U) == 4 || sizeof(U) == 8),
+                      "U is not a fixed width unsigned integer type");
+#if BITMASK_SIMD_X86
+        if (detected_cpu_features().avx512bw)
+            return simd_detail::avx512::match(x, n, and_mask, value, negate, bitmap);
+        if (detected_cpu_features().avx2)
+            return simd_detail::avx2::match(x, n, and_mask, value, negate, bitmap);
+#endif
+        simd_detail::scalar::match(x, n, and_mask, value, negate, bitmap);
+    }
+
+    // Bit index bitmask operations (see `BITMASK_DEFINE_BIT_INDEX`) that use the kernels above.
+    // Unlike the bitmask operators they are not `constexpr`.
+    //
+    // There are no kernel based `&`, `|`, `^` and `~` for a single bitmask: the operators are expanded inline over
+    // the words and the compiler vectorizes them, a kernel call only adds the dispatch cost. Use the word
+    // array kernels to process many words at once.
+
+    namespace simd_detail {
+        // Minimal number of words for which the kernel is faster than the inline expansion
+        constexpr std::size_t min_kernel_words = 16;
+    }
+
+    template<class T>
+    inline bool equal(const bitmask<T>& l, const bitmask<T>& r) noexcept
+    {
+        return bitmask<T>::word_count < simd_detail::min_kernel_words ? l == r
+            : equal_words(l.data(), r.data(), bitmask<T>::word_count);
+    }
+
+    template<class T>
+    inline bool contains_all(const bitmask<T>& l, const bitmask<T>& r) noexcept
+    {
+        return bitmask<T>::word_count < simd_detail::min_kernel_words ? l.contains_all(r)
+            : contains_all_words(l.data(), r.data(), bitmask<T>::word_count);
+    }
+
+    // Unlike `bitmask<T>::count()` uses POPCNT (or its vector counterparts) if the CPU supports it
+    // even if the code is compiled for a target without it.
+    template<class T>
+    inline std::size_t count(const bitmask<T>& op) noexcept
+    {
+        return popcount_words(op.data(), bitmask<T>::word_count);
+    }
+}
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+/*
+    Bitmask sliced index
+    ====================
+
+    `bitmask_sliced_index<T>` keeps a column of `bitmask<T>` as one bitmap per flag (bit slices), so a predicate reads
+    only the slices of the flags it mentions.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "algorithm.hpp"
+#include "bitmask.hpp"
+#include "bitmask_vector.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace bitmask {
+
+    template<class T>
+    class bitmask_sliced_index
+    {
+    public:
+        using value_type = bitmask<T>;
+        using underlying_type = typename bitmask<T>::underlying_type;
+        using size_type = std::size_t;
+
+        static_assert(!bitmask_detail::is_bit_index_enum<T>::value, "Bit index bitmasks are not supported");
+
+        // One slice per flag of the domain, ordered by `flag_index()`
+        static constexpr std::size_t slice_count = flag_count<T>::value;
+
+        bitmask_sliced_index() = default;
+
+        bitmask_sliced_index(const value_type* first, const value_type* last)
+        {
+            build(bitmask_detail::raw_bits(first), static_cast<size_type>(last - first));
+        }
+
+        explicit bitmask_sliced_index(const bitmask_vector<T>& v)
+        {
+            build(v.data(), v.size());
+        }
+
+        // Number of the rows
+        size_type size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        // Number of the words in every slice and selection bitmap
+        size_type slice_words() const noexcept { return simd::bitmap_words(m_size); }
+
+        // Bitmap of the rows that have `flag` set
+        const std::uint64_t* slice(T flag) const noexcept { return slice_at(flag_index(flag)); }
+
+        value_type operator [] (size_type row) const noexcept
+        {
+            underlying_type bits = 0;
+            std::size_t i = 0;
+            for (underlying_type m = value_type::mask_value; m; m = static_cast<underlying_type>(m & (m - 1u)), ++i)
+            {
+                if ((slice_at(i)[row / 64] >> (row % 64)) & 1u)
+                    bits = static_cast<underlying_type>(bits | (m & (0u - m)));
+            }
+            return bitmask_detail::to_enum<T>(bits);
+        }
+
+        // Rows that have all the bits of `must` and none of the bits of `must_not` set
+        std::vector<std::uint64_t> filter(const value_type& must, const value_type& must_not) const
+        {
+            const size_type words = slice_words();
+            std::vector<std::uint64_t> result(words);
+
+            // The result is built by tiles that stay in the L1 cache while the slices stream through
+            const size_type tile = 2048;
+            for (size_type begin = 0; begin < words; begin += tile)
+            {
+                const size_type n = (std::min)(tile, words - begin);
+                std::uint64_t* dst = result.data() + begin;
+
+                auto it = must.begin();
+                if (it != must.end())
+                {
+                    std::copy(slice(*it) + begin, slice(*it) + begin + n, dst);
+                    for (++it; it != must.end(); ++it)
+                        simd::and_words(dst, dst, slice(*it) + begin, n);
+                }
+                else
+                {
+                    std::fill(dst, dst + n, ~std::uint64_t{0});
+                }
+
+                for (T flag : must_not)
+                    simd::not_words(dst, slice(flag) + begin, dst, n);
+            }
+
+            clear_tail(result);
+            return result;
+        }
+
+        // Rows that have any of the bits of `m` set
+        std::vector<std::uint64_t> filter_any(const value_type& m) const
+        {
+            const size_type words = slice_words();
+            std::vector<std::uint64_t> result(words);
+
+            const size_type tile = 2048;
+            for (size_type begin = 0; begin < words; begin += tile)
+            {
+                const size_type n = (std::min)(tile, words - begin);
+                for (T flag : m)
+                    simd::or_words(result.data() + begin, result.data() + begin, slice(flag) + begin, n);
+            }
+            return result;
+        }
+
+        // Rows that have all the bits of `m` set
+        std::vector<std::uint64_t> filter_all(const value_type& m) const { return filter(m, value_type{}); }
+
+        // Rows that have none of the bits of `m` set
+        std::vector<std::uint64_t> filter_none(const value_type& m) const { return filter(value_type{}, m); }
+
+        // Rows equal to `m`
+        std::vector<std::uint64_t> filter_equal(const value_type& m) const { return filter(m, ~m); }
+
+        std::vector<size_type> filter_indices(const value_type& must, const value_type& must_not) const { return indices(filter(must, must_not)); }
+        std::vector<size_type> filter_any_indices(const value_type& m) const { return indices(filter_any(m)); }
+        std::vector<size_type> filter_all_indices(const value_type& m) const { return indices(filter_all(m)); }
+        std::vector<size_type> filter_none_indices(const value_type& m) const { return indices(filter_none(m)); }
+        std::vector<size_type> filter_equal_indices(const value_type& m) const { return indices(filter_equal(m)); }
+
+        // Rebuilds the rows `[first, first + n)` into `out`
+        void materialize(size_type first, size_type n, value_type* out) const
+        {
+            underlying_type rows[64];
+            const size_type last = first + n;
+            while (first != last)
+            {
+                const size_type word = first / 64;
+                const size_type block_end = (std::min)((word + 1) * 64, last);
+                unslice(word, rows);
+                for (; first != block_end; ++first)
+                    *out++ = bitmask_detail::to_enum<T>(rows[first % 64]);
+            }
+        }
+
+        // Rebuilds the rows selected by `bitmap` that has `slice_words()` words, e.g. a result of `filter()`
+        std::vector<value_type> materialize(const std::vector<std::uint64_t>& bitmap) const
+        {
+            std::vector<value_type> result;
+            result.reserve(simd::popcount_words(bitmap.data(), bitmap.size()));
+
+            underlying_type rows[64];
+            for (size_type word = 0; word != bitmap.size(); ++word)
+            {
+                std::uint64_t selected = bitmap[word];
+                if (!selected)
+                    continue;
+                unslice(word, rows);
+                for (; selected; selected &= selected - 1)
+                    result.push_back(bitmask_detail::to_enum<T>(rows[bitmask_detail::lowest_bit_index(selected)]));
+            }
+            return result;
+        }
+
+    private:
+        static constexpr std::size_t bits_count = std::numeric_limits<underlying_type>::digits;
+
+        const std::uint64_t* slice_at(std::size_t i) const noexcept { return m_slices.data() + i * m_stride; }
+
+        void build(const underlying_type* rows, size_type n)
+        {
+            m_size = n;
+            // Every slice starts at a cache line
+            m_stride = (slice_words() + 7) / 8 * 8;
+            m_slices.assign(slice_count * m_stride, 0);
+
+            // Slices a cache line (8 words) of every slice at a time so the stores don't scatter across the slices
+            const size_type words = slice_words();
+            std::uint64_t bits[8][bits_count];
+            for (size_type first_word = 0; first_word < words; first_word += 8)
+            {
+                const size_type line_words = (std::min)(size_type{8}, words - first_word);
+                for (size_type k = 0; k != line_words; ++k)
+                {
+                    const size_type row = (first_word + k) * 64;
+                    simd::bit_slice(rows + row, (std::min)(size_type{64}, n - row), bits[k]);
+                }
+
+                std::size_t i = 0;
+                for (underlying_type m = value_type::mask_value; m; m = static_cast<underlying_type>(m & (m - 1u)))
+                {
+                    const int bit = bitmask_detail::lowest_bit_index(m);
+                    std::uint64_t* dst = m_slices.data() + i++ * m_stride + first_word;
+                    for (size_type k = 0; k != line_words; ++k)
+                        dst[k] = bits[k][bit];
+                }
+            }
+        }
+
+        // Rebuilds the 64 rows of the slice word `word`. The rows past `size()` are zero.
+        void unslice(size_type word, underlying_type* rows) const noexcept
+        {
+            std::uint64_t bits[bits_count] = {};
+            std::size_t i = 0;
+            for (underlying_type m = value_type::mask_value; m; m = static_cast<underlying_type>(m & (m - 1u)))
+                bits[bitmask_detail::lowest_bit_index(m)] = slice_at(i++)[word];
+            simd::bit_unslice(bits, rows, 64);
+        }
+
+        void clear_tail(std::vector<std::uint64_t>& bitmap) const noexcept
+        {
+            if (m_size % 64)
+                bitmap.back() &= (std::uint64_t{1} << (m_size % 64)) - 1;
+        }
+
+        static std::vector<size_type> indices(const std::vector<std::uint64_t>& bitmap)
+        {
+            std::vector<size_type> result;
+            result.reserve(simd::popcount_words(bitmap.data(), bitmap.size()));
+            simd::append_bitmap_indices(bitmap.data(), bitmap.size(), result);
+            return result;
+        }
+
+        size_type m_size = 0;
+        size_type m_stride = 0;
+        std::vector<std::uint64_t, bitmask_detail::aligned_allocator<std::uint64_t, 64>> m_slices;
+    };
+
+    template<class T>
+    constexpr std::size_t bitmask_sliced_index<T>::slice_count;
+
+    template<class T>
+    constexpr std::size_t bitmask_sliced_index<T>::bits_count;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+/*
+    Slot allocator
+    ==============
+
+    `slot_allocator` hands out slot indices `[0, capacity)` to many threads at once. It's a bitmap of the taken
+    slots in atomic 64 bit words.
+
+    Part of the Bitmask library: https://github.com/oliora/bitmask
+
+    Distributed under the Boost Software License, Version 1.0.
+    See http://www.boost.org/LICENSE_1_0.txt
+ */
+
+#include "atomic.hpp"
+#include "bitmask.hpp"
+#include "bitmask_vector.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace bitmask {
+
+    namespace bitmask_detail {
+        // A template, so the constant needs no definition in a translation unit
+        template<class = void>
+        struct slot_allocator_constants
+        {
+            static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        };
+
+        template<class D>
+        constexpr std::size_t slot_allocator_constants<D>::npos;
+    }
+
+    // A slot is acquired by finding a zero bit in a word and setting it with a CAS; release clears it.
+    // Optionally a summary bit per word tells that the word is full, so a search skips 64 full words
+    // at once. The summary is a hint: it's set after a word gets full and cleared after a slot of a full word is
+    // released, and every update is rechecked against the word. If the search by the summary fails, all the words
+    // are scanned before reporting that there are no free slots.
+    //
+    // Every thread starts its search at its own hint (threads are spread over the hints round robin), which is
+    // the word it has last acquired a slot in, so the threads tend to work in different words.
+    class slot_allocator: public bitmask_detail::slot_allocator_constants<>
+    {
+    public:
+        explicit slot_allocator(std::size_t capacity, bool use_summary = true)
+            : m_capacity(capacity)
+            , m_words((capacity + 63) / 64)
+            , m_summary(use_summary ? (m_words.size() + 63) / 64 : 0)
+            , m_hints(hint_count())
+        {
+            // The bits past the capacity are permanently taken
+            if (capacity % 64)
+                m_words.back().store(~std::uint64_t{0} << (capacity % 64), std::memory_order_relaxed);
+            if (!m_summary.empty() && m_words.size() % 64)
+                m_summary.back().store(~std::uint64_t{0} << (m_words.size() % 64), std::memory_order_relaxed);
+            for (std::size_t i = 0; i != m_hints.size(); ++i)
+                m_hints[i].word.store(i * m_words.size() / m_hints.size(), std::memory_order_relaxed);
+        }
+
+        slot_allocator(const slot_allocator&) = delete;
+        slot_allocator& operator = (const slot_allocator&) = delete;
+
+        std::size_t capacity() const noexcept { return m_capacity; }
+
+        // Acquires a free slot and returns its index or `npos` if there are no free slots
+        std::size_t acquire() noexcept
+        {
+            std::size_t slot = npos;
+            acquire_n(1, &slot);
+            return slot;
+        }
+
+        // Acquires up to `n` free slots, taking several slots of a word with a single CAS, and stores their indices
+        // to `out`. Returns the number of the acquired slots, which is less than `n` only if there are no more free
+        // slots.
+        std::size_t acquire_n(std::size_t n, std::size_t* out) noexcept
+        {
+            if (!n)
+                return 0;
+
+            std::atomic<std::size_t>& hint = m_hints[bitmask_detail::thread_ordinal() & (m_hints.size() - 1)].word;
+            std::size_t acquired = 0;
+            std::size_t last_word = npos;
+            const auto claim = [&](std::size_t w) {
+                acquired += claim_in_word(w, n - acquired, out + acquired);
+                last_word = w;
+                return acquired == n;
+            };
+            if (!visit_summary(hint.load(std::memory_order_relaxed), claim))
+                visit_words(hint.load(std::memory_order_relaxed), claim);
+            if (last_word != npos)
+                hint.store(last_word, std::memory_order_relaxed);
+            return acquired;
+        }
+
+        void release(std::size_t slot) noexcept
+        {
+            assert(slot < m_capacity && is_acquired(slot));
+
+            const std::size_t w = slot / 64;
+            const std::uint64_t prev = m_words[w].fetch_and(~(std::uint64_t{1} << (slot % 64)), std::memory_order_release);
+            if (prev == ~std::uint64_t{0} && !m_summary.empty())
+                m_summary[w / 64].fetch_and(~(std::uint64_t{1} << (w % 64)));
+        }
+
+        void release_n(const std::size_t* slots, std::size_t n) noexcept
+        {
+            for (std::size_t i = 0; i != n; ++i)
+                release(slots[i]);
+        }
+
+        bool is_acquired(std::size_t slot) const noexcept
+        {
+            return (m_words[slot / 64].load(std::memory_order_acquire) >> (slot % 64)) & 1;
+        }
+
+        // Number of the acquired slots. Not a snapshot if there are concurrent modifications.
+        std::size_t count() const noexcept
+        {
+            std::size_t result = 0;
+            for (const auto& w: m_words)
+                result += static_cast<std::size_t>(bitmask_detail::popcount(w.load(std::memory_order_relaxed)));
+            return result - (m_words.size() * 64 - m_capacity);
+        }
+
+    private:
+        static constexpr std::size_t alignment = 64;
+
+        struct hint
+        {
+            alignas(alignment) std::atomic<std::size_t> word;
+        };
+
+        static std::size_t hint_count() noexcept
+        {
+            const unsigned threads = std::thread::hardware_concurrency();
+            std::size_t n = 1;
+            while (n < threads)
+                n *= 2;
+            return n;
+        }
+
+        // Claims up to `n` free slots of word `w` with a single CAS
+        std::size_t claim_in_word(std::size_t w, std::size_t n, std::size_t* out) noexcept
+        {
+            std::uint64_t bits = m_words[w].load(std::memory_order_relaxed);
+            while (bits != ~std::uint64_t{0})
+            {
+                std::uint64_t picked = 0;
+                std::uint64_t free = ~bits;
+                for (std::size_t i = 0; i != n && free; ++i)
+                {
+                    picked |= free & (0 - free);
+                    free &= free - 1;
+                }
+                if (m_words[w].compare_exchange_weak(bits, bits | picked, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    if ((bits | picked) == ~std::uint64_t{0})
+                        mark_full(w);
+                    std::size_t count = 0;
+                    for (; picked; picked &= picked - 1)
+                        out[count++] = w * 64 + static_cast<std::size_t>(bitmask_detail::lowest_bit_index(picked));
+                    return count;
+                }
+            }
+            return 0;
+        }
+
+        void mark_full(std::size_t w) noexcept
+        {
+            if (m_summary.empty())
+                return;
+            const std::uint64_t bit = std::uint64_t{1} << (w % 64);
+            m_summary[w / 64].fetch_or(bit);
+            // A slot may have been released in between, and its release has seen the summary bit clear
+            if (m_words[w].load() != ~std::uint64_t{0})
+                m_summary[w / 64].fetch_and(~bit);
+        }
+
+        // Calls `claim(w)` for the words that are not full by the summary, starting from word `start` and wrapping
+        // around, until it returns true
+        template<class Claim>
+        bool visit_summary(std::size_t start, Claim& claim) noexcept
+        {
+            if (m_summary.empty())
+                return false;
+
+            const std::size_t count = m_summary.size();
+            const std::uint64_t upper = ~std::uint64_t{0} << (start % 64);
+            std::size_t s = start / 64;
+            // The first summary word is visited twice: from the start bit up, and below it at the end
+            for (std::size_t step = 0; step <= count; ++step)
+            {
+                std::uint64_t candidates = ~m_summary[s].load(std::memory_order_relaxed);
+                if (step == 0)
+                    candidates &= upper;
+                else if (step == count)
+                    candidates &= ~upper;
+                for (; candidates; candidates &= candidates - 1)
+                {
+                    if (claim(s * 64 + static_cast<std::size_t>(bitmask_detail::lowest_bit_index(candidates))))
+                        return true;
+                }
+                s = s + 1 == count ? 0 : s + 1;
+            }
+            return false;
+        }
+
+        template<class Claim>
+        bool visit_words(std::size_t start, Claim& claim) noexcept
+        {
+            const std::size_t count = m_words.size();
+            for (std::size_t i = 0, w = start; i != count; ++i, w = w + 1 == count ? 0 : w + 1)
+            {
+                if (m_words[w].load(std::memory_order_relaxed) != ~std::uint64_t{0} && claim(w))
+                    return true;
+            }
+            return false;
+        }
+
+        std::size_t m_capacity;
+        std::vector<std::atomic<std::uint64_t>, bitmask_detail::aligned_allocator<std::atomic<std::uint64_t>, alignment>> m_words;
+        std::vector<std::atomic<std::uint64_t>> m_summary;
+        std::vector<hint, bitmask_detail::aligned_allocator<hint, alignment>> m_hints;
+    };
+}
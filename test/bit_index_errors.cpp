@@ -0,0 +1,32 @@
+// Compiled by `check_compile_errors.cmake` once as is and once per error case below,
+// which must fail the compilation with the `static_assert` of the header and nothing before it.
+
+#include <bitmask/algorithm.hpp>
+#include <bitmask/posting_index.hpp>
+
+#include <cstdint>
+
+
+namespace
+{
+    enum class capability: std::uint8_t
+    {
+        read = 0,
+        admin = 100,
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(capability, admin)
+}
+
+static_assert(bitmask::flag_count<capability>::value == 101, "Every index up to the maximum one is a flag");
+
+#if defined(FLAG_HISTOGRAM)
+void histogram(const bitmask::bitmask<capability>* first, const bitmask::bitmask<capability>* last)
+{
+    bitmask::flag_histogram(first, last);
+}
+#elif defined(POSTING_INDEX)
+bitmask::bitmask_posting_index<capability> index;
+#endif
+
+int main() {}
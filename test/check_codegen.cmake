@@ -0,0 +1,65 @@
+# Compiles SOURCE to assembly with optimizations on (release build) and checks the `codegen_*` functions:
+# - `codegen_atomic_*` ones must contain a `lock` prefixed instruction, no CAS loop and no branches;
+# - the rest must contain exactly one test/compare instruction and no branches.
+#
+# Usage: cmake -DCXX=<compiler> -DSOURCE=<file> -DINCLUDE_DIR=<dir> -DOUTPUT=<file> -P check_codegen.cmake
+
+execute_process(
+    COMMAND ${CXX} -std=c++11 -O2 -DNDEBUG -S -I${INCLUDE_DIR} -o ${OUTPUT} ${SOURCE}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE error
+)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to compile ${SOURCE}:\n${error}")
+endif()
+
+file(STRINGS ${OUTPUT} lines)
+
+set(function "")
+set(failed FALSE)
+foreach(line IN LISTS lines)
+    if (line MATCHES "^_?(codegen_[a-z_]+):")
+        set(function ${CMAKE_MATCH_1})
+        set(${function}_compares 0)
+        set(${function}_branches 0)
+        set(${function}_locks 0)
+        set(${function}_cas 0)
+        list(APPEND functions ${function})
+    elseif (function)
+        if (line MATCHES "^[ \t]+lock[ \t]+cmpxchg")
+            math(EXPR ${function}_cas "${${function}_cas} + 1")
+        elseif (line MATCHES "^[ \t]+lock[ \t]")
+            math(EXPR ${function}_locks "${${function}_locks} + 1")
+        elseif (line MATCHES "^[ \t]+(test|cmp)[a-z]*[ \t]")
+            math(EXPR ${function}_compares "${${function}_compares} + 1")
+        elseif (line MATCHES "^[ \t]+(j[a-z]+|call)[ \t]")
+            math(EXPR ${function}_branches "${${function}_branches} + 1")
+        elseif (line MATCHES "^[ \t]+ret")
+            set(function "")
+        endif()
+    endif()
+endforeach()
+
+if (NOT functions)
+    message(FATAL_ERROR "No codegen_* functions found in ${OUTPUT}")
+endif()
+
+foreach(function IN LISTS functions)
+    if (function MATCHES "^codegen_atomic_")
+        if (${function}_locks EQUAL 0 OR NOT ${function}_cas EQUAL 0 OR NOT ${function}_branches EQUAL 0)
+            message(SEND_ERROR "${function}: ${${function}_locks} lock instructions, ${${function}_cas} CAS and ${${function}_branches} branches, expected at least 1, 0 and 0")
+            set(failed TRUE)
+        else()
+            message(STATUS "${function}: OK")
+        endif()
+    elseif (NOT ${function}_compares EQUAL 1 OR NOT ${function}_branches EQUAL 0)
+        message(SEND_ERROR "${function}: ${${function}_compares} test/compare instructions and ${${function}_branches} branches, expected 1 and 0")
+        set(failed TRUE)
+    else()
+        message(STATUS "${function}: OK")
+    endif()
+endforeach()
+
+if (failed)
+    message(FATAL_ERROR "Codegen check failed, see ${OUTPUT}")
+endif()
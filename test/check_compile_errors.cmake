@@ -0,0 +1,40 @@
+# Compiles SOURCE as is, which must succeed, and then with each of the CASES defined, which must fail.
+# If MESSAGE is given, the first error of every case must contain it.
+#
+# Usage: cmake -DCXX=<compiler> -DSOURCE=<file> -DINCLUDE_DIR=<dir> -DCASES=<a,b,...> [-DMESSAGE=<text>]
+#        -P check_compile_errors.cmake
+
+execute_process(
+    COMMAND ${CXX} -std=c++11 -fsyntax-only -I${INCLUDE_DIR} ${SOURCE}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE error
+)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to compile ${SOURCE}:\n${error}")
+endif()
+
+string(REPLACE "," ";" cases "${CASES}")
+
+set(failed FALSE)
+foreach(case IN LISTS cases)
+    execute_process(
+        COMMAND ${CXX} -std=c++11 -fsyntax-only -D${case} -I${INCLUDE_DIR} ${SOURCE}
+        RESULT_VARIABLE result
+        OUTPUT_QUIET
+        ERROR_VARIABLE error
+    )
+    string(REGEX MATCH "error: [^\n]*" first_error "${error}")
+    if (result EQUAL 0)
+        message(SEND_ERROR "${case}: compiled, expected an error")
+        set(failed TRUE)
+    elseif (MESSAGE AND NOT first_error MATCHES "${MESSAGE}")
+        message(SEND_ERROR "${case}: the first error is not \"${MESSAGE}\":\n${error}")
+        set(failed TRUE)
+    else()
+        message(STATUS "${case}: OK")
+    endif()
+endforeach()
+
+if (failed)
+    message(FATAL_ERROR "Compile error check failed")
+endif()
@@ -0,0 +1,33 @@
+// Compiled to assembly by `check_codegen.cmake` to check that the predicates collapse to
+// a single test/compare instruction.
+
+#include <bitmask/bitmask.hpp>
+
+#include <cstdint>
+
+
+namespace
+{
+    enum class permission: std::uint32_t
+    {
+        read    = 0x01,
+        write   = 0x02,
+        exec    = 0x08,
+        admin   = 0x80,
+
+        _bitmask_value_mask = 0x8B
+    };
+
+    BITMASK_DEFINE(permission)
+
+    using permissions = bitmask::bitmask<permission>;
+}
+
+extern "C"
+{
+    bool codegen_contains_all(permissions m, permissions r) { return m.contains_all(r); }
+    bool codegen_contains_any(permissions m, permissions r) { return m.contains_any(r); }
+    bool codegen_contains_none(permissions m, permissions r) { return m.contains_none(r); }
+    bool codegen_is_subset_of(permissions m, permissions r) { return m.is_subset_of(r); }
+    bool codegen_contains_all_value(permissions m) { return m.contains_all(permission::read | permission::exec); }
+}
@@ -0,0 +1,34 @@
+// Compiled to assembly by `check_codegen.cmake` to check that the atomic flag operations that don't need
+// the previous value compile to `lock` prefixed instructions instead of CAS loops.
+
+#include <bitmask/atomic.hpp>
+
+#include <cstdint>
+
+
+namespace
+{
+    enum class connection_state: std::uint32_t
+    {
+        connected   = 0x01,
+        draining    = 0x04,
+        shutdown    = 0x80,
+
+        _bitmask_value_mask = 0x85
+    };
+
+    BITMASK_DEFINE(connection_state)
+
+    using state = bitmask::atomic_bitmask<connection_state>;
+    using states = bitmask::bitmask<connection_state>;
+}
+
+extern "C"
+{
+    bool codegen_atomic_test_and_set(state& s) { return s.test_and_set(connection_state::draining); }
+    bool codegen_atomic_test_and_clear(state& s) { return s.test_and_clear(connection_state::shutdown, std::memory_order_acq_rel); }
+    bool codegen_atomic_test_and_set_variable(state& s, connection_state f) { return s.test_and_set(f, std::memory_order_acquire); }
+    void codegen_atomic_set(state& s, states m) { s.set(m, std::memory_order_release); }
+    void codegen_atomic_clear(state& s, states m) { s.clear(m); }
+    void codegen_atomic_flip(state& s) { s.flip(connection_state::connected); }
+}
@@ -0,0 +1,39 @@
+// Compiled by `check_compile_errors.cmake` once as is and once per error case below,
+// which must fail the compilation.
+
+#include <bitmask/names.hpp>
+
+#include <cstdint>
+
+
+namespace
+{
+    enum class open_mode: std::uint8_t
+    {
+        in = 0x01,
+        out = 0x02,
+        app = 0x10,
+
+        _bitmask_value_mask = 0x33
+    };
+
+    BITMASK_DEFINE(open_mode)
+    BITMASK_DEFINE_NAMES(open_mode, in, out, app)
+}
+
+#if defined(UNKNOWN_NAME)
+constexpr auto mode = BITMASK_LITERAL(open_mode, "in|binary");
+#elif defined(WRONG_CASE)
+constexpr auto mode = BITMASK_LITERAL(open_mode, "In");
+#elif defined(EMPTY_NAME)
+constexpr auto mode = BITMASK_LITERAL(open_mode, "in||out");
+#elif defined(OUT_OF_DOMAIN)
+constexpr auto mode = BITMASK_LITERAL(open_mode, "in|0x4");
+#elif defined(NAME_OF_NO_FLAG)
+constexpr auto name = bitmask::name_of(static_cast<open_mode>(0x03));
+#else
+constexpr auto mode = BITMASK_LITERAL(open_mode, "in|app|0x20");
+static_assert(mode.bits() == 0x31, "");
+#endif
+
+int main() {}
@@ -62,6 +62,9 @@ namespace nonintrusive
 #include <cstdint>
 #include <unordered_map>
 #include <map>
+#include <vector>
+#include <iterator>
+#include <array>
 
 
 TEST_CASE( "zero_bitmask", "[]" )
@@ -525,6 +528,266 @@ TEST_CASE("bitmask_limits", "[]")
     CHECK((screwed_extreme_8::max | screwed_extreme_8::min).bits() == 0xC0);
 }
 
+TEST_CASE("bitmask_iteration", "[]")
+{
+    using intrusive::syntax_option_type;
+    using intrusive::open_mode;
+
+    std::vector<syntax_option_type> v1;
+    for (auto f : syntax_option_type::awk | syntax_option_type::icase | syntax_option_type::collate)
+        v1.push_back(f);
+    CHECK((v1 == std::vector<syntax_option_type>{
+        syntax_option_type::icase, syntax_option_type::collate, syntax_option_type::awk}));
+
+    std::vector<open_mode> v2;
+    for (auto f : ~bitmask::bitmask<open_mode>{})
+        v2.push_back(f);
+    CHECK((v2 == std::vector<open_mode>{open_mode::app, open_mode::binary, open_mode::ate}));
+
+    bitmask::bitmask<open_mode> empty;
+    CHECK(empty.begin() == empty.end());
+    CHECK(std::distance(empty.begin(), empty.end()) == 0);
+
+    auto x = open_mode::ate | open_mode::binary;
+    auto it = x.begin();
+    CHECK(*it++ == open_mode::binary);
+    CHECK(*it == open_mode::ate);
+    CHECK(++it == x.end());
+
+    bitmask::bitmask<longest_enum> y = longest_enum::v1 | longest_enum::v2;
+    CHECK(std::distance(y.begin(), y.end()) == 2);
+    CHECK(*++y.begin() == longest_enum::v2);
+
+    bitmask::bitmask<screwed_extreme_8> z = screwed_extreme_8::max | screwed_extreme_8::min;
+    CHECK(*z.begin() == screwed_extreme_8::min);
+    CHECK(*++z.begin() == screwed_extreme_8::max);
+
+    static_assert(*(open_mode::ate | open_mode::binary).begin() == open_mode::binary, "");
+    static_assert(bitmask::bitmask<open_mode>{}.begin() == bitmask::bitmask<open_mode>{}.end(), "");
+}
+
+TEST_CASE("bitmask_bit_queries", "[]")
+{
+    using intrusive::syntax_option_type;
+    using intrusive::open_mode;
+    using bm = bitmask::bitmask<open_mode>;
+
+    CHECK(bm{}.count() == 0);
+    CHECK(bm{open_mode::ate}.count() == 1);
+    CHECK((~bm{}).count() == 3);
+    CHECK((~open_mode::app).count() == 2);
+    CHECK((~bitmask::bitmask<syntax_option_type>{}).count() == 6);
+    CHECK((longest_enum::v1 | longest_enum::v2).count() == 2);
+
+    CHECK_FALSE(bm{}.has_single_bit());
+    CHECK(bm{open_mode::ate}.has_single_bit());
+    CHECK_FALSE((open_mode::ate | open_mode::app).has_single_bit());
+
+    CHECK_FALSE(bm{}.is_full());
+    CHECK_FALSE((open_mode::ate | open_mode::app).is_full());
+    CHECK((open_mode::ate | open_mode::app | open_mode::binary).is_full());
+    CHECK((~bitmask::bitmask<syntax_option_type>{}).is_full());
+
+    CHECK(bm{}.lowest() == 0);
+    CHECK(bm{}.highest() == 0);
+    CHECK((open_mode::ate | open_mode::binary).lowest() == open_mode::binary);
+    CHECK((open_mode::ate | open_mode::binary).highest() == open_mode::ate);
+    CHECK((longest_enum::v1 | longest_enum::v2).highest() == longest_enum::v2);
+    CHECK((screwed_extreme_8::max | screwed_extreme_8::min).highest() == screwed_extreme_8::max);
+    CHECK((extreme_u8::max | extreme_u8::min).lowest() == extreme_u8::min);
+
+    bm x = open_mode::ate | open_mode::app | open_mode::binary;
+    CHECK(x.pop_lowest() == open_mode::app);
+    CHECK(x.pop_lowest() == open_mode::binary);
+    CHECK(x == open_mode::ate);
+    CHECK(x.pop_lowest() == open_mode::ate);
+    CHECK(x == 0);
+    CHECK(x.pop_lowest() == 0);
+
+    static_assert((open_mode::ate | open_mode::app).count() == 2, "");
+    static_assert((open_mode::ate | open_mode::app).highest() == open_mode::ate, "");
+    static_assert((open_mode::ate | open_mode::app).lowest() == open_mode::app, "");
+    static_assert((~bm{}).is_full(), "");
+    static_assert(bm{open_mode::binary}.has_single_bit(), "");
+}
+
+TEST_CASE("bitmask_subset_predicates", "[]")
+{
+    using intrusive::open_mode;
+    using bm = bitmask::bitmask<open_mode>;
+
+    const bm x = open_mode::app | open_mode::ate;
+
+    CHECK(x.contains_all(open_mode::app));
+    CHECK(x.contains_all(open_mode::app | open_mode::ate));
+    CHECK_FALSE(x.contains_all(open_mode::app | open_mode::binary));
+    CHECK(x.contains_all(bm{}));
+
+    CHECK(x.contains_any(open_mode::app | open_mode::binary));
+    CHECK_FALSE(x.contains_any(open_mode::binary));
+    CHECK_FALSE(x.contains_any(bm{}));
+
+    CHECK(x.contains_none(open_mode::binary));
+    CHECK_FALSE(x.contains_none(open_mode::binary | open_mode::ate));
+    CHECK(x.contains_none(bm{}));
+
+    CHECK(x.is_subset_of(x));
+    CHECK(x.is_subset_of(~bm{}));
+    CHECK_FALSE(x.is_subset_of(open_mode::app));
+    CHECK(bm{}.is_subset_of(open_mode::app));
+    CHECK(bm{open_mode::ate}.is_subset_of(x));
+
+    static_assert((open_mode::app | open_mode::ate).contains_all(open_mode::ate), "");
+    static_assert((open_mode::app | open_mode::ate).contains_any(open_mode::ate | open_mode::binary), "");
+    static_assert((open_mode::app | open_mode::ate).contains_none(open_mode::binary), "");
+    static_assert(bm{open_mode::app}.is_subset_of(open_mode::app | open_mode::ate), "");
+}
+
+TEST_CASE("bitmask_bit_primitives_fallback", "[]")
+{
+    using namespace bitmask::bitmask_detail;
+
+    static_assert(popcount_fallback(0) == 0, "");
+    static_assert(popcount_fallback(0xFFFFFFFFFFFFFFFFull) == 64, "");
+    static_assert(popcount_fallback(0x8000000000000001ull) == 2, "");
+    static_assert(lowest_bit_index_fallback(1) == 0, "");
+    static_assert(lowest_bit_index_fallback(0x50) == 4, "");
+    static_assert(lowest_bit_index_fallback(0x8000000000000000ull) == 63, "");
+    static_assert(highest_bit_index_fallback(1) == 0, "");
+    static_assert(highest_bit_index_fallback(0x50) == 6, "");
+    static_assert(highest_bit_index_fallback(0x8000000000000001ull) == 63, "");
+
+    for (int i = 0; i != 64; ++i)
+    {
+        const auto x = std::uint64_t{1} << i;
+        CHECK(lowest_bit_index(x) == i);
+        CHECK(highest_bit_index(x) == i);
+        CHECK(lowest_bit_index(x | 0x8000000000000000ull) == lowest_bit_index_fallback(x | 0x8000000000000000ull));
+        CHECK(highest_bit_index(x | 1) == highest_bit_index_fallback(x | 1));
+        CHECK(popcount(x - 1) == popcount_fallback(x - 1));
+    }
+}
+
+namespace {
+    enum class capability: unsigned char
+    {
+        c0 = 0,
+        c1 = 1,
+        c63 = 63,
+        c64 = 64,
+        c100 = 100,
+        c129 = 129,
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(capability, c129)
+
+    enum bit_index_64
+    {
+        bi_first = 0,
+        bi_last = 63,
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(bit_index_64, bi_last)
+}
+
+TEST_CASE("bitmask_bit_index", "[]")
+{
+    using bm = bitmask::bitmask<capability>;
+
+    static_assert(bm::max_index == 129, "");
+    static_assert(bm::word_count == 3, "");
+    static_assert(std::is_same<bm::underlying_type, std::array<std::uint64_t, 3>>::value, "");
+    static_assert(sizeof(bm) == 3 * sizeof(std::uint64_t), "");
+    static_assert(bitmask::bitmask<bit_index_64>::word_count == 1, "");
+
+    CHECK((bm::mask_value == bm::underlying_type{{~0ull, ~0ull, 0x3}}));
+    CHECK((bitmask::bitmask<bit_index_64>::mask_value == std::array<std::uint64_t, 1>{{~0ull}}));
+
+    bm x;
+    CHECK(!x);
+    CHECK(x == nullptr);
+    CHECK((x == 0));
+    CHECK(x.count() == 0);
+
+    x = capability::c0 | capability::c64 | capability::c129;
+    CHECK(x);
+    CHECK((x.bits() == bm::underlying_type{{0x1, 0x1, 0x2}}));
+    CHECK((bits(capability::c100) == bm::underlying_type{{0, 1ull << 36, 0}}));
+    CHECK(x.word(2) == 0x2);
+    CHECK(x.count() == 3);
+
+    CHECK((x & capability::c64));
+    CHECK(!(x & capability::c63));
+    CHECK((x & capability::c64) == capability::c64);
+    CHECK(capability::c64 == (x & capability::c64));
+    CHECK(((x & capability::c63) == 0));
+    CHECK((x ^ capability::c0) == (capability::c64 | capability::c129));
+    CHECK((capability::c1 | x) != x);
+    CHECK((~x).count() == 130 - 3);
+    CHECK((~x & x) == nullptr);
+    CHECK((~bm{}).is_full());
+    CHECK((~bm{}).bits() == bm::mask_value);
+    CHECK((~~x) == x);
+
+    x |= capability::c63;
+    CHECK(x.count() == 4);
+    x &= ~bm{capability::c0};
+    CHECK(x == (capability::c63 | capability::c64 | capability::c129));
+    x ^= capability::c129;
+    CHECK(x == (capability::c63 | capability::c64));
+
+    CHECK(x.contains_all(capability::c63 | capability::c64));
+    CHECK_FALSE(x.contains_all(capability::c63 | capability::c100));
+    CHECK(x.contains_any(capability::c63 | capability::c100));
+    CHECK(x.contains_none(capability::c0 | capability::c100));
+    CHECK(x.is_subset_of(capability::c0 | capability::c63 | capability::c64));
+    CHECK_FALSE(x.is_subset_of(capability::c63));
+
+    CHECK(x.lowest() == capability::c63);
+    CHECK(x.highest() == capability::c64);
+    CHECK(bm{}.lowest() == nullptr);
+    CHECK(bm{}.highest() == nullptr);
+    CHECK(bm{capability::c129}.has_single_bit());
+    CHECK_FALSE(x.has_single_bit());
+
+    std::vector<capability> v;
+    for (auto c : capability::c1 | capability::c100 | capability::c129 | capability::c0)
+        v.push_back(c);
+    CHECK((v == std::vector<capability>{capability::c0, capability::c1, capability::c100, capability::c129}));
+    CHECK(bm{}.begin() == bm{}.end());
+
+    bm y = capability::c129 | capability::c1;
+    CHECK(y.pop_lowest() == capability::c1);
+    CHECK(y.pop_lowest() == capability::c129);
+    CHECK(y.pop_lowest() == nullptr);
+    CHECK(!y);
+
+    CHECK(bm{capability::c1} < bm{capability::c100});
+    CHECK(bm{capability::c63} < bm{capability::c64});
+    CHECK_FALSE(bm{capability::c64} < bm{capability::c64});
+
+    using hash = std::hash<bm>;
+    CHECK(hash{}(capability::c1 | capability::c100) == hash{}(capability::c100 | capability::c1));
+    CHECK(hash{}(capability::c1) != hash{}(capability::c100));
+
+    std::unordered_map<bm, int> umap;
+    umap.emplace(capability::c1, 1);
+    umap.emplace(capability::c129, 2);
+    CHECK(umap[capability::c129] == 2);
+
+    static_assert((capability::c0 | capability::c129).count() == 2, "");
+    static_assert((capability::c0 | capability::c129) == (capability::c129 | capability::c0), "");
+    static_assert((capability::c0 | capability::c129).contains_all(capability::c129), "");
+    static_assert((~bm{}).count() == 130, "");
+    static_assert((capability::c64 | capability::c129).highest() == capability::c129, "");
+    static_assert((capability::c64 | capability::c129).lowest() == capability::c64, "");
+    static_assert(*(capability::c64 | capability::c129).begin() == capability::c64, "");
+
+    bitmask::bitmask<bit_index_64> z = ~bi_first;
+    CHECK(z.count() == 63);
+    CHECK((z | bi_first).is_full());
+}
+
 #if !defined _MSC_VER
 // MS Visual Studio 2015 (even Update 3) has weird support for expressions SFINAE so this test can't be compiled.
 
@@ -548,4 +811,19 @@ TEST_CASE("incorrect_mask", "[]")
     static_assert(!is_bitmask_constructible<open_mode, static_cast<open_mode>(0x20)>::value, "");
 }
 
+namespace {
+    template<class T, T value, typename = void_t<>>
+    struct is_bit_index_bitmask_constructible : std::false_type {};
+
+    template<class T, T value>
+    struct is_bit_index_bitmask_constructible<T, value, void_t<std::integral_constant<std::size_t, bitmask::bitmask<T>{value}.count()>>> : std::true_type {};
+}
+
+TEST_CASE("incorrect_bit_index", "[]")
+{
+    static_assert(is_bit_index_bitmask_constructible<capability, capability::c129>::value, "");
+
+    static_assert(!is_bit_index_bitmask_constructible<capability, static_cast<capability>(130)>::value, "");
+}
+
 #endif
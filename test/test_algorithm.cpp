@@ -0,0 +1,231 @@
+#include "catch.hpp"
+
+#include <bitmask/algorithm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class event: std::uint16_t
+    {
+        e0 = 0x0001,
+        e1 = 0x0010,
+        e2 = 0x0100,
+        e3 = 0x1000,
+
+        _bitmask_value_mask = 0x1111
+    };
+
+    BITMASK_DEFINE(event)
+
+    enum class wide_event
+    {
+        first = 0,
+        last = 199,
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(wide_event, last)
+
+    template<class T>
+    std::vector<bitmask::bitmask<T>> random_masks(std::size_t n, typename bitmask::bitmask<T>::underlying_type bits_mask)
+    {
+        std::mt19937_64 gen{42};
+        std::vector<bitmask::bitmask<T>> result;
+        result.reserve(n);
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            result.push_back(bitmask::bitmask_detail::to_enum<T>(
+                static_cast<typename bitmask::bitmask<T>::underlying_type>(gen()) & bits_mask));
+        }
+        return result;
+    }
+
+    template<class T>
+    void check_reductions(const std::vector<bitmask::bitmask<T>>& v)
+    {
+        bitmask::bitmask<T> expected_or, expected_and = ~bitmask::bitmask<T>{}, expected_xor;
+        for (const auto& m : v)
+        {
+            expected_or |= m;
+            expected_and &= m;
+            expected_xor ^= m;
+        }
+
+        const auto first = v.data();
+        const auto last = v.data() + v.size();
+
+        CHECK(bitmask::reduce_or(first, last) == expected_or);
+        CHECK(bitmask::reduce_and(first, last) == expected_and);
+        CHECK(bitmask::reduce_xor(first, last) == expected_xor);
+
+        bitmask::parallel_options options;
+        options.min_size = 1000;
+        options.max_threads = 3;
+
+        CHECK(bitmask::parallel_reduce_or(first, last, options) == expected_or);
+        CHECK(bitmask::parallel_reduce_and(first, last, options) == expected_and);
+        CHECK(bitmask::parallel_reduce_xor(first, last, options) == expected_xor);
+    }
+}
+
+TEST_CASE("reduce", "[algorithm]")
+{
+    using bm = bitmask::bitmask<event>;
+
+    const bm empty[1] = {};
+    CHECK(!bitmask::reduce_or(empty, empty));
+    CHECK(bitmask::reduce_and(empty, empty).is_full());
+    CHECK(!bitmask::reduce_xor(empty, empty));
+
+    const bm v[] = {event::e0 | event::e1, event::e1, event::e1 | event::e3};
+    CHECK(bitmask::reduce_or(std::begin(v), std::end(v)) == (event::e0 | event::e1 | event::e3));
+    CHECK(bitmask::reduce_and(std::begin(v), std::end(v)) == event::e1);
+    CHECK(bitmask::reduce_xor(std::begin(v), std::end(v)) == (event::e0 | event::e1 | event::e3));
+
+    for (std::size_t n : {1, 7, 100, 1000, 5000, 100000})
+    {
+        // Rare bits so the reductions don't stop early
+        check_reductions(random_masks<event>(n, 0x0111));
+        // Dense bits so they do
+        check_reductions(random_masks<event>(n, 0x1111));
+    }
+}
+
+TEST_CASE("reduce_early_exit", "[algorithm]")
+{
+    using bm = bitmask::bitmask<event>;
+
+    std::vector<bm> v(100000, event::e0 | event::e1);
+    v[10] = nullptr;
+    v[20] = ~bm{};
+
+    CHECK(!bitmask::reduce_and(v.data(), v.data() + v.size()));
+    CHECK(bitmask::reduce_or(v.data(), v.data() + v.size()).is_full());
+}
+
+TEST_CASE("reduce_bit_index", "[algorithm]")
+{
+    using bm = bitmask::bitmask<wide_event>;
+
+    std::mt19937 gen{3};
+    std::vector<bm> v(3000);
+    for (auto& m : v)
+    {
+        for (int i = 0; i != 100; ++i)
+            m |= static_cast<wide_event>(gen() % 200);
+    }
+
+    check_reductions(v);
+}
+
+TEST_CASE("simd_reduce_kernels", "[algorithm][simd]")
+{
+    namespace detail = bitmask::simd::simd_detail;
+
+    std::mt19937_64 gen{5};
+    std::vector<std::uint32_t> x(10007);
+    for (auto& e : x)
+        e = static_cast<std::uint32_t>(gen());
+
+    const auto expected_or = detail::scalar::reduce<detail::op_or>(x.data(), x.size(), 0u, 0u, false);
+    const auto expected_xor = detail::scalar::reduce<detail::op_xor>(x.data(), x.size(), 0u, 0u, false);
+
+    std::uint32_t naive_xor = 0;
+    for (auto e : x)
+        naive_xor ^= e;
+    CHECK(expected_xor == naive_xor);
+
+#if BITMASK_SIMD_X86
+    const auto& cpu = bitmask::simd::detected_cpu_features();
+    if (cpu.avx2)
+    {
+        CHECK(detail::avx2::reduce<detail::op_or>(x.data(), x.size(), 0u, 0u, false) == expected_or);
+        CHECK(detail::avx2::reduce<detail::op_xor>(x.data(), x.size(), 0u, 0u, false) == expected_xor);
+    }
+    if (cpu.avx512)
+    {
+        CHECK(detail::avx512::reduce<detail::op_or>(x.data(), x.size(), 0u, 0u, false) == expected_or);
+        CHECK(detail::avx512::reduce<detail::op_xor>(x.data(), x.size(), 0u, 0u, false) == expected_xor);
+    }
+#endif
+}
+
+namespace
+{
+    enum class sparse_8: std::uint8_t { a = 0x01, b = 0x04, c = 0x80, _bitmask_value_mask = 0x85 };
+    BITMASK_DEFINE(sparse_8)
+
+    enum class sparse_16: std::uint16_t { a = 0x0002, b = 0x0100, c = 0x8000, _bitmask_value_mask = 0x8102 };
+    BITMASK_DEFINE(sparse_16)
+
+    enum class sparse_32: std::uint32_t { _bitmask_value_mask = 0xF00F0F01 };
+    BITMASK_DEFINE(sparse_32)
+
+    enum class dense_64: std::uint64_t { _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF };
+    BITMASK_DEFINE(dense_64)
+
+    template<class T>
+    void check_flag_histogram(std::size_t n)
+    {
+        using bm = bitmask::bitmask<T>;
+        using U = typename bm::underlying_type;
+
+        const auto v = random_masks<T>(n, bm::mask_value);
+
+        std::array<std::uint64_t, bitmask::flag_count<T>::value> expected{};
+        for (const auto& m : v)
+        {
+            for (T flag : m)
+                ++expected[bitmask::flag_index(flag)];
+        }
+        CHECK((bitmask::flag_histogram(v.data(), v.data() + v.size()) == expected));
+
+        // Every kernel must agree with the scalar one
+        const U* x = reinterpret_cast<const U*>(v.data());
+        std::uint64_t scalar_counts[std::numeric_limits<U>::digits] = {};
+        bitmask::simd::simd_detail::scalar::positional_popcount(x, n, scalar_counts);
+
+#if BITMASK_SIMD_X86
+        const auto& cpu = bitmask::simd::detected_cpu_features();
+        if (cpu.avx2)
+        {
+            std::uint64_t counts[std::numeric_limits<U>::digits] = {};
+            bitmask::simd::simd_detail::avx2::positional_popcount(x, n, counts);
+            CHECK(std::equal(std::begin(counts), std::end(counts), std::begin(scalar_counts)));
+        }
+        if (cpu.avx512)
+        {
+            std::uint64_t counts[std::numeric_limits<U>::digits] = {};
+            bitmask::simd::simd_detail::avx512::positional_popcount(x, n, counts);
+            CHECK(std::equal(std::begin(counts), std::end(counts), std::begin(scalar_counts)));
+        }
+#endif
+    }
+}
+
+TEST_CASE("flag_histogram", "[algorithm]")
+{
+    static_assert(bitmask::flag_count<sparse_8>::value == 3, "");
+    static_assert(bitmask::flag_count<dense_64>::value == 64, "");
+    static_assert(bitmask::flag_index(sparse_16::a) == 0, "");
+    static_assert(bitmask::flag_index(sparse_16::c) == 2, "");
+
+    const bitmask::bitmask<sparse_8> v[] = {sparse_8::a | sparse_8::c, sparse_8::c, sparse_8::b | sparse_8::c};
+    const std::array<std::uint64_t, 3> expected = {{1, 1, 3}};
+    CHECK((bitmask::flag_histogram(std::begin(v), std::end(v)) == expected));
+
+    for (std::size_t n : {0, 1, 15, 16, 17, 1000, 4099, 20000})
+    {
+        check_flag_histogram<sparse_8>(n);
+        check_flag_histogram<sparse_16>(n);
+        check_flag_histogram<sparse_32>(n);
+        check_flag_histogram<dense_64>(n);
+    }
+}
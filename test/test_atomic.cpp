@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include <bitmask/atomic.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class worker_state: std::uint8_t
+    {
+        running = 0x01,
+        draining = 0x02,
+        stopped = 0x10,
+
+        _bitmask_value_mask = 0x13
+    };
+
+    BITMASK_DEFINE(worker_state)
+
+    enum class slot: std::uint64_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF
+    };
+
+    BITMASK_DEFINE(slot)
+}
+
+TEST_CASE("atomic_bitmask", "[atomic]")
+{
+    using bm = bitmask::bitmask<worker_state>;
+
+    bitmask::atomic_bitmask<worker_state> s;
+    CHECK(s.is_lock_free());
+    CHECK(!s.load());
+
+    s.store(worker_state::running, std::memory_order_release);
+    CHECK(s.load(std::memory_order_acquire) == worker_state::running);
+    CHECK(s.exchange(worker_state::draining) == worker_state::running);
+
+    CHECK(s.fetch_or(worker_state::stopped) == worker_state::draining);
+    CHECK(s.fetch_and(worker_state::stopped | worker_state::running) == (worker_state::draining | worker_state::stopped));
+    CHECK(s.fetch_xor(worker_state::running | worker_state::stopped, std::memory_order_relaxed) == worker_state::stopped);
+    CHECK(s.load() == worker_state::running);
+
+    CHECK_FALSE(s.test_and_set(worker_state::draining));
+    CHECK(s.test_and_set(worker_state::draining, std::memory_order_acq_rel));
+    CHECK(s.test(worker_state::draining));
+    CHECK(s.test_and_clear(worker_state::draining));
+    CHECK_FALSE(s.test_and_clear(worker_state::draining));
+    CHECK_FALSE(s.test(worker_state::draining));
+
+    s.set(worker_state::stopped);
+    s.clear(worker_state::running);
+    CHECK(s.load() == worker_state::stopped);
+    s.flip(worker_state::stopped | worker_state::draining);
+    CHECK(s.load() == worker_state::draining);
+
+    // Complement never leaves the domain
+    s.flip(~bm{});
+    CHECK(s.load() == (worker_state::running | worker_state::stopped));
+    CHECK(s.load().bits() == 0x11);
+
+    bm expected = worker_state::draining;
+    CHECK_FALSE(s.compare_exchange_strong(expected, worker_state::stopped));
+    CHECK(expected == (worker_state::running | worker_state::stopped));
+    CHECK(s.compare_exchange_strong(expected, worker_state::stopped, std::memory_order_acq_rel));
+    CHECK(s.load() == worker_state::stopped);
+
+    expected = worker_state::stopped;
+    while (!s.compare_exchange_weak(expected, bm{}, std::memory_order_release, std::memory_order_relaxed)) {}
+    CHECK(!s.load());
+
+    CHECK((s |= worker_state::running) == worker_state::running);
+    CHECK((s ^= worker_state::running | worker_state::draining) == worker_state::draining);
+    CHECK(!(s &= worker_state::running));
+    s = worker_state::stopped;
+    CHECK(static_cast<bm>(s) == worker_state::stopped);
+}
+
+TEST_CASE("atomic_bitmask_concurrent", "[atomic]")
+{
+    // Every thread claims its own flags with test_and_set; all of them must end up set exactly once
+    bitmask::atomic_bitmask<slot> slots;
+    const unsigned threads = 4;
+    std::vector<int> claimed(64 * threads);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            for (unsigned i = 0; i != 64; ++i)
+                claimed[t * 64 + i] = !slots.test_and_set(static_cast<slot>(std::uint64_t{1} << i), std::memory_order_acq_rel);
+        });
+    }
+    for (auto& t : pool)
+        t.join();
+
+    CHECK(slots.load().is_full());
+    for (unsigned i = 0; i != 64; ++i)
+    {
+        int winners = 0;
+        for (unsigned t = 0; t != threads; ++t)
+            winners += claimed[t * 64 + i];
+        CHECK(winners == 1);
+    }
+}
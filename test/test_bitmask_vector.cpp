@@ -0,0 +1,185 @@
+#include "catch.hpp"
+
+#include <bitmask/bitmask_vector.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class flags_8: std::uint8_t
+    {
+        f0 = 0x01,
+        f1 = 0x04,
+        f2 = 0x10,
+        f3 = 0x80,
+
+        _bitmask_value_mask = 0x95
+    };
+
+    BITMASK_DEFINE(flags_8)
+
+    enum class flags_16: std::uint16_t
+    {
+        f0 = 0x0001,
+        f1 = 0x0100,
+        f2 = 0x8000,
+
+        _bitmask_value_mask = 0x8101
+    };
+
+    BITMASK_DEFINE(flags_16)
+
+    enum class flags_32: std::uint32_t
+    {
+        f0 = 0x00000001,
+        f1 = 0x00000002,
+        f2 = 0x80000000,
+
+        _bitmask_value_mask = 0x80000003
+    };
+
+    BITMASK_DEFINE(flags_32)
+
+    enum class flags_64: std::uint64_t
+    {
+        f0 = 0x1,
+        f1 = 0x100000000,
+        f2 = 0x8000000000000000,
+
+        _bitmask_value_mask = 0x8000000100000001
+    };
+
+    BITMASK_DEFINE(flags_64)
+
+    template<class T>
+    bitmask::bitmask<T> random_mask(std::mt19937_64& gen)
+    {
+        return bitmask::bitmask_detail::to_enum<T>(
+            static_cast<typename bitmask::bitmask<T>::underlying_type>(gen()) & bitmask::bitmask<T>::mask_value);
+    }
+
+    template<class T>
+    void check_filters()
+    {
+        using bm = bitmask::bitmask<T>;
+
+        std::mt19937_64 gen{42};
+
+        for (std::size_t n : {0, 1, 63, 64, 65, 200, 1000})
+        {
+            bitmask::bitmask_vector<T> v;
+            for (std::size_t i = 0; i != n; ++i)
+                v.push_back(random_mask<T>(gen));
+
+            REQUIRE(v.size() == n);
+            CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % bitmask::bitmask_vector<T>::alignment == 0);
+
+            for (int k = 0; k != 8; ++k)
+            {
+                const bm m = random_mask<T>(gen);
+
+                std::vector<std::size_t> any, all, none, equal;
+                for (std::size_t i = 0; i != n; ++i)
+                {
+                    if (v[i].contains_any(m)) any.push_back(i);
+                    if (v[i].contains_all(m)) all.push_back(i);
+                    if (v[i].contains_none(m)) none.push_back(i);
+                    if (v[i] == m) equal.push_back(i);
+                }
+
+                CHECK(v.filter_any_indices(m) == any);
+                CHECK(v.filter_all_indices(m) == all);
+                CHECK(v.filter_none_indices(m) == none);
+                CHECK(v.filter_equal_indices(m) == equal);
+
+                const auto bitmap = v.filter_any(m);
+                CHECK(bitmap.size() == (n + 63) / 64);
+                std::size_t count = 0;
+                for (auto w : bitmap)
+                    count += static_cast<std::size_t>(bitmask::bitmask_detail::popcount(w));
+                CHECK(count == any.size());
+            }
+        }
+    }
+
+    // Checks the vector match kernels against the scalar one
+    template<class U>
+    void check_match_kernels()
+    {
+        namespace detail = bitmask::simd::simd_detail;
+
+        std::mt19937_64 gen{1};
+
+        std::vector<U> x(777);
+        for (auto& e : x)
+            e = static_cast<U>(gen() & 0x0303030303030303ull);
+
+        const U and_mask = static_cast<U>(0x0101010101010101ull);
+        const U value = static_cast<U>(0x0100010001000100ull);
+
+        std::vector<std::uint64_t> expected(bitmask::simd::bitmap_words(x.size()));
+        std::vector<std::uint64_t> actual(expected.size());
+
+        for (bool negate : {false, true})
+        {
+            detail::scalar::match(x.data(), x.size(), and_mask, value, negate, expected.data());
+
+#if BITMASK_SIMD_X86
+            const auto& cpu = bitmask::simd::detected_cpu_features();
+            if (cpu.avx2)
+            {
+                detail::avx2::match(x.data(), x.size(), and_mask, value, negate, actual.data());
+                CHECK(actual == expected);
+            }
+            if (cpu.avx512bw)
+            {
+                detail::avx512::match(x.data(), x.size(), and_mask, value, negate, actual.data());
+                CHECK(actual == expected);
+            }
+#endif
+        }
+    }
+}
+
+TEST_CASE("bitmask_vector_basics", "[bitmask_vector]")
+{
+    bitmask::bitmask_vector<flags_8> v{flags_8::f0, flags_8::f1 | flags_8::f3, nullptr};
+
+    CHECK(v.size() == 3);
+    CHECK_FALSE(v.empty());
+    CHECK(v[0] == flags_8::f0);
+    CHECK(v[1] == (flags_8::f1 | flags_8::f3));
+    CHECK(!v[2]);
+
+    v.set(2, flags_8::f2);
+    CHECK(v[2] == flags_8::f2);
+
+    CHECK((v.filter_any_indices(flags_8::f0 | flags_8::f2) == std::vector<std::size_t>{0, 2}));
+    CHECK((v.filter_all_indices(flags_8::f1 | flags_8::f3) == std::vector<std::size_t>{1}));
+    CHECK((v.filter_none_indices(flags_8::f0) == std::vector<std::size_t>{1, 2}));
+    CHECK((v.filter_equal_indices(flags_8::f1) == std::vector<std::size_t>{}));
+    CHECK((v.filter_any(flags_8::f0 | flags_8::f2) == std::vector<std::uint64_t>{0x5}));
+
+    v.clear();
+    CHECK(v.empty());
+    CHECK(v.filter_any(flags_8::f0).empty());
+}
+
+TEST_CASE("bitmask_vector_filters", "[bitmask_vector]")
+{
+    check_filters<flags_8>();
+    check_filters<flags_16>();
+    check_filters<flags_32>();
+    check_filters<flags_64>();
+}
+
+TEST_CASE("simd_match_kernels", "[bitmask_vector][simd]")
+{
+    check_match_kernels<std::uint8_t>();
+    check_match_kernels<std::uint16_t>();
+    check_match_kernels<std::uint32_t>();
+    check_match_kernels<std::uint64_t>();
+}
@@ -0,0 +1,178 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <bitmask/coroutine.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class conn_state: std::uint32_t
+    {
+        resolved = 0x01,
+        connected = 0x02,
+        authenticated = 0x04,
+        closed = 0x08,
+
+        _bitmask_max_element = closed
+    };
+
+    BITMASK_DEFINE(conn_state)
+
+    enum class channel: std::uint64_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF
+    };
+
+    BITMASK_DEFINE(channel)
+
+    // Coroutine that starts eagerly and frees itself when done
+    struct task
+    {
+        struct promise_type
+        {
+            task get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    // Resumes the coroutines when `run()` is called
+    struct queue_executor
+    {
+        std::deque<std::coroutine_handle<>>* queue;
+
+        void execute(std::coroutine_handle<> h) const { queue->push_back(h); }
+    };
+
+    void run(std::deque<std::coroutine_handle<>>& queue)
+    {
+        while (!queue.empty())
+        {
+            auto h = queue.front();
+            queue.pop_front();
+            h.resume();
+        }
+    }
+
+    template<class Flags>
+    task wait_any(Flags& flags, bitmask::bitmask<conn_state> m, bitmask::bitmask<conn_state>& result)
+    {
+        result = co_await flags.any(m);
+    }
+
+    template<class Flags>
+    task wait_all(Flags& flags, bitmask::bitmask<conn_state> m, bitmask::bitmask<conn_state>& result)
+    {
+        result = co_await flags.all(m);
+    }
+}
+
+TEST_CASE("awaitable_bitmask", "[coroutine]")
+{
+    using bm = bitmask::bitmask<conn_state>;
+
+    bitmask::awaitable_bitmask<conn_state> flags(conn_state::resolved);
+    CHECK(flags.load() == conn_state::resolved);
+
+    // Satisfied conditions don't suspend
+    bm ready;
+    wait_any(flags, conn_state::resolved | conn_state::closed, ready);
+    CHECK(ready == conn_state::resolved);
+
+    bm any, all, closed;
+    wait_any(flags, conn_state::connected | conn_state::closed, any);
+    wait_all(flags, conn_state::connected | conn_state::authenticated, all);
+    wait_any(flags, conn_state::closed, closed);
+    CHECK(!any);
+    CHECK(!all);
+
+    CHECK(flags.set(conn_state::connected) == conn_state::resolved);
+    CHECK(any == (conn_state::resolved | conn_state::connected));
+    CHECK(!all);
+
+    flags.set(conn_state::authenticated);
+    CHECK(all == (conn_state::resolved | conn_state::connected | conn_state::authenticated));
+    CHECK(!closed);
+
+    CHECK(flags.clear(conn_state::resolved | conn_state::authenticated) == (conn_state::resolved | conn_state::connected | conn_state::authenticated));
+    flags.set(conn_state::closed);
+    CHECK(closed == (conn_state::connected | conn_state::closed));
+}
+
+TEST_CASE("awaitable_bitmask resumes on the executor", "[coroutine]")
+{
+    std::deque<std::coroutine_handle<>> queue;
+    bitmask::awaitable_bitmask<conn_state, queue_executor> flags(queue_executor{&queue});
+
+    bitmask::bitmask<conn_state> results[3];
+    wait_any(flags, conn_state::connected, results[0]);
+    wait_all(flags, conn_state::connected | conn_state::closed, results[1]);
+    wait_any(flags, conn_state::connected | conn_state::closed, results[2]);
+
+    flags.set(conn_state::connected);
+    CHECK(queue.size() == 2);
+    CHECK(!results[0]);
+    run(queue);
+    CHECK(results[0] == conn_state::connected);
+    CHECK(!results[1]);
+    CHECK(results[2] == conn_state::connected);
+
+    flags.set(conn_state::closed);
+    CHECK(queue.size() == 1);
+    run(queue);
+    CHECK(results[1] == (conn_state::connected | conn_state::closed));
+}
+
+namespace
+{
+    // Waits for its channel `rounds` times, clearing it every time it's woken
+    task consume(bitmask::awaitable_bitmask<channel>& flags, unsigned ch, unsigned rounds, std::atomic<unsigned>& done)
+    {
+        const auto m = static_cast<channel>(std::uint64_t{1} << ch);
+        for (unsigned i = 0; i != rounds; ++i)
+        {
+            co_await flags.all(m);
+            flags.clear(m);
+        }
+        ++done;
+    }
+}
+
+TEST_CASE("awaitable_bitmask with concurrent setters", "[coroutine]")
+{
+    // Every coroutine waits on its own channel and re-registers after every wake up
+    const unsigned threads = 4;
+    const unsigned channels = 64;
+    const unsigned rounds = 200;
+
+    bitmask::awaitable_bitmask<channel> flags;
+    std::atomic<unsigned> done{0};
+    for (unsigned ch = 0; ch != channels; ++ch)
+        consume(flags, ch, rounds, done);
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            while (done != channels)
+            {
+                for (unsigned ch = t; ch < channels; ch += threads)
+                    flags.set(static_cast<channel>(std::uint64_t{1} << ch));
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t: pool)
+        t.join();
+
+    CHECK(done == channels);
+}
@@ -0,0 +1,82 @@
+#include "catch.hpp"
+
+#include <bitmask/counters.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class request_flag: std::uint16_t
+    {
+        cached = 0x0001,
+        compressed = 0x0002,
+        authenticated = 0x0004,
+        retried = 0x0100,
+
+        _bitmask_value_mask = 0x0107
+    };
+
+    BITMASK_DEFINE(request_flag)
+
+    enum class lane: std::uint64_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF
+    };
+
+    BITMASK_DEFINE(lane)
+}
+
+TEST_CASE("flag_counters", "[counters]")
+{
+    bitmask::flag_counters<request_flag> c(3);
+    CHECK(c.shard_count() == 3);
+    CHECK(c.count(request_flag::retried) == 0);
+
+    c.add(request_flag::cached | request_flag::retried);
+    c.add(request_flag::retried, 5);
+    c.add(nullptr);
+    CHECK(c.count(request_flag::cached) == 1);
+    CHECK(c.count(request_flag::compressed) == 0);
+    CHECK(c.count(request_flag::retried) == 6);
+
+    const auto counts = c.counts();
+    REQUIRE(counts.size() == 4);
+    CHECK(counts[bitmask::flag_index(request_flag::cached)] == 1);
+    CHECK(counts[bitmask::flag_index(request_flag::authenticated)] == 0);
+    CHECK(counts[bitmask::flag_index(request_flag::retried)] == 6);
+
+    c.reset();
+    CHECK(c.count(request_flag::retried) == 0);
+
+    bitmask::flag_counters<request_flag> defaults;
+    CHECK(defaults.shard_count() >= 1);
+}
+
+TEST_CASE("flag_counters from many threads", "[counters]")
+{
+    // More threads than shards, so some of them share a shard
+    const unsigned threads = 6;
+    const std::uint64_t adds = 20000;
+
+    bitmask::flag_counters<lane> c(4);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            const auto m = static_cast<lane>(std::uint64_t{1} << t | std::uint64_t{1} << 63);
+            for (std::uint64_t i = 0; i != adds; ++i)
+                c.add(m);
+        });
+    }
+    for (auto& t: pool)
+        t.join();
+
+    const auto counts = c.counts();
+    for (unsigned t = 0; t != threads; ++t)
+        CHECK(counts[t] == adds);
+    CHECK(counts[6] == 0);
+    CHECK(counts[63] == adds * threads);
+}
@@ -0,0 +1,151 @@
+#include "catch.hpp"
+
+#include <bitmask/event_group.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class io_event: std::uint32_t
+    {
+        readable = 0x01,
+        writable = 0x02,
+        error = 0x04,
+        closed = 0x08,
+
+        _bitmask_max_element = closed
+    };
+
+    BITMASK_DEFINE(io_event)
+
+    enum class token: std::uint64_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF
+    };
+
+    BITMASK_DEFINE(token)
+}
+
+TEST_CASE("event_group", "[event_group]")
+{
+    bitmask::event_group<io_event> g;
+    CHECK(!g.load());
+
+    CHECK(!g.set(io_event::readable));
+    CHECK(g.set(io_event::error) == io_event::readable);
+    CHECK(g.load() == (io_event::readable | io_event::error));
+
+    // Satisfied conditions return immediately
+    CHECK(g.wait_any(io_event::readable | io_event::writable) == (io_event::readable | io_event::error));
+    CHECK(g.wait_all(io_event::readable | io_event::error) == (io_event::readable | io_event::error));
+
+    // Clear on wake consumes only the awaited flags
+    CHECK(g.wait_any(io_event::readable | io_event::closed, true) == (io_event::readable | io_event::error));
+    CHECK(g.load() == io_event::error);
+
+    CHECK(g.clear(io_event::error | io_event::closed) == io_event::error);
+    CHECK(!g.load());
+
+    bitmask::event_group<io_event> initial(io_event::closed);
+    CHECK(initial.load() == io_event::closed);
+}
+
+TEST_CASE("event_group timeouts", "[event_group]")
+{
+    bitmask::event_group<io_event> g(io_event::readable);
+
+    const auto start = std::chrono::steady_clock::now();
+    CHECK(g.wait_any_for(io_event::writable, std::chrono::milliseconds(20)) == io_event::readable);
+    CHECK(g.wait_all_for(io_event::readable | io_event::writable, std::chrono::milliseconds(20), true) == io_event::readable);
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(40));
+    CHECK(g.load() == io_event::readable);
+
+    CHECK(g.wait_any_until(io_event::readable, std::chrono::steady_clock::now(), true) == io_event::readable);
+    CHECK(!g.load());
+    CHECK(!g.wait_all_until(io_event::error, std::chrono::steady_clock::now()));
+
+    std::thread setter([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        g.set(io_event::writable);
+    });
+    CHECK(g.wait_any_for(io_event::writable, std::chrono::seconds(30)) == io_event::writable);
+    setter.join();
+}
+
+TEST_CASE("event_group waiters with different masks", "[event_group]")
+{
+    bitmask::event_group<io_event> g;
+    std::atomic<int> woken_any{0};
+    std::atomic<int> woken_all{0};
+
+    std::thread any_waiter([&] {
+        g.wait_any(io_event::error | io_event::closed);
+        ++woken_any;
+    });
+    std::thread all_waiter([&] {
+        g.wait_all(io_event::readable | io_event::writable);
+        ++woken_all;
+    });
+
+    g.set(io_event::readable);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(woken_any == 0);
+    CHECK(woken_all == 0);
+
+    g.set(io_event::writable);
+    all_waiter.join();
+    CHECK(woken_all == 1);
+    CHECK(woken_any == 0);
+
+    g.set(io_event::closed);
+    any_waiter.join();
+    CHECK(woken_any == 1);
+}
+
+TEST_CASE("event_group clear on wake hands every flag to one waiter", "[event_group]")
+{
+    // Every set flag is consumed by exactly one of the consumers
+    const unsigned consumers = 4;
+    const unsigned rounds = 2000;
+
+    bitmask::event_group<token> g;
+    std::atomic<unsigned> consumed{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != consumers; ++t)
+    {
+        pool.emplace_back([&] {
+            for (;;)
+            {
+                const auto v = g.wait_any(token(1) | token(2), true);
+                if (v & token(2))
+                    return;
+                ++consumed;
+            }
+        });
+    }
+
+    for (unsigned i = 0; i != rounds; ++i)
+    {
+        g.set(token(1));
+        while (g.load() & token(1))
+            std::this_thread::yield();
+    }
+
+    while (consumed != rounds)
+        std::this_thread::yield();
+    for (unsigned t = 0; t != consumers; ++t)
+    {
+        g.set(token(2));
+        while (g.load() & token(2))
+            std::this_thread::yield();
+    }
+    for (auto& t: pool)
+        t.join();
+
+    CHECK(consumed == rounds);
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include <bitmask/format.hpp>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+    enum class open_mode: std::uint8_t
+    {
+        in = 0x01,
+        out = 0x02,
+        binary = 0x04,
+        app = 0x10,
+        trunc = 0x20,
+        noreplace = 0x80,
+
+        _bitmask_value_mask = 0xB7  // 0x80 is in the domain but has no name
+    };
+
+    BITMASK_DEFINE(open_mode)
+    BITMASK_DEFINE_NAMES(open_mode, in, out, binary, app, trunc)
+
+    enum class unnamed: std::uint16_t
+    {
+        a = 0x1,
+        b = 0x2,
+        c = 0x4,
+
+        _bitmask_max_element = c
+    };
+
+    BITMASK_DEFINE(unnamed)
+
+    template<class T>
+    std::string write(const bitmask::bitmask_formatter<T>& f)
+    {
+        char buffer[bitmask::bitmask_formatter<T>::max_size];
+        return std::string(buffer, f.write(buffer));
+    }
+
+    template<class T>
+    std::string stream(const bitmask::bitmask_formatter<T>& f)
+    {
+        std::ostringstream os;
+        os << f;
+        return os.str();
+    }
+}
+
+TEST_CASE("bitmask_formatter styles", "[format]")
+{
+    const auto m = open_mode::in | open_mode::trunc | open_mode::noreplace;
+    CHECK(write(bitmask::as_names(m)) == "in|trunc|0x80");
+    CHECK(write(bitmask::as_hex(m)) == "0xa1");
+    CHECK(write(bitmask::as_binary(m)) == "0b10100001");
+    CHECK(write(bitmask::bitmask_formatter<open_mode>(m)) == "in|trunc|0x80");
+
+    const bitmask::bitmask<open_mode> none;
+    CHECK(write(bitmask::as_names(none)) == "0x0");
+    CHECK(write(bitmask::as_hex(none)) == "0x0");
+    CHECK(write(bitmask::as_binary(none)) == "0b00000000");
+}
+
+TEST_CASE("bitmask_formatter of the bits out of the domain", "[format]")
+{
+    using formatter = bitmask::bitmask_formatter<open_mode>;
+    CHECK(write(formatter(0x41, bitmask::bitmask_format::names)) == "in|!0x40");
+    CHECK(write(formatter(0x41, bitmask::bitmask_format::hex)) == "0x1|!0x40");
+    CHECK(write(formatter(0x41, bitmask::bitmask_format::binary)) == "0b00000001|!0x40");
+    CHECK(write(formatter(0x48, bitmask::bitmask_format::names)) == "!0x48");
+    CHECK(write(formatter(0x48, bitmask::bitmask_format::hex)) == "!0x48");
+    CHECK(write(formatter(0xFF, bitmask::bitmask_format::names)) == "in|out|binary|app|trunc|0x80|!0x48");
+    CHECK(write(formatter(0xFF, bitmask::bitmask_format::names)).size() <= formatter::max_size);
+    CHECK(write(formatter(0xFF, bitmask::bitmask_format::binary)).size() <= formatter::max_size);
+}
+
+TEST_CASE("bitmask_formatter without names", "[format]")
+{
+    const auto m = unnamed::a | unnamed::c;
+    CHECK(write(bitmask::as_names(m)) == "0x5");
+    CHECK(write(bitmask::as_binary(m)) == "0b101");
+}
+
+TEST_CASE("bitmask_formatter operator<<", "[format]")
+{
+    CHECK(stream(bitmask::as_names(open_mode::out | open_mode::app)) == "out|app");
+    CHECK(stream(bitmask::as_hex(open_mode::out | open_mode::app)) == "0x12");
+    CHECK(stream(bitmask::as_binary<unnamed>(unnamed::b)) == "0b010");
+}
@@ -0,0 +1,232 @@
+#include "catch.hpp"
+
+#include <bitmask/hierarchical.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    // Compares every search of `h` with the one over the reference set of its bits
+    template<class Bitmap>
+    std::size_t count_mismatches(const Bitmap& h, const std::set<std::size_t>& ref, const std::vector<std::size_t>& probes)
+    {
+        const std::size_t npos = Bitmap::npos;
+        std::size_t mismatches = 0;
+        mismatches += h.empty() != ref.empty();
+        mismatches += h.find_first() != (ref.empty() ? npos : *ref.begin());
+        mismatches += h.find_last() != (ref.empty() ? npos : *ref.rbegin());
+        for (const std::size_t p: probes)
+        {
+            const auto next = ref.lower_bound(p);
+            mismatches += h.find_next(p) != (next == ref.end() ? npos : *next);
+            const auto prev = ref.upper_bound(p);
+            mismatches += h.find_prev(p) != (prev == ref.begin() ? npos : *std::prev(prev));
+            if (p < h.size())
+                mismatches += h.test(p) != (ref.count(p) != 0);
+        }
+        return mismatches;
+    }
+
+    template<class Bitmap>
+    void check_against_set(std::size_t size)
+    {
+        Bitmap h(size);
+        CHECK(h.size() == size);
+        CHECK(h.empty());
+
+        std::set<std::size_t> ref;
+        std::vector<std::size_t> probes;
+        std::uint64_t random = size + 1;
+        auto next_random = [&] {
+            random = random * 6364136223846793005u + 1442695040888963407u;
+            return static_cast<std::size_t>(random >> 20) % size;
+        };
+
+        for (std::size_t i = 0; i != 16; ++i)
+            probes.push_back(next_random());
+        probes.push_back(0);
+        probes.push_back(size - 1);
+        probes.push_back(size);
+        probes.push_back(size + 100);
+        CHECK(count_mismatches(h, ref, probes) == 0);
+
+        // Bits at both ends of the domain and of the words
+        for (const std::size_t i: {std::size_t{0}, size - 1, size / 2, std::size_t{63} % size, std::size_t{64} % size})
+        {
+            h.set(i);
+            ref.insert(i);
+            probes.push_back(i);
+        }
+        CHECK(count_mismatches(h, ref, probes) == 0);
+
+        for (std::size_t round = 0; round != 200; ++round)
+        {
+            const std::size_t i = next_random();
+            if (round % 3 == 2)
+            {
+                h.clear(*ref.begin());
+                ref.erase(ref.begin());
+            }
+            else
+            {
+                h.set(i);
+                ref.insert(i);
+            }
+        }
+        CHECK(count_mismatches(h, ref, probes) == 0);
+
+        // Clearing everything leaves no summary bits behind
+        for (const std::size_t i: ref)
+            h.clear(i);
+        ref.clear();
+        CHECK(count_mismatches(h, ref, probes) == 0);
+
+        // Clearing a bit that is not set is fine
+        h.clear(size - 1);
+        CHECK(h.empty());
+    }
+}
+
+
+TEST_CASE("hierarchical_bitmap levels", "[hierarchical]")
+{
+    CHECK(bitmask::hierarchical_bitmap(0).levels() == 1);
+    CHECK(bitmask::hierarchical_bitmap(64).levels() == 1);
+    CHECK(bitmask::hierarchical_bitmap(65).levels() == 2);
+    CHECK(bitmask::hierarchical_bitmap(64 * 64).levels() == 2);
+    CHECK(bitmask::hierarchical_bitmap(std::size_t{1} << 18).levels() == 3);
+    CHECK(bitmask::hierarchical_bitmap(std::size_t{1} << 24).levels() == 4);
+
+    bitmask::hierarchical_bitmap empty(0);
+    CHECK(empty.empty());
+    CHECK(empty.find_first() == bitmask::hierarchical_bitmap::npos);
+    CHECK(empty.find_last() == bitmask::hierarchical_bitmap::npos);
+    CHECK(empty.find_next(5) == bitmask::hierarchical_bitmap::npos);
+    CHECK(empty.find_prev(5) == bitmask::hierarchical_bitmap::npos);
+}
+
+TEST_CASE("hierarchical_bitmap searches", "[hierarchical]")
+{
+    for (const std::size_t size: {std::size_t{1}, std::size_t{64}, std::size_t{4097}, std::size_t{1} << 18, std::size_t{1} << 24})
+    {
+        check_against_set<bitmask::hierarchical_bitmap>(size);
+        check_against_set<bitmask::concurrent_hierarchical_bitmap>(size);
+    }
+}
+
+TEST_CASE("hierarchical_bitmap iteration", "[hierarchical]")
+{
+    bitmask::hierarchical_bitmap h(std::size_t{1} << 20);
+    std::vector<std::size_t> bits;
+    for (std::size_t i = 3; i < h.size(); i += 4099)
+    {
+        h.set(i);
+        bits.push_back(i);
+    }
+
+    std::vector<std::size_t> forward;
+    for (std::size_t i = h.find_first(); i != h.npos; i = h.find_next(i + 1))
+        forward.push_back(i);
+    CHECK(forward == bits);
+
+    std::vector<std::size_t> backward;
+    for (std::size_t i = h.find_last(); i != h.npos; i = i ? h.find_prev(i - 1) : h.npos)
+        backward.insert(backward.begin(), i);
+    CHECK(backward == bits);
+}
+
+TEST_CASE("concurrent_hierarchical_bitmap from many threads", "[hierarchical]")
+{
+    // Every thread toggles the bits of its own stripes; the summaries must end up matching the bits
+    const unsigned threads = 4;
+    const std::size_t size = std::size_t{1} << 18;
+    bitmask::concurrent_hierarchical_bitmap h(size);
+
+    h.set(0);
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> bad_finds{0};
+    std::thread searcher([&] {
+        // Bit 0 is never cleared, bits past `size / 2` are never set
+        while (!stop.load())
+        {
+            if (h.find_first() != 0)
+                ++bad_finds;
+            if (h.find_next(size / 2) != h.npos)
+                ++bad_finds;
+        }
+    });
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            for (std::size_t round = 0; round != 50; ++round)
+            {
+                // Neighbouring bits of every stripe share words with other threads
+                for (std::size_t i = 1 + t; i < size / 2; i += 997 * threads)
+                    h.set(i);
+                for (std::size_t i = 1 + t; i < size / 2; i += 997 * threads)
+                    if (round != 49 || i % 2)
+                        h.clear(i);
+            }
+        });
+    }
+    for (auto& th: pool)
+        th.join();
+    stop.store(true);
+    searcher.join();
+    CHECK(bad_finds.load() == 0);
+
+    std::set<std::size_t> ref{0};
+    for (unsigned t = 0; t != threads; ++t)
+        for (std::size_t i = 1 + t; i < size / 2; i += 997 * threads)
+            if (i % 2 == 0)
+                ref.insert(i);
+
+    std::vector<std::size_t> found;
+    for (std::size_t i = h.find_first(); i != h.npos; i = h.find_next(i + 1))
+        found.push_back(i);
+    CHECK(found == std::vector<std::size_t>(ref.begin(), ref.end()));
+}
+
+TEST_CASE("concurrent_hierarchical_bitmap set is visible on return", "[hierarchical]")
+{
+    // The other threads keep setting bits of the word of `base`, that this thread keeps emptying. A `set(base)`
+    // that meets a word made non-empty by another thread must still get the upper levels set before it returns.
+    const unsigned threads = 3;
+    const std::size_t size = std::size_t{1} << 18;
+    const std::size_t base = 64 * 2049;
+    bitmask::concurrent_hierarchical_bitmap h(size);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t != threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            while (!stop.load(std::memory_order_relaxed))
+                h.set(base + 1 + t);
+        });
+    }
+
+    std::size_t misses = 0;
+    for (int round = 0; round != 200000; ++round)
+    {
+        for (unsigned t = 0; t != threads; ++t)
+            h.clear(base + 1 + t);
+        h.set(base);
+        misses += h.find_first() != base;
+        h.clear(base);
+    }
+    stop.store(true);
+    for (auto& th: pool)
+        th.join();
+    CHECK(misses == 0);
+}
@@ -0,0 +1,88 @@
+#include "catch.hpp"
+
+#include <bitmask/mailbox.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class loop_signal: std::uint8_t
+    {
+        reload_config = 0x01,
+        timer = 0x02,
+        new_work = 0x04,
+        shutdown = 0x80,
+
+        _bitmask_value_mask = 0x87
+    };
+
+    BITMASK_DEFINE(loop_signal)
+
+    enum class producer_bit: std::uint64_t
+    {
+        _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF
+    };
+
+    BITMASK_DEFINE(producer_bit)
+}
+
+TEST_CASE("flag_mailbox", "[mailbox]")
+{
+    bitmask::flag_mailbox<loop_signal> mb;
+    CHECK(!mb.try_drain());
+    CHECK(!mb.pending());
+
+    CHECK(!mb.post(loop_signal::timer));
+    CHECK(mb.post(loop_signal::timer | loop_signal::new_work) == loop_signal::timer);
+    CHECK(mb.pending() == (loop_signal::timer | loop_signal::new_work));
+
+    CHECK(mb.drain() == (loop_signal::timer | loop_signal::new_work));
+    CHECK(!mb.pending());
+
+    CHECK(!mb.drain_for(std::chrono::milliseconds(10)));
+    mb.post(loop_signal::shutdown);
+    CHECK(mb.drain_until(std::chrono::steady_clock::now()) == loop_signal::shutdown);
+    CHECK(!mb.try_drain());
+}
+
+TEST_CASE("flag_mailbox with many producers", "[mailbox]")
+{
+    // Every producer posts its own flag and waits until the consumer has seen it; no post may get lost
+    const unsigned producers = 8;
+    const unsigned rounds = 500;
+
+    bitmask::flag_mailbox<producer_bit> mb;
+    std::vector<std::atomic<unsigned>> seen(producers);
+    std::vector<std::thread> pool;
+    for (unsigned p = 0; p != producers; ++p)
+    {
+        pool.emplace_back([&, p] {
+            const auto flag = static_cast<producer_bit>(std::uint64_t{1} << p);
+            for (unsigned r = 0; r != rounds; ++r)
+            {
+                mb.post(flag);
+                while (seen[p] == r)
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    unsigned drained = 0;
+    while (drained != producers * rounds)
+    {
+        for (const auto flag: mb.drain())
+        {
+            ++seen[bitmask::bitmask_detail::lowest_bit_index(static_cast<std::uint64_t>(flag))];
+            ++drained;
+        }
+    }
+    for (auto& t: pool)
+        t.join();
+
+    CHECK(drained == producers * rounds);
+}
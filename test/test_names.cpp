@@ -0,0 +1,208 @@
+#include "catch.hpp"
+
+#include <bitmask/names.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+namespace
+{
+    enum class open_mode: std::uint8_t
+    {
+        in = 0x01,
+        out = 0x02,
+        binary = 0x04,
+        app = 0x10,
+        trunc = 0x20,
+        noreplace = 0x80,
+
+        _bitmask_value_mask = 0xB7  // 0x80 is in the domain but has no name
+    };
+
+    BITMASK_DEFINE(open_mode)
+    BITMASK_DEFINE_NAMES(open_mode, in, out, binary, app, trunc)
+
+    enum class wide: std::uint64_t
+    {
+        f00 = 1ull << 0, f01 = 1ull << 1, f02 = 1ull << 2, f03 = 1ull << 3, f04 = 1ull << 4, f05 = 1ull << 5,
+        f06 = 1ull << 6, f07 = 1ull << 7, f08 = 1ull << 8, f09 = 1ull << 9, f10 = 1ull << 10, f11 = 1ull << 11,
+        f12 = 1ull << 12, f13 = 1ull << 13, f14 = 1ull << 14, f15 = 1ull << 15, f16 = 1ull << 16, f17 = 1ull << 17,
+        f18 = 1ull << 18, f19 = 1ull << 19, f20 = 1ull << 20, f21 = 1ull << 21, f22 = 1ull << 22, f23 = 1ull << 23,
+        f24 = 1ull << 24, f25 = 1ull << 25, f26 = 1ull << 26, f27 = 1ull << 27, f28 = 1ull << 28, f29 = 1ull << 29,
+        f30 = 1ull << 30, f31 = 1ull << 31, f32 = 1ull << 32, f33 = 1ull << 33, f34 = 1ull << 34, f35 = 1ull << 35,
+        f36 = 1ull << 36, f37 = 1ull << 37, f38 = 1ull << 38, f39 = 1ull << 39, f40 = 1ull << 40, f41 = 1ull << 41,
+        f42 = 1ull << 42, f43 = 1ull << 43, f44 = 1ull << 44, f45 = 1ull << 45, f46 = 1ull << 46, f47 = 1ull << 47,
+        f48 = 1ull << 48, f49 = 1ull << 49, f50 = 1ull << 50, f51 = 1ull << 51, f52 = 1ull << 52, f53 = 1ull << 53,
+        f54 = 1ull << 54, f55 = 1ull << 55, f56 = 1ull << 56, f57 = 1ull << 57, f58 = 1ull << 58, f59 = 1ull << 59,
+        f60 = 1ull << 60, f61 = 1ull << 61, f62 = 1ull << 62, f63 = 1ull << 63,
+
+        _bitmask_value_mask = ~0ull
+    };
+
+    BITMASK_DEFINE(wide)
+    BITMASK_DEFINE_NAMES(wide,
+        f00, f01, f02, f03, f04, f05, f06, f07, f08, f09, f10, f11, f12, f13, f14, f15,
+        f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31,
+        f32, f33, f34, f35, f36, f37, f38, f39, f40, f41, f42, f43, f44, f45, f46, f47,
+        f48, f49, f50, f51, f52, f53, f54, f55, f56, f57, f58, f59, f60, f61, f62, f63)
+
+    // Names that take one, two and three chunks of the hash
+    enum class cache_control: std::uint8_t
+    {
+        no_cache = 0x01,
+        immutable = 0x02,
+        proxy_revalidate = 0x04,
+        stale_while_revalidate = 0x08,
+
+        _bitmask_max_element = stale_while_revalidate
+    };
+
+    BITMASK_DEFINE(cache_control)
+    BITMASK_DEFINE_NAMES(cache_control, no_cache, immutable, proxy_revalidate, stale_while_revalidate)
+
+    template<class T>
+    std::string format(const bitmask::bitmask<T>& m)
+    {
+        char buffer[bitmask::max_formatted_size<T>::value];
+        return std::string(buffer, bitmask::format_to(buffer, m));
+    }
+}
+
+static_assert(bitmask::name_of(open_mode::binary)[0] == 'b', "Names are available at compile time");
+static_assert(bitmask::name_of(open_mode::noreplace) == nullptr, "");
+static_assert(bitmask::max_formatted_size<open_mode>::value >= sizeof("in|out|binary|app|trunc|0x80") - 1, "");
+
+TEST_CASE("name_of", "[names]")
+{
+    CHECK(std::strcmp(bitmask::name_of(open_mode::in), "in") == 0);
+    CHECK(std::strcmp(bitmask::name_of(open_mode::trunc), "trunc") == 0);
+    CHECK(bitmask::name_of(open_mode::noreplace) == nullptr);
+    CHECK(std::strcmp(bitmask::name_of(wide::f63), "f63") == 0);
+}
+
+TEST_CASE("parse", "[names]")
+{
+    auto r = bitmask::parse<open_mode>("in|out|binary");
+    CHECK(r);
+    CHECK(r.error == nullptr);
+    CHECK(r.value == (open_mode::in | open_mode::out | open_mode::binary));
+
+    CHECK(bitmask::parse<open_mode>(" app |\ttrunc ").value == (open_mode::app | open_mode::trunc));
+    CHECK(bitmask::parse<open_mode>("in|in").value == open_mode::in);
+    CHECK(bitmask::parse<open_mode>("app|0x80").value == (open_mode::app | open_mode::noreplace));
+
+    // An empty or blank string is an empty bitmask
+    CHECK(bitmask::parse<open_mode>("").value == bitmask::bitmask<open_mode>());
+    CHECK(bitmask::parse<open_mode>("  "));
+
+    // Only a part of the string
+    const char text[] = "binary|garbage";
+    CHECK(bitmask::parse<open_mode>(text, 6).value == open_mode::binary);
+}
+
+TEST_CASE("parse errors", "[names]")
+{
+    const char text[] = "in|bogus|out";
+    auto r = bitmask::parse<open_mode>(text);
+    CHECK_FALSE(r);
+    CHECK(r.error == text + 3);
+
+    CHECK_FALSE(bitmask::parse<open_mode>("in||out"));
+    CHECK_FALSE(bitmask::parse<open_mode>("in|"));
+    CHECK_FALSE(bitmask::parse<open_mode>("|in"));
+    CHECK_FALSE(bitmask::parse<open_mode>("In"));
+    CHECK_FALSE(bitmask::parse<open_mode>("i"));
+    CHECK_FALSE(bitmask::parse<open_mode>("inn"));
+    CHECK_FALSE(bitmask::parse<open_mode>("in out"));
+    CHECK_FALSE(bitmask::parse<open_mode>("0x40"));  // Out of the domain
+    CHECK_FALSE(bitmask::parse<open_mode>("0x100"));  // Out of the underlying type
+    CHECK_FALSE(bitmask::parse<open_mode>("0x"));
+    CHECK_FALSE(bitmask::parse<open_mode>("0xg"));
+}
+
+TEST_CASE("format_to", "[names]")
+{
+    CHECK(format(bitmask::bitmask<open_mode>()) == "");
+    CHECK(format<open_mode>(open_mode::out) == "out");
+    CHECK(format(open_mode::trunc | open_mode::in | open_mode::binary) == "in|binary|trunc");
+    CHECK(format(open_mode::noreplace | open_mode::app) == "app|0x80");
+    CHECK(format<open_mode>(open_mode::noreplace) == "0x80");
+
+    const auto all = ~bitmask::bitmask<open_mode>();
+    CHECK(format(all) == "in|out|binary|app|trunc|0x80");
+    CHECK(bitmask::parse<open_mode>(format(all).c_str()).value == all);
+}
+
+TEST_CASE("names of a full 64-bit domain", "[names]")
+{
+    // Every name must land in a slot of its own
+    const auto all = ~bitmask::bitmask<wide>();
+    const std::string text = format(all);
+    CHECK(text.size() == 64 * 4 - 1);
+    CHECK(bitmask::parse<wide>(text.c_str()).value == all);
+
+    std::size_t mismatches = 0;
+    for (int i = 0; i != 64; ++i)
+    {
+        const auto flag = static_cast<wide>(std::uint64_t{1} << i);
+        mismatches += bitmask::parse<wide>(bitmask::name_of(flag)).value != flag;
+    }
+    CHECK(mismatches == 0);
+
+    CHECK(format(wide::f01 | wide::f62) == "f01|f62");
+    CHECK_FALSE(bitmask::parse<wide>("f64"));
+}
+
+static_assert(BITMASK_LITERAL(open_mode, "app|binary") == (open_mode::app | open_mode::binary), "");
+static_assert(BITMASK_LITERAL(open_mode, " in |\tout ") == (open_mode::in | open_mode::out), "");
+static_assert(BITMASK_LITERAL(open_mode, "trunc|0x80") == (open_mode::trunc | open_mode::noreplace), "");
+static_assert(BITMASK_LITERAL(open_mode, "") == bitmask::bitmask<open_mode>(), "");
+static_assert(BITMASK_LITERAL(wide, "f00|f31|f63") == (wide::f00 | wide::f31 | wide::f63), "");
+
+TEST_CASE("parse_literal", "[names]")
+{
+    constexpr auto mode = bitmask::parse_literal<open_mode>("out|trunc");
+    CHECK(mode == (open_mode::out | open_mode::trunc));
+
+    // The same as `parse()` whenever it runs
+    const char* const texts[] = {"in", "in|out|binary|app|trunc", " app ", "0x80|in", "", "f00|f63"};
+    std::size_t mismatches = 0;
+    for (const char* text: texts)
+    {
+        const auto r = bitmask::parse<open_mode>(text);
+        if (r)
+            mismatches += r.value != bitmask::bitmask_detail::to_enum<open_mode>(
+                bitmask::bitmask_detail::parse_constant<open_mode>(text, std::strlen(text)));
+    }
+    CHECK(mismatches == 0);
+}
+
+static_assert(BITMASK_LITERAL(cache_control, "proxy_revalidate|stale_while_revalidate")
+                  == (cache_control::proxy_revalidate | cache_control::stale_while_revalidate), "");
+
+TEST_CASE("parse_literal of long names", "[names]")
+{
+    using cc = cache_control;
+    constexpr auto all = bitmask::parse_literal<cc>("no_cache|immutable|proxy_revalidate|stale_while_revalidate");
+    CHECK(all == (cc::no_cache | cc::immutable | cc::proxy_revalidate | cc::stale_while_revalidate));
+
+    const char* const texts[] = {"no_cache", "immutable", "proxy_revalidate", "stale_while_revalidate",
+                                 "immutable|stale_while_revalidate", "no_cache|immutable|proxy_revalidate|stale_while_revalidate"};
+    std::size_t failures = 0;
+    std::size_t mismatches = 0;
+    for (const char* text: texts)
+    {
+        const auto r = bitmask::parse<cc>(text);
+        failures += !r;
+        mismatches += r.value != bitmask::bitmask_detail::to_enum<cc>(
+            bitmask::bitmask_detail::parse_constant<cc>(text, std::strlen(text)));
+        mismatches += format(r.value) != text;
+    }
+    CHECK(failures == 0);
+    CHECK(mismatches == 0);
+
+    CHECK(!bitmask::parse<cc>("proxy_revalidatf"));
+    CHECK(!bitmask::parse<cc>("stale_while_revalidat"));
+}
@@ -0,0 +1,212 @@
+#include "catch.hpp"
+
+#include <bitmask/posting_index.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class trait: std::uint16_t
+    {
+        rare = 0x0001,
+        common = 0x0004,
+        clustered = 0x0100,
+        everywhere = 0x8000,
+
+        _bitmask_value_mask = 0x8105
+    };
+
+    BITMASK_DEFINE(trait)
+
+    using rows = std::vector<std::uint32_t>;
+
+    const std::uint32_t row_count = 300000;
+
+    // Sets that end up in the different container types
+    rows sparse_rows(std::uint32_t seed)
+    {
+        std::mt19937 gen{seed};
+        rows result;
+        for (std::uint32_t r = 0; r < row_count; r += 1 + gen() % 500)
+            result.push_back(r);
+        return result;
+    }
+
+    rows dense_rows(std::uint32_t seed)
+    {
+        std::mt19937 gen{seed};
+        rows result;
+        for (std::uint32_t r = 0; r != row_count; ++r)
+        {
+            if (gen() % 2)
+                result.push_back(r);
+        }
+        return result;
+    }
+
+    rows run_rows(std::uint32_t seed)
+    {
+        std::mt19937 gen{seed};
+        rows result;
+        for (std::uint32_t r = gen() % 1000; r < row_count; r += 1000 + gen() % 20000)
+        {
+            for (std::uint32_t end = (std::min)(row_count, static_cast<std::uint32_t>(r + gen() % 5000)); r != end; ++r)
+                result.push_back(r);
+        }
+        return result;
+    }
+
+    bitmask::row_set make_set(const rows& v)
+    {
+        bitmask::row_set s;
+        for (auto r : v)
+            s.append(r);
+        s.optimize();
+        return s;
+    }
+
+    template<class Op>
+    rows reference(const rows& l, const rows& r, Op op)
+    {
+        rows result;
+        op(l.begin(), l.end(), r.begin(), r.end(), std::back_inserter(result));
+        return result;
+    }
+
+    void check_set_ops(const rows& a, const rows& b)
+    {
+        using it = rows::const_iterator;
+        using out = std::back_insert_iterator<rows>;
+
+        const auto sa = make_set(a), sb = make_set(b);
+        CHECK(sa.cardinality() == a.size());
+        CHECK((sa.to_vector() == a));
+
+        const auto expected_and = reference(a, b, std::set_intersection<it, it, out>);
+        const auto expected_or = reference(a, b, std::set_union<it, it, out>);
+        const auto expected_andnot = reference(a, b, std::set_difference<it, it, out>);
+
+        const auto s_and = sa & sb;
+        const auto s_or = sa | sb;
+        const auto s_andnot = sa - sb;
+
+        CHECK(s_and.cardinality() == expected_and.size());
+        CHECK(s_or.cardinality() == expected_or.size());
+        CHECK(s_andnot.cardinality() == expected_andnot.size());
+        CHECK((s_and.to_vector() == expected_and));
+        CHECK((s_or.to_vector() == expected_or));
+        CHECK((s_andnot.to_vector() == expected_andnot));
+        CHECK((s_and == make_set(expected_and)));
+    }
+}
+
+TEST_CASE("row_set", "[posting_index]")
+{
+    bitmask::row_set s;
+    CHECK(s.empty());
+    CHECK(s.cardinality() == 0);
+
+    for (std::uint32_t r : {1u, 5u, 6u, 7u, 70000u, 4000000000u})
+        s.append(r);
+    s.optimize();
+    CHECK(s.cardinality() == 6);
+    CHECK(s.contains(6));
+    CHECK(s.contains(70000));
+    CHECK(s.contains(4000000000u));
+    CHECK_FALSE(s.contains(8));
+    CHECK_FALSE(s.contains(70001));
+
+    const auto r = bitmask::row_set::range(3, 200000);
+    CHECK(r.cardinality() == 199997);
+    CHECK(r.contains(3));
+    CHECK(r.contains(65536));
+    CHECK(r.contains(199999));
+    CHECK_FALSE(r.contains(200000));
+    CHECK((s & r).to_vector() == (rows{5, 6, 7, 70000}));
+    CHECK((s - r).to_vector() == (rows{1, 4000000000u}));
+    CHECK(bitmask::row_set::range(0, 0).empty());
+
+    // Runs compress far better than the array or bitmap of the same rows
+    CHECK(r.size_in_bytes() < 1024);
+
+    // Runs of 3 that overlap by one row at both ends intersect into single rows, which an array holds in half the space
+    rows threes_a, threes_b;
+    for (std::uint32_t i = 0; i < 4000; i += 4)
+    {
+        threes_a.insert(threes_a.end(), {i, i + 1, i + 2});
+        threes_b.insert(threes_b.end(), {i + 2, i + 3, i + 4});
+    }
+    const auto singles = make_set(threes_a) & make_set(threes_b);
+    CHECK(singles.cardinality() == 1999);
+    CHECK(singles.size_in_bytes() <= make_set(reference(threes_a, threes_b,
+        std::set_intersection<rows::const_iterator, rows::const_iterator, std::back_insert_iterator<rows>>)).size_in_bytes());
+
+    const rows sets[] = {sparse_rows(1), sparse_rows(2), dense_rows(3), dense_rows(4), run_rows(5), run_rows(6)};
+    for (const auto& a : sets)
+    {
+        for (const auto& b : sets)
+            check_set_ops(a, b);
+    }
+}
+
+TEST_CASE("bitmask_posting_index", "[posting_index]")
+{
+    using bm = bitmask::bitmask<trait>;
+
+    std::mt19937 gen{17};
+    std::vector<bm> column(row_count);
+    for (std::uint32_t i = 0; i != row_count; ++i)
+    {
+        bm m = trait::everywhere;
+        if (gen() % 1000 == 0)
+            m |= trait::rare;
+        if (gen() % 3 == 0)
+            m |= trait::common;
+        if ((i / 10000) % 4 == 0)
+            m |= trait::clustered;
+        column[i] = m;
+    }
+    column[123] = bm{};
+
+    const bitmask::bitmask_posting_index<trait> index(column.data(), column.data() + column.size());
+    CHECK(index.size() == row_count);
+
+    const bm queries[][2] = {
+        {trait::rare, bm{}},
+        {trait::rare | trait::common, trait::clustered},
+        {trait::clustered, trait::common},
+        {bm{}, trait::everywhere},
+        {bm{}, bm{}},
+        {trait::everywhere, trait::rare | trait::common},
+    };
+
+    for (const auto& q : queries)
+    {
+        rows expected;
+        for (std::uint32_t i = 0; i != row_count; ++i)
+        {
+            if (column[i].contains_all(q[0]) && column[i].contains_none(q[1]))
+                expected.push_back(i);
+        }
+        CHECK((index.select(q[0], q[1]).to_vector() == expected));
+        CHECK(index.count(q[0], q[1]) == expected.size());
+    }
+
+    rows expected_any;
+    for (std::uint32_t i = 0; i != row_count; ++i)
+    {
+        if (column[i].contains_any(trait::rare | trait::clustered))
+            expected_any.push_back(i);
+    }
+    CHECK((index.select_any(trait::rare | trait::clustered).to_vector() == expected_any));
+    CHECK(index.postings(trait::everywhere).cardinality() == row_count - 1);
+
+    // Rare flags take a small fraction of a bitmap per flag
+    CHECK(index.postings(trait::rare).size_in_bytes() < row_count / 8 / 4);
+    CHECK(index.postings(trait::clustered).size_in_bytes() < 1024);
+}
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include <bitmask/replicated.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class feature: std::uint32_t
+    {
+        new_parser = 0x01,
+        fast_path = 0x02,
+        tracing = 0x04,
+
+        _bitmask_max_element = tracing
+    };
+
+    BITMASK_DEFINE(feature)
+
+    enum class shard
+    {
+        first = 0,
+        last = 511
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(shard, last)
+}
+
+TEST_CASE("replicated_bitmask", "[replicated]")
+{
+    bitmask::replicated_bitmask<feature> f(feature::fast_path, 3);
+    CHECK(f.slot_count() == 4);
+    CHECK(f.load() == feature::fast_path);
+    CHECK(f.generation() == 0);
+
+    CHECK(f.set(feature::tracing) == feature::fast_path);
+    CHECK(f.load() == (feature::fast_path | feature::tracing));
+    CHECK(f.clear(feature::fast_path) == (feature::fast_path | feature::tracing));
+    CHECK(f.load() == feature::tracing);
+    f.store(feature::new_parser);
+    CHECK(f.modify([](bitmask::bitmask<feature>& v) { v = ~v; }) == feature::new_parser);
+    CHECK(f.load() == (feature::fast_path | feature::tracing));
+    CHECK(f.generation() == 4);
+
+    // Every slot has the value, whichever thread reads it
+    std::vector<std::thread> pool;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t != 5; ++t)
+        pool.emplace_back([&] { mismatches += f.load() != (feature::fast_path | feature::tracing); });
+    for (auto& t: pool)
+        t.join();
+    CHECK(mismatches == 0);
+
+    bitmask::replicated_bitmask<feature> defaults;
+    CHECK(defaults.slot_count() >= 1);
+    CHECK(!defaults.load());
+}
+
+TEST_CASE("replicated_bitmask of bit index bitmask", "[replicated]")
+{
+    using bm = bitmask::bitmask<shard>;
+
+    // The writer flips between two values that differ in every word; readers must never see a mix of them
+    bm even, odd;
+    for (int i = 0; i <= 511; i += 2)
+    {
+        even |= static_cast<shard>(i);
+        odd |= static_cast<shard>(i + 1);
+    }
+
+    bitmask::replicated_bitmask<shard> r(even, 2);
+    CHECK(r.load() == even);
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t != 3; ++t)
+    {
+        readers.emplace_back([&] {
+            do
+            {
+                const bm v = r.load();
+                torn += v != even && v != odd;
+            }
+            while (!stop);
+        });
+    }
+
+    for (int i = 0; i != 2000; ++i)
+        r.modify([&](bm& v) { v = v == even ? odd : even; });
+    stop = true;
+    for (auto& t: readers)
+        t.join();
+
+    CHECK(torn == 0);
+    CHECK(r.load() == even);
+    CHECK(r.generation() == 2000);
+}
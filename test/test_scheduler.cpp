@@ -0,0 +1,141 @@
+#include "catch.hpp"
+
+#include <bitmask/scheduler.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class priority: std::uint8_t
+    {
+        idle = 0x01,
+        normal = 0x04,
+        high = 0x10,
+        realtime = 0x80,
+
+        _bitmask_value_mask = 0x95
+    };
+
+    BITMASK_DEFINE(priority)
+
+    struct task: bitmask::run_queue_hook
+    {
+        explicit task(int i = 0): id(i) {}
+        int id;
+    };
+
+    template<class Queue>
+    std::vector<int> drain(Queue& q)
+    {
+        std::vector<int> ids;
+        while (task* t = q.pop_highest())
+            ids.push_back(t->id);
+        return ids;
+    }
+}
+
+TEST_CASE("priority_run_queue", "[scheduler]")
+{
+    bitmask::priority_run_queue<priority, task> q;
+    CHECK(q.empty());
+    CHECK(q.pop_highest() == nullptr);
+
+    task tasks[8] = {task(0), task(1), task(2), task(3), task(4), task(5), task(6), task(7)};
+    q.push(priority::normal, tasks[0]);
+    q.push(priority::idle, tasks[1]);
+    q.push(priority::realtime, tasks[2]);
+    q.push(priority::normal, tasks[3]);
+    q.push(priority::high, tasks[4]);
+    q.push(priority::realtime, tasks[5]);
+    CHECK_FALSE(q.empty());
+    CHECK(q.ready() == (priority::idle | priority::normal | priority::high | priority::realtime));
+
+    // Highest level first, pushing order within a level
+    CHECK(drain(q) == (std::vector<int>{2, 5, 4, 0, 3, 1}));
+    CHECK(q.empty());
+    CHECK(q.ready() == bitmask::bitmask<priority>());
+
+    // Popped tasks may be queued again and a level that got empty starts over
+    q.push(priority::high, tasks[4]);
+    q.push(priority::idle, tasks[6]);
+    CHECK(q.pop_highest() == &tasks[4]);
+    q.push(priority::high, tasks[7]);
+    q.push(priority::high, tasks[4]);
+    CHECK(drain(q) == (std::vector<int>{7, 4, 6}));
+}
+
+TEST_CASE("work_stealing_scheduler", "[scheduler]")
+{
+    bitmask::work_stealing_scheduler<priority, task> s(3);
+    CHECK(s.worker_count() == 3);
+    CHECK(s.pop(0) == nullptr);
+
+    task tasks[4] = {task(0), task(1), task(2), task(3)};
+    s.push(0, priority::idle, tasks[0]);
+    s.push(1, priority::normal, tasks[1]);
+    s.push(2, priority::realtime, tasks[2]);
+    s.push(2, priority::high, tasks[3]);
+    CHECK(s.ready() == (priority::idle | priority::normal | priority::high | priority::realtime));
+
+    // Own queue first, even if the others have more urgent tasks
+    CHECK(s.pop(0) == &tasks[0]);
+    // Then the highest level of all the others
+    CHECK(s.pop(0) == &tasks[2]);
+    CHECK(s.pop(0) == &tasks[3]);
+    CHECK(s.steal(1) == nullptr);
+    CHECK(s.pop(2) == &tasks[1]);
+    CHECK(s.pop(1) == nullptr);
+    CHECK_FALSE(s.ready());
+}
+
+TEST_CASE("work_stealing_scheduler from many threads", "[scheduler]")
+{
+    // Every task must be taken exactly once whoever pushes and pops it
+    const unsigned workers = 4;
+    const int per_worker = 5000;
+    const priority levels[] = {priority::idle, priority::normal, priority::high, priority::realtime};
+
+    bitmask::work_stealing_scheduler<priority, task> s(workers);
+    std::vector<task> tasks(workers * per_worker);
+    for (std::size_t i = 0; i != tasks.size(); ++i)
+        tasks[i].id = static_cast<int>(i);
+    std::vector<std::atomic<int>> taken(tasks.size());
+    std::atomic<int> remaining{static_cast<int>(tasks.size())};
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w != workers; ++w)
+    {
+        pool.emplace_back([&, w] {
+            // Only the even workers push, so the odd ones live on stealing
+            if (w % 2 == 0)
+            {
+                for (int i = 0; i != 2 * per_worker; ++i)
+                {
+                    const std::size_t t = (w / 2) * 2 * per_worker + static_cast<std::size_t>(i);
+                    s.push(w, levels[i % 4], tasks[t]);
+                }
+            }
+            while (remaining.load() > 0)
+            {
+                if (task* t = s.pop(w))
+                {
+                    taken[static_cast<std::size_t>(t->id)].fetch_add(1);
+                    remaining.fetch_sub(1);
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t: pool)
+        t.join();
+
+    CHECK(remaining.load() == 0);
+    CHECK(std::all_of(taken.begin(), taken.end(), [](const std::atomic<int>& n) { return n.load() == 1; }));
+    CHECK(s.pop(0) == nullptr);
+}
@@ -0,0 +1,237 @@
+#include "catch.hpp"
+
+#include <bitmask/schema.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+    // The flags as the previous release stored them
+    namespace v1
+    {
+        enum class perm: std::uint16_t
+        {
+            read = 0x01,
+            write = 0x02,
+            exec = 0x04,
+            sticky = 0x08,
+            setuid = 0x10,
+            reserved = 0x20,
+
+            _bitmask_max_element = reserved
+        };
+
+        BITMASK_DEFINE(perm)
+        BITMASK_DEFINE_NAMES(perm, read, write, exec, sticky, setuid)
+    }
+
+    // A flag is added
+    namespace v2_added
+    {
+        enum class perm: std::uint16_t
+        {
+            read = 0x01,
+            write = 0x02,
+            exec = 0x04,
+            sticky = 0x08,
+            setuid = 0x10,
+            reserved = 0x20,
+            append = 0x40,
+
+            _bitmask_max_element = append
+        };
+
+        BITMASK_DEFINE(perm)
+        BITMASK_DEFINE_NAMES(perm, read, write, exec, sticky, setuid, append)
+    }
+
+    // `exec` is dropped and the rest keep their order
+    namespace v2_dropped
+    {
+        enum class perm: std::uint16_t
+        {
+            read = 0x01,
+            write = 0x02,
+            sticky = 0x04,
+            setuid = 0x08,
+
+            _bitmask_max_element = setuid
+        };
+
+        BITMASK_DEFINE(perm)
+        BITMASK_DEFINE_NAMES(perm, read, write, sticky, setuid)
+    }
+
+    // Renumbered and widened
+    namespace v2_renumbered
+    {
+        enum class perm: std::uint32_t
+        {
+            setuid = 1u << 0,
+            exec = 1u << 3,
+            write = 1u << 9,
+            read = 1u << 10,
+            sticky = 1u << 31,
+
+            _bitmask_value_mask = setuid | exec | write | read | sticky
+        };
+
+        BITMASK_DEFINE(perm)
+        BITMASK_DEFINE_NAMES(perm, setuid, exec, write, read, sticky)
+    }
+
+    // Names of more than one hash chunk
+    namespace long_names
+    {
+        enum class perm: std::uint8_t
+        {
+            read = 0x01,
+            executable = 0x02,
+            set_user_id_on_execution = 0x04,
+
+            _bitmask_max_element = set_user_id_on_execution
+        };
+
+        BITMASK_DEFINE(perm)
+        BITMASK_DEFINE_NAMES(perm, read, executable, set_user_id_on_execution)
+    }
+
+    using bytes = std::vector<unsigned char>;
+
+    // The dictionary and the records of every combination of the v1 flags
+    bytes v1_file()
+    {
+        bytes file(bitmask::schema_size<v1::perm>::value + 64 * 2);
+        unsigned char* out = bitmask::write_schema<v1::perm>(file.data());
+        for (std::uint16_t bits = 0; bits != 64; ++bits)
+            out = bitmask::encode_fixed(out, bitmask::bitmask<v1::perm>(static_cast<v1::perm>(bits)));
+        CHECK(out == file.data() + file.size());
+        return file;
+    }
+
+    template<class T>
+    std::vector<bitmask::bitmask<T>> load(const bytes& file, bitmask::unknown_flags unknown = bitmask::unknown_flags::drop)
+    {
+        bitmask::schema_remap<T> remap;
+        const auto header = remap.read_schema(file.data(), file.data() + file.size(), unknown);
+        REQUIRE(header);
+        CHECK(header.next == file.data() + bitmask::schema_size<v1::perm>::value);
+
+        std::vector<bitmask::bitmask<T>> records(64);
+        const auto r = remap.decode(header.next, file.data() + file.size(), records.data(), records.data() + records.size());
+        CHECK(r);
+        CHECK(r.count == 64);
+
+        // The same one at a time
+        const unsigned char* in = header.next;
+        std::size_t mismatches = 0;
+        for (const auto& record: records)
+        {
+            const auto one = remap.decode(in, file.data() + file.size());
+            mismatches += !one || one.value != record;
+            in = one.next;
+        }
+        CHECK(mismatches == 0);
+        return records;
+    }
+}
+
+static_assert(bitmask::schema_size<v1::perm>::value == 2 + 6 * 2 + 4 + 5 + 4 + 6 + 6, "");
+
+TEST_CASE("write_schema", "[schema]")
+{
+    bytes schema(bitmask::schema_size<v1::perm>::value);
+    CHECK(bitmask::write_schema<v1::perm>(schema.data()) == schema.data() + schema.size());
+    CHECK(schema[0] == 2);  // The word size
+    CHECK(schema[1] == 6);  // Flags
+    CHECK(bytes(schema.begin() + 2, schema.begin() + 8) == (bytes{0, 4, 'r', 'e', 'a', 'd'}));
+    CHECK(bytes(schema.end() - 2, schema.end()) == (bytes{5, 0}));  // `reserved` has no name
+}
+
+TEST_CASE("schema_remap of the same schema", "[schema]")
+{
+    const auto records = load<v1::perm>(v1_file());
+    for (std::uint16_t bits = 0; bits != 64; ++bits)
+        CHECK(records[bits].bits() == bits);
+}
+
+TEST_CASE("schema_remap of added flags", "[schema]")
+{
+    const auto records = load<v2_added::perm>(v1_file());
+    for (std::uint16_t bits = 0; bits != 64; ++bits)
+        CHECK(records[bits].bits() == bits);
+}
+
+TEST_CASE("schema_remap of dropped flags", "[schema]")
+{
+    using v2_dropped::perm;
+    const auto records = load<perm>(v1_file());
+    CHECK(records[0x01] == perm::read);
+    CHECK(records[0x04] == bitmask::bitmask<perm>());
+    CHECK(records[0x0D] == (perm::read | perm::sticky));
+    CHECK(records[0x3F] == (perm::read | perm::write | perm::sticky | perm::setuid));
+
+    // `exec` and the unnamed flag fail the records that have them
+    bitmask::schema_remap<perm> remap;
+    const bytes file = v1_file();
+    const auto header = remap.read_schema(file.data(), file.data() + file.size(), bitmask::unknown_flags::fail);
+    CHECK(remap.unknown_bits() == 0x24);
+    std::vector<bitmask::bitmask<perm>> decoded(64);
+    const auto r = remap.decode(header.next, file.data() + file.size(), decoded.data(), decoded.data() + decoded.size());
+    CHECK(r.error == bitmask::decode_error::out_of_domain);
+    CHECK(r.count == 4);
+    CHECK(remap.decode(header.next + 8 * 2, file.data() + file.size()).value == (perm::sticky));
+}
+
+TEST_CASE("schema_remap of renumbered flags", "[schema]")
+{
+    using v2_renumbered::perm;
+    const auto records = load<perm>(v1_file());
+    CHECK(records[0x01] == perm::read);
+    CHECK(records[0x03] == (perm::read | perm::write));
+    CHECK(records[0x1C] == (perm::exec | perm::sticky | perm::setuid));
+    CHECK(records[0x3F] == (perm::read | perm::write | perm::exec | perm::sticky | perm::setuid));
+}
+
+TEST_CASE("schema_remap of long names", "[schema]")
+{
+    using long_names::perm;
+    const bitmask::bitmask<perm> record = perm::read | perm::executable;
+    bytes file(bitmask::schema_size<perm>::value + 1);
+    bitmask::encode_fixed(bitmask::write_schema<perm>(file.data()), record);
+
+    bitmask::schema_remap<perm> remap;
+    const auto header = remap.read_schema(file.data(), file.data() + file.size(), bitmask::unknown_flags::fail);
+    REQUIRE(header);
+    CHECK(remap.unknown_bits() == 0);
+    const auto r = remap.decode(header.next, file.data() + file.size());
+    CHECK(r);
+    CHECK(r.value == record);
+}
+
+TEST_CASE("schema_remap of bad dictionaries", "[schema]")
+{
+    using bitmask::decode_error;
+    bitmask::schema_remap<v1::perm> remap;
+    const bytes file = v1_file();
+    const unsigned char* const first = file.data();
+
+    CHECK(remap.read_schema(first, first + 1).error == decode_error::truncated);
+    CHECK(remap.read_schema(first, first + 7).error == decode_error::truncated);
+
+    bytes bad = file;
+    bad[0] = 3;
+    CHECK(remap.read_schema(bad.data(), bad.data() + bad.size()).error == decode_error::bad_schema);
+    bad = file;
+    bad[2 + 6] = 0;  // `write` at the bit of `read`
+    CHECK(remap.read_schema(bad.data(), bad.data() + bad.size()).error == decode_error::bad_schema);
+    bad = file;
+    bad[2] = 16;  // Out of the word
+    CHECK(remap.read_schema(bad.data(), bad.data() + bad.size()).error == decode_error::bad_schema);
+
+    // The remap is left as it was
+    const auto r = remap.decode(file.data() + bitmask::schema_size<v1::perm>::value + 2 * 2, file.data() + file.size());
+    CHECK(r.value == (v1::perm::write));
+}
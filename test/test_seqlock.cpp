@@ -0,0 +1,100 @@
+#include "catch.hpp"
+
+#include <bitmask/seqlock.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    enum class dirty_shard
+    {
+        first = 0,
+        last = 511
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(dirty_shard, last)
+}
+
+TEST_CASE("seqlock_bitmask", "[seqlock]")
+{
+    using bm = bitmask::bitmask<dirty_shard>;
+
+    bitmask::seqlock_bitmask<dirty_shard> s;
+    CHECK(s.word_count == 8);
+    CHECK(!s.load());
+    CHECK(s.version() == 0);
+
+    const bm a = static_cast<dirty_shard>(3) | static_cast<dirty_shard>(300);
+    CHECK(!s.fetch_or(a));
+    CHECK(s.load() == a);
+    CHECK(s.test(static_cast<dirty_shard>(300)));
+    CHECK_FALSE(s.test(static_cast<dirty_shard>(301)));
+
+    CHECK(s.fetch_and(dirty_shard::last | static_cast<dirty_shard>(3)) == a);
+    CHECK(s.load() == static_cast<dirty_shard>(3));
+
+    CHECK(s.modify([](bm& v) { v ^= dirty_shard::last; }) == static_cast<dirty_shard>(3));
+    CHECK(s.load() == (dirty_shard::last | static_cast<dirty_shard>(3)));
+    s.store(dirty_shard::first);
+    CHECK(s.load() == dirty_shard::first);
+    CHECK(s.version() == 4);
+
+    bitmask::seqlock_bitmask<dirty_shard> initial(a);
+    CHECK(initial.load() == a);
+}
+
+TEST_CASE("seqlock_bitmask with concurrent writers and readers", "[seqlock]")
+{
+    using bm = bitmask::bitmask<dirty_shard>;
+
+    // Writers keep every word of the value equal; readers must never see words that differ.
+    // Every write counts in the version, whichever writer it comes from.
+    const unsigned writers = 3;
+    const unsigned writes = 3000;
+
+    bitmask::seqlock_bitmask<dirty_shard> s;
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t != 2; ++t)
+    {
+        readers.emplace_back([&] {
+            do
+            {
+                const bm v = s.load();
+                for (std::size_t i = 1; i != bm::word_count; ++i)
+                    torn += v.word(i) != v.word(0);
+            }
+            while (!stop);
+        });
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w != writers; ++w)
+    {
+        pool.emplace_back([&, w] {
+            for (unsigned i = 0; i != writes; ++i)
+            {
+                // Sets bit `b` in every word
+                const unsigned b = (w * writes + i) % 64;
+                s.modify([b](bm& v) {
+                    for (std::size_t j = 0; j != bm::word_count; ++j)
+                        v |= static_cast<dirty_shard>(j * 64 + b);
+                });
+                if (i % 64 == 63)
+                    s.fetch_and(nullptr);
+            }
+        });
+    }
+    for (auto& t: pool)
+        t.join();
+    stop = true;
+    for (auto& t: readers)
+        t.join();
+
+    CHECK(torn == 0);
+    CHECK(s.version() == writers * writes + writers * (writes / 64));
+}
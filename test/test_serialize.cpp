@@ -0,0 +1,207 @@
+#include "catch.hpp"
+
+#include <bitmask/serialize.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace
+{
+    // 9 flags spread over 32 bits
+    enum class sparse: std::uint32_t
+    {
+        a = 1u << 0,
+        b = 1u << 1,
+        c = 1u << 2,
+        d = 1u << 7,
+        e = 1u << 12,
+        f = 1u << 13,
+        g = 1u << 20,
+        h = 1u << 30,
+        i = 1u << 31,
+
+        _bitmask_value_mask = 0xC0103087u
+    };
+
+    BITMASK_DEFINE(sparse)
+
+    enum class wide: std::uint64_t
+    {
+        _bitmask_value_mask = ~0ull
+    };
+
+    BITMASK_DEFINE(wide)
+
+    enum class tiny: std::uint8_t
+    {
+        x = 0x02,
+        y = 0x40,
+
+        _bitmask_value_mask = 0x42
+    };
+
+    BITMASK_DEFINE(tiny)
+
+    using bytes = std::vector<unsigned char>;
+
+    std::vector<bitmask::bitmask<sparse>> sample(std::size_t n)
+    {
+        std::vector<bitmask::bitmask<sparse>> v;
+        std::uint32_t x = 12345;
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            x = x * 1664525u + 1013904223u;
+            v.push_back(bitmask::bitmask<sparse>(static_cast<sparse>(x & 0xC0103087u)));
+        }
+        return v;
+    }
+}
+
+static_assert(bitmask::fixed_size<sparse>::value == 4, "");
+static_assert(bitmask::dense_size<sparse>::value == 2, "9 flags fit in 2 bytes");
+static_assert(bitmask::dense_size<wide>::value == 8, "");
+static_assert(bitmask::dense_size<tiny>::value == 1, "");
+static_assert(bitmask::max_varint_size<sparse>::value == 5, "");
+
+TEST_CASE("fixed encoding", "[serialize]")
+{
+    unsigned char buf[4];
+    CHECK(bitmask::encode_fixed(buf, sparse::a | sparse::e | sparse::i) == buf + 4);
+    CHECK(bytes(buf, buf + 4) == (bytes{0x01, 0x10, 0x00, 0x80}));
+
+    auto r = bitmask::decode_fixed<sparse>(buf, buf + 4);
+    CHECK(r);
+    CHECK(r.value == (sparse::a | sparse::e | sparse::i));
+    CHECK(r.next == buf + 4);
+
+    CHECK(bitmask::decode_fixed<sparse>(buf, buf + 3).error == bitmask::decode_error::truncated);
+    buf[0] = 0x08;
+    r = bitmask::decode_fixed<sparse>(buf, buf + 4);
+    CHECK(r.error == bitmask::decode_error::out_of_domain);
+    CHECK(r.next == buf);
+    CHECK(r.value == bitmask::bitmask<sparse>());
+}
+
+TEST_CASE("varint encoding", "[serialize]")
+{
+    unsigned char buf[10];
+    CHECK(bitmask::encode_varint(buf, bitmask::bitmask<sparse>()) == buf + 1);
+    CHECK(buf[0] == 0);
+    CHECK(bitmask::encode_varint(buf, sparse::a | sparse::d) == buf + 2);
+    CHECK(bytes(buf, buf + 2) == (bytes{0x81, 0x01}));
+    CHECK(bitmask::decode_varint<sparse>(buf, buf + 2).value == (sparse::a | sparse::d));
+
+    CHECK(bitmask::encode_varint(buf, ~bitmask::bitmask<wide>()) == buf + 10);
+    CHECK(bitmask::decode_varint<wide>(buf, buf + 10).value == ~bitmask::bitmask<wide>());
+
+    using bitmask::decode_error;
+    const unsigned char truncated[] = {0x81};
+    const unsigned char trailing_zero[] = {0x81, 0x00};
+    const unsigned char too_long[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    const unsigned char too_wide[] = {0x80, 0x80, 0x80, 0x80, 0x10};
+    const unsigned char out_of_domain[] = {0x08};
+    CHECK(bitmask::decode_varint<sparse>(truncated, truncated + 1).error == decode_error::truncated);
+    CHECK(bitmask::decode_varint<sparse>(trailing_zero, trailing_zero + 2).error == decode_error::overlong);
+    CHECK(bitmask::decode_varint<sparse>(too_long, too_long + 6).error == decode_error::overlong);
+    CHECK(bitmask::decode_varint<sparse>(too_wide, too_wide + 5).error == decode_error::out_of_domain);
+    CHECK(bitmask::decode_varint<sparse>(out_of_domain, out_of_domain + 1).error == decode_error::out_of_domain);
+}
+
+TEST_CASE("dense encoding", "[serialize]")
+{
+    unsigned char buf[8];
+    CHECK(bitmask::encode_dense(buf, sparse::a | sparse::d | sparse::i) == buf + 2);
+    CHECK(bytes(buf, buf + 2) == (bytes{0x09, 0x01}));  // Flags 0, 3 and 8
+    CHECK(bitmask::decode_dense<sparse>(buf, buf + 2).value == (sparse::a | sparse::d | sparse::i));
+
+    // The same as the runs that are used without BMI2
+    std::size_t mismatches = 0;
+    for (const auto& m: sample(1000))
+    {
+        const std::uint32_t dense = bitmask::bitmask_detail::dense_runs_of<sparse>::extract(m.bits());
+        bitmask::encode_dense(buf, m);
+        mismatches += dense != (buf[0] | static_cast<std::uint32_t>(buf[1]) << 8);
+        mismatches += bitmask::bitmask_detail::dense_runs_of<sparse>::deposit(dense) != m.bits();
+    }
+    CHECK(mismatches == 0);
+
+    buf[1] = 0x02;  // There is no 10th flag
+    CHECK(bitmask::decode_dense<sparse>(buf, buf + 2).error == bitmask::decode_error::out_of_domain);
+    CHECK(bitmask::decode_dense<sparse>(buf, buf + 1).error == bitmask::decode_error::truncated);
+
+    CHECK(bitmask::encode_dense<tiny>(buf, tiny::y) == buf + 1);
+    CHECK(buf[0] == 0x02);
+    CHECK(bitmask::encode_dense(buf, ~bitmask::bitmask<wide>()) == buf + 8);
+    CHECK(bitmask::decode_dense<wide>(buf, buf + 8).value == ~bitmask::bitmask<wide>());
+}
+
+TEST_CASE("bulk encoding", "[serialize]")
+{
+    const auto values = sample(3000);
+    std::vector<bitmask::bitmask<sparse>> decoded(values.size());
+    bytes buf(values.size() * 5);
+    const auto first = values.data();
+    const auto last = first + values.size();
+
+    unsigned char* end = bitmask::encode_fixed(buf.data(), first, last);
+    CHECK(end == buf.data() + values.size() * 4);
+    auto r = bitmask::decode_fixed(buf.data(), end, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r);
+    CHECK(r.count == values.size());
+    CHECK(r.next == end);
+    CHECK(decoded == values);
+
+    end = bitmask::encode_varint(buf.data(), first, last);
+    decoded.assign(values.size(), {});
+    r = bitmask::decode_varint(buf.data(), end, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r);
+    CHECK(r.next == end);
+    CHECK(decoded == values);
+
+    end = bitmask::encode_dense(buf.data(), first, last);
+    CHECK(end == buf.data() + values.size() * 2);
+    decoded.assign(values.size(), {});
+    r = bitmask::decode_dense(buf.data(), end, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r);
+    CHECK(decoded == values);
+
+    // The kernel that is not picked on this CPU
+    bytes runs(values.size() * 2);
+    CHECK(bitmask::bitmask_detail::encode_dense_runs(runs.data(), first, last) == runs.data() + runs.size());
+    CHECK(bytes(buf.data(), end) == runs);
+    decoded.assign(values.size(), {});
+    CHECK(bitmask::bitmask_detail::decode_dense_runs(runs.data(), decoded.data(), decoded.size()));
+    CHECK(decoded == values);
+}
+
+TEST_CASE("bulk decoding errors", "[serialize]")
+{
+    const auto values = sample(2500);
+    std::vector<bitmask::bitmask<sparse>> decoded(values.size());
+    bytes buf(values.size() * 4);
+    unsigned char* end = bitmask::encode_fixed(buf.data(), values.data(), values.data() + values.size());
+
+    // The value that fails is in the middle of the second chunk
+    buf[2100 * 4] |= 0x08;
+    auto r = bitmask::decode_fixed(buf.data(), end, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r.error == bitmask::decode_error::out_of_domain);
+    CHECK(r.count == 2100);
+    CHECK(r.next == buf.data() + 2100 * 4);
+    CHECK(decoded[2099] == values[2099]);
+    CHECK(decoded[2100] == bitmask::bitmask<sparse>());
+
+    r = bitmask::decode_fixed(buf.data(), buf.data() + 10, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r.error == bitmask::decode_error::truncated);
+    CHECK(r.count == 2);
+    CHECK(r.next == buf.data() + 8);
+
+    end = bitmask::encode_dense(buf.data(), values.data(), values.data() + values.size());
+    r = bitmask::decode_dense(buf.data(), end - 1, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r.error == bitmask::decode_error::truncated);
+    CHECK(r.count == values.size() - 1);
+    buf[7 * 2 + 1] |= 0x80;
+    r = bitmask::decode_dense(buf.data(), end, decoded.data(), decoded.data() + decoded.size());
+    CHECK(r.error == bitmask::decode_error::out_of_domain);
+    CHECK(r.count == 7);
+}
@@ -0,0 +1,156 @@
+#include "catch.hpp"
+
+#include <bitmask/simd.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class rule
+    {
+        first = 0,
+        last = 700,
+    };
+
+    BITMASK_DEFINE_BIT_INDEX(rule, last)
+
+    using words = std::vector<std::uint64_t>;
+
+    words random_words(std::mt19937_64& gen, std::size_t n)
+    {
+        words result(n);
+        for (auto& w: result)
+            w = gen();
+        return result;
+    }
+
+    bitmask::bitmask<rule> random_rules(std::mt19937_64& gen)
+    {
+        bitmask::bitmask<rule> result;
+        for (int i = 0; i != 100; ++i)
+            result |= static_cast<rule>(gen() % 701);
+        return result;
+    }
+
+    namespace detail = bitmask::simd::simd_detail;
+
+    // Kernels of one instruction set
+#define BITMASK_TEST_KERNELS(name, ns, popcount_ns)                                                                  \
+    struct name                                                                                                     \
+    {                                                                                                               \
+        template<class Op>                                                                                          \
+        static void transform(std::uint64_t* dst, const std::uint64_t* a, const std::uint64_t* b, std::size_t n)    \
+        { detail::ns::transform<Op>(dst, a, b, n); }                                                                \
+                                                                                                                    \
+        template<class Op>                                                                                          \
+        static bool all_zero(const std::uint64_t* a, const std::uint64_t* b, std::size_t n)                        \
+        { return detail::ns::all_zero<Op>(a, b, n); }                                                               \
+                                                                                                                    \
+        static std::size_t popcount(const std::uint64_t* a, std::size_t n)                                          \
+        { return detail::popcount_ns::popcount(a, n); }                                                             \
+    };
+
+    BITMASK_TEST_KERNELS(scalar_kernels, scalar, scalar)
+#if BITMASK_SIMD_X86
+    BITMASK_TEST_KERNELS(sse2_kernels, sse2, popcnt)
+    BITMASK_TEST_KERNELS(avx2_kernels, avx2, avx2)
+    BITMASK_TEST_KERNELS(avx512_kernels, avx512, avx512)
+#endif
+
+#undef BITMASK_TEST_KERNELS
+
+    // Checks the kernels of one instruction set against the scalar ones
+    template<class Kernels>
+    void check_kernels()
+    {
+        std::mt19937_64 gen{42};
+
+        for (std::size_t n = 0; n != 37; ++n)
+        {
+            const auto a = random_words(gen, n);
+            auto b = random_words(gen, n);
+
+            words expected(n), actual(n);
+
+            detail::scalar::transform<detail::op_and>(expected.data(), a.data(), b.data(), n);
+            Kernels::template transform<detail::op_and>(actual.data(), a.data(), b.data(), n);
+            CHECK(actual == expected);
+
+            detail::scalar::transform<detail::op_or>(expected.data(), a.data(), b.data(), n);
+            Kernels::template transform<detail::op_or>(actual.data(), a.data(), b.data(), n);
+            CHECK(actual == expected);
+
+            detail::scalar::transform<detail::op_xor>(expected.data(), a.data(), b.data(), n);
+            Kernels::template transform<detail::op_xor>(actual.data(), a.data(), b.data(), n);
+            CHECK(actual == expected);
+
+            detail::scalar::transform<detail::op_andnot>(expected.data(), a.data(), b.data(), n);
+            Kernels::template transform<detail::op_andnot>(actual.data(), a.data(), b.data(), n);
+            CHECK(actual == expected);
+
+            CHECK(Kernels::popcount(a.data(), n) == detail::scalar::popcount(a.data(), n));
+
+            CHECK(Kernels::template all_zero<detail::op_xor>(a.data(), a.data(), n));
+            CHECK(Kernels::template all_zero<detail::op_andnot>(a.data(), a.data(), n));
+            if (n)
+            {
+                b = a;
+                b[n - 1] ^= 0x8000000000000000ull;
+                CHECK_FALSE(Kernels::template all_zero<detail::op_xor>(a.data(), b.data(), n));
+                CHECK(Kernels::template all_zero<detail::op_andnot>(b.data(), a.data(), n) == ((a[n - 1] >> 63) == 0));
+                CHECK(Kernels::template all_zero<detail::op_andnot>(a.data(), b.data(), n) == ((a[n - 1] >> 63) == 1));
+            }
+        }
+    }
+}
+
+TEST_CASE("simd_kernels", "[simd]")
+{
+    check_kernels<scalar_kernels>();
+
+#if BITMASK_SIMD_X86
+    const auto& cpu = bitmask::simd::detected_cpu_features();
+
+    if (cpu.sse2 && cpu.popcnt)
+        check_kernels<sse2_kernels>();
+    if (cpu.avx2 && cpu.popcnt)
+        check_kernels<avx2_kernels>();
+    if (cpu.avx512 && cpu.avx512_vpopcntdq)
+        check_kernels<avx512_kernels>();
+#endif
+}
+
+TEST_CASE("simd_bit_index_bitmask", "[simd]")
+{
+    using bm = bitmask::bitmask<rule>;
+
+    std::mt19937_64 gen{7};
+
+    for (int i = 0; i != 100; ++i)
+    {
+        const bm a = random_rules(gen);
+        const bm b = random_rules(gen);
+
+        bm r;
+        bitmask::simd::and_words(r.data(), a.data(), b.data(), bm::word_count);
+        CHECK(r == (a & b));
+        bitmask::simd::or_words(r.data(), a.data(), b.data(), bm::word_count);
+        CHECK(r == (a | b));
+        bitmask::simd::xor_words(r.data(), a.data(), b.data(), bm::word_count);
+        CHECK(r == (a ^ b));
+        bitmask::simd::not_words(r.data(), a.data(), bm::mask_value.data(), bm::word_count);
+        CHECK(r == ~a);
+
+        CHECK(bitmask::simd::equal(a, a));
+        CHECK_FALSE(bitmask::simd::equal(a, a ^ rule::last));
+        CHECK(bitmask::simd::contains_all(a | b, b));
+        CHECK(bitmask::simd::contains_all(a, b) == a.contains_all(b));
+        CHECK(bitmask::simd::count(a) == a.count());
+    }
+
+    CHECK(bitmask::simd::count(~bm{}) == 701);
+    CHECK(bitmask::simd::count(bm{}) == 0);
+}
@@ -0,0 +1,199 @@
+#include "catch.hpp"
+
+#include <bitmask/sliced_index.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    enum class column_8: std::uint8_t
+    {
+        a = 0x01,
+        b = 0x02,
+        c = 0x10,
+        d = 0x80,
+
+        _bitmask_value_mask = 0x93
+    };
+
+    BITMASK_DEFINE(column_8)
+
+    enum class column_16: std::uint16_t { _bitmask_value_mask = 0xF0F0 };
+    BITMASK_DEFINE(column_16)
+
+    enum class column_32: std::uint32_t { _bitmask_value_mask = 0x8000FFFF };
+    BITMASK_DEFINE(column_32)
+
+    enum class column_64: std::uint64_t { _bitmask_value_mask = 0xFFFFFFFFFFFFFFFF };
+    BITMASK_DEFINE(column_64)
+
+    template<class T>
+    std::vector<bitmask::bitmask<T>> random_rows(std::size_t n)
+    {
+        std::mt19937_64 gen{7};
+        std::vector<bitmask::bitmask<T>> rows;
+        rows.reserve(n);
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            rows.push_back(bitmask::bitmask_detail::to_enum<T>(
+                static_cast<typename bitmask::bitmask<T>::underlying_type>(gen()) & bitmask::bitmask<T>::mask_value));
+        }
+        return rows;
+    }
+
+    template<class T>
+    void check_sliced_index(std::size_t n)
+    {
+        using bm = bitmask::bitmask<T>;
+
+        const auto rows = random_rows<T>(n);
+        const bitmask::bitmask_sliced_index<T> index(rows.data(), rows.data() + rows.size());
+        REQUIRE(index.size() == n);
+
+        for (std::size_t i = 0; i < n; i += 7)
+            CHECK(index[i] == rows[i]);
+
+        // Predicates built from the lowest and the highest flags of the domain
+        const bm all = ~bm{};
+        const bm low = all.lowest();
+        const bm high = all.highest();
+        const bm must = low | high;
+        const bm must_not = (all ^ must).lowest();
+
+        const auto selected = index.filter(must, must_not);
+        const auto any = index.filter_any(must);
+        const auto equal = index.filter_equal(low);
+        REQUIRE(selected.size() == index.slice_words());
+
+        std::vector<bm> expected_rows;
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            const bool is_selected = rows[i].contains_all(must) && rows[i].contains_none(must_not);
+            if (is_selected)
+                expected_rows.push_back(rows[i]);
+            mismatches += ((selected[i / 64] >> (i % 64)) & 1u) != is_selected;
+            mismatches += ((any[i / 64] >> (i % 64)) & 1u) != rows[i].contains_any(must);
+            mismatches += ((equal[i / 64] >> (i % 64)) & 1u) != (rows[i] == low);
+        }
+        CHECK(mismatches == 0);
+
+        // Nothing is selected past the last row
+        if (n % 64)
+        {
+            CHECK((index.filter_none(must).back() >> (n % 64)) == 0);
+            CHECK((index.filter_all(bm{}).back() >> (n % 64)) == 0);
+        }
+
+        CHECK(index.materialize(selected) == expected_rows);
+        CHECK(index.filter_indices(must, must_not).size() == expected_rows.size());
+
+        if (n > 10)
+        {
+            std::vector<bm> part(n - 10);
+            index.materialize(5, n - 10, part.data());
+            CHECK(std::equal(part.begin(), part.end(), rows.begin() + 5));
+        }
+    }
+
+    template<class U>
+    void check_transpose()
+    {
+        std::mt19937_64 gen{11};
+        U rows[64];
+        for (auto& r : rows)
+            r = static_cast<U>(gen());
+
+        std::uint64_t slices[8 * sizeof(U)];
+        bitmask::simd::bit_slice(rows, 64, slices);
+        for (std::size_t i = 0; i != 64; ++i)
+        {
+            for (std::size_t j = 0; j != 8 * sizeof(U); ++j)
+                REQUIRE(((slices[j] >> i) & 1u) == ((rows[i] >> j) & 1u));
+        }
+
+        U restored[64];
+        bitmask::simd::bit_unslice(slices, restored, 64);
+        CHECK(std::equal(std::begin(rows), std::end(rows), std::begin(restored)));
+    }
+}
+
+TEST_CASE("bitmask_sliced_index", "[sliced_index]")
+{
+    using bm = bitmask::bitmask<column_8>;
+
+    static_assert(bitmask::bitmask_sliced_index<column_8>::slice_count == 4, "");
+
+    const bm rows[] = {column_8::a | column_8::b, column_8::b | column_8::d, column_8::c, bm{}, column_8::a | column_8::d};
+    const bitmask::bitmask_sliced_index<column_8> index(std::begin(rows), std::end(rows));
+
+    CHECK(index.size() == 5);
+    CHECK(index.slice(column_8::b)[0] == 0x03);
+    CHECK(index.slice(column_8::d)[0] == 0x12);
+    CHECK(index.filter_all_indices(column_8::a) == (std::vector<std::size_t>{0, 4}));
+    CHECK(index.filter_indices(column_8::b, column_8::a) == std::vector<std::size_t>{1});
+    CHECK(index.filter_none_indices(column_8::a | column_8::b) == (std::vector<std::size_t>{2, 3}));
+    CHECK(index.filter_any_indices(column_8::c | column_8::d) == (std::vector<std::size_t>{1, 2, 4}));
+    CHECK(index.filter_equal_indices(bm{}) == std::vector<std::size_t>{3});
+
+    bitmask::bitmask_vector<column_8> v{column_8::c, column_8::a};
+    const bitmask::bitmask_sliced_index<column_8> from_vector(v);
+    CHECK(from_vector[0] == column_8::c);
+    CHECK(from_vector[1] == column_8::a);
+
+    const bitmask::bitmask_sliced_index<column_8> empty;
+    CHECK(empty.empty());
+    CHECK(empty.filter_all(column_8::a).empty());
+
+    for (std::size_t n : {1, 63, 64, 65, 1000, 200000})
+    {
+        check_sliced_index<column_8>(n);
+        check_sliced_index<column_16>(n);
+        check_sliced_index<column_32>(n);
+        check_sliced_index<column_64>(n);
+    }
+}
+
+TEST_CASE("simd_transpose_kernels", "[sliced_index][simd]")
+{
+    check_transpose<std::uint8_t>();
+    check_transpose<std::uint16_t>();
+    check_transpose<std::uint32_t>();
+    check_transpose<std::uint64_t>();
+
+    std::mt19937_64 gen{13};
+    std::uint64_t a[64], expected[64];
+    for (auto& w : a)
+        w = gen();
+    std::copy(std::begin(a), std::end(a), std::begin(expected));
+    bitmask::simd::simd_detail::scalar::transpose_64x64(expected);
+
+#if BITMASK_SIMD_X86
+    if (bitmask::simd::detected_cpu_features().avx512)
+    {
+        std::uint64_t b[64];
+        std::copy(std::begin(a), std::end(a), std::begin(b));
+        bitmask::simd::simd_detail::avx512::transpose_64x64(b);
+        CHECK(std::equal(std::begin(b), std::end(b), std::begin(expected)));
+    }
+    if (bitmask::simd::detected_cpu_features().avx2)
+    {
+        std::uint8_t rows[64];
+        for (auto& r : rows)
+            r = static_cast<std::uint8_t>(gen());
+        std::uint64_t slices[8], expected_slices[8];
+        bitmask::simd::simd_detail::avx2::bit_slice_8(rows, slices);
+        std::uint64_t t[64];
+        for (std::size_t i = 0; i != 64; ++i)
+            t[i] = rows[i];
+        bitmask::simd::simd_detail::scalar::transpose_64x64(t);
+        std::copy(t, t + 8, expected_slices);
+        CHECK(std::equal(std::begin(slices), std::end(slices), std::begin(expected_slices)));
+    }
+#endif
+}
@@ -0,0 +1,119 @@
+#include "catch.hpp"
+
+#include <bitmask/slot_allocator.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("slot_allocator", "[slot_allocator]")
+{
+    for (const bool use_summary: {true, false})
+    {
+        bitmask::slot_allocator a(4200, use_summary);
+        CHECK(a.capacity() == 4200);
+        CHECK(a.count() == 0);
+
+        std::vector<std::size_t> slots;
+        for (std::size_t i = 0; i != 4200; ++i)
+            slots.push_back(a.acquire());
+        CHECK(a.acquire() == bitmask::slot_allocator::npos);
+        CHECK(a.count() == 4200);
+
+        std::sort(slots.begin(), slots.end());
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i != slots.size(); ++i)
+            mismatches += slots[i] != i;
+        CHECK(mismatches == 0);
+
+        // Free slots are found wherever they are
+        a.release(17);
+        a.release(4199);
+        a.release(64 * 64 + 5);
+        CHECK_FALSE(a.is_acquired(17));
+        CHECK(a.is_acquired(18));
+        CHECK(a.count() == 4197);
+
+        std::size_t batch[5] = {};
+        CHECK(a.acquire_n(5, batch) == 3);
+        std::sort(batch, batch + 3);
+        CHECK(batch[0] == 17);
+        CHECK(batch[1] == 64 * 64 + 5);
+        CHECK(batch[2] == 4199);
+        CHECK(a.acquire_n(5, batch) == 0);
+
+        a.release_n(batch, 3);
+        CHECK(a.count() == 4197);
+    }
+
+    bitmask::slot_allocator empty(0);
+    CHECK(empty.acquire() == bitmask::slot_allocator::npos);
+    CHECK(empty.count() == 0);
+}
+
+TEST_CASE("slot_allocator batch takes several slots of a word", "[slot_allocator]")
+{
+    bitmask::slot_allocator a(1000);
+    std::vector<std::size_t> slots(100);
+    CHECK(a.acquire_n(100, slots.data()) == 100);
+    std::sort(slots.begin(), slots.end());
+    CHECK(std::unique(slots.begin(), slots.end()) == slots.end());
+    CHECK(a.count() == 100);
+}
+
+TEST_CASE("slot_allocator from many threads", "[slot_allocator]")
+{
+    // Every slot must have at most one owner at a time
+    const unsigned threads = 4;
+    const std::size_t capacity = 300;
+
+    for (const bool use_summary: {true, false})
+    {
+        bitmask::slot_allocator a(capacity, use_summary);
+        std::vector<std::atomic<int>> owners(capacity);
+        std::atomic<int> conflicts{0};
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t != threads; ++t)
+        {
+            pool.emplace_back([&, t] {
+                std::vector<std::size_t> held;
+                for (unsigned i = 0; i != 20000; ++i)
+                {
+                    if (held.size() < 100 && (i % 3 != 0 || held.empty()))
+                    {
+                        std::size_t batch[4];
+                        const std::size_t n = i % 2 ? a.acquire_n(4, batch) : (batch[0] = a.acquire()) != a.npos;
+                        for (std::size_t k = 0; k != n; ++k)
+                        {
+                            conflicts += owners[batch[k]].exchange(static_cast<int>(t) + 1) != 0;
+                            held.push_back(batch[k]);
+                        }
+                    }
+                    else
+                    {
+                        const std::size_t slot = held.back();
+                        held.pop_back();
+                        owners[slot].store(0);
+                        a.release(slot);
+                    }
+                }
+                for (const auto slot: held)
+                {
+                    owners[slot].store(0);
+                    a.release(slot);
+                }
+            });
+        }
+        for (auto& t: pool)
+            t.join();
+
+        CHECK(conflicts == 0);
+        CHECK(a.count() == 0);
+        // Nothing leaked: all the slots can be acquired again
+        std::vector<std::size_t> all(capacity + 1);
+        CHECK(a.acquire_n(capacity + 1, all.data()) == capacity);
+    }
+}